@@ -0,0 +1,179 @@
+// Teste de caixas: checkAllbbox (vetor de bbox) contra o kernel sobre arrays
+// separados por coordenada, em C puro, SSE2 (4 caixas por instrucao) e AVX2
+// (8 caixas por instrucao), na pista do jogo e em ovais de 100 a 10000
+// paredes. Caminhos que a CPU nao suporta aparecem como "-". A coluna
+// "batch" e o firstOverlaps, que testa 8 carros (AVX2) por instrucao contra
+// cada caixa: ganha quando poucos carros encostam em caixas, como na pista do
+// jogo, e perde nos ovais, onde metade dos carros acha uma parede cedo e o
+// grupo continua ate o ultimo carro achar a sua.
+//
+//   ./bench_aabb [consultas]
+//
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "aabbkernel.h"
+#include "racesim.h"
+
+// oval com paredes por dentro e por fora, cada segmento uma caixa alinhada
+static void ovalTrack(int walls, std::vector<bbox> &boxes)
+{
+    boxes.clear();
+    int segments = walls / 2;
+    for (int side = 0; side < 2; side++)
+    {
+        float rx = side == 0 ? 400.0f : 408.0f;
+        float rz = side == 0 ? 150.0f : 158.0f;
+        for (int i = 0; i < segments; i++)
+        {
+            float a0 = 6.2831853f * i / segments;
+            float a1 = 6.2831853f * (i + 1) / segments;
+            float x0 = rx * std::cos(a0), z0 = rz * std::sin(a0);
+            float x1 = rx * std::cos(a1), z1 = rz * std::sin(a1);
+            bbox b;
+            b.minPoint = glm::vec4(std::min(x0, x1) - 0.4f, 0.167617f, std::min(z0, z1) - 0.4f, 0.0f);
+            b.maxPoint = glm::vec4(std::max(x0, x1) + 0.4f, 1.14384f, std::max(z0, z1) + 0.4f, 0.0f);
+            glm::vec4 normal = glm::vec4(-std::cos(a0), 0.0f, -std::sin(a0), 0.0f);
+            b.normal = side == 0 ? -normal : normal;
+            boxes.push_back(b);
+        }
+    }
+}
+
+static bbox playerBox(float x, float z)
+{
+    bbox b;
+    b.minPoint = glm::vec4(x - playerHalfExtent, -playerHalfExtent, z - playerHalfExtent, 1.0f);
+    b.maxPoint = glm::vec4(x + playerHalfExtent, playerHalfExtent, z + playerHalfExtent, 1.0f);
+    b.normal = glm::vec4(0.0f);
+    return b;
+}
+
+// ns por consulta com o kernel escolhido, -1 se a CPU nao suporta
+static double timeKernel(SimdIsa isa, const AabbSoA &soa, const std::vector<bbox> &walls,
+                         const std::vector<bbox> &queries, const std::vector<glm::vec4> &expected, bool &match)
+{
+    if (!setSimdIsa(isa))
+    {
+        return -1.0;
+    }
+    const int n = (int)queries.size();
+    std::vector<int> hit(n);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        float carMin[3] = {queries[i].minPoint.x, queries[i].minPoint.y, queries[i].minPoint.z};
+        float carMax[3] = {queries[i].maxPoint.x, queries[i].maxPoint.y, queries[i].maxPoint.z};
+        hit[i] = firstOverlap(soa, carMin, carMax);
+    }
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        glm::vec4 normal = hit[i] >= 0 ? walls[hit[i]].normal : glm::vec4(0.0f);
+        match = match && normal == expected[i];
+    }
+    return std::chrono::duration<double>(t1 - t0).count() * 1e9 / n;
+}
+
+static void printTime(double ns)
+{
+    if (ns < 0)
+    {
+        printf(" %10s", "-");
+    }
+    else
+    {
+        printf(" %10.1f", ns);
+    }
+}
+
+static void run(const char *name, const std::vector<bbox> &walls, const std::vector<bbox> &queries)
+{
+    AabbSoA soa;
+    soa.assign(walls);
+
+    const int n = (int)queries.size();
+    std::vector<glm::vec4> expected(n);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        expected[i] = checkAllbbox(queries[i], walls);
+    }
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+    bool match = true;
+    double scalar = timeKernel(SIMD_SCALAR, soa, walls, queries, expected, match);
+    double sse2 = timeKernel(SIMD_SSE2, soa, walls, queries, expected, match);
+    double avx2 = timeKernel(SIMD_AVX2, soa, walls, queries, expected, match);
+
+    // varios carros por chamada, com o melhor kernel
+    setSimdIsa(SIMD_AVX2) || setSimdIsa(SIMD_SSE2);
+    std::vector<float> minX(n), minY(n), minZ(n), maxX(n), maxY(n), maxZ(n);
+    for (int i = 0; i < n; i++)
+    {
+        minX[i] = queries[i].minPoint.x;
+        minY[i] = queries[i].minPoint.y;
+        minZ[i] = queries[i].minPoint.z;
+        maxX[i] = queries[i].maxPoint.x;
+        maxY[i] = queries[i].maxPoint.y;
+        maxZ[i] = queries[i].maxPoint.z;
+    }
+    std::vector<int> hits(n);
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+    firstOverlaps(soa, &minX[0], &minY[0], &minZ[0], &maxX[0], &maxY[0], &maxZ[0], n, &hits[0]);
+    std::chrono::steady_clock::time_point t3 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        glm::vec4 normal = hits[i] >= 0 ? walls[hits[i]].normal : glm::vec4(0.0f);
+        match = match && normal == expected[i];
+    }
+
+    printf("%-10s %7d", name, (int)walls.size());
+    printTime(std::chrono::duration<double>(t1 - t0).count() * 1e9 / n);
+    printTime(scalar);
+    printTime(sse2);
+    printTime(avx2);
+    printTime(std::chrono::duration<double>(t3 - t2).count() * 1e9 / n);
+    printf(" %6s\n", match ? "yes" : "NO");
+}
+
+int main(int argc, char *argv[])
+{
+    int count = argc > 1 ? atoi(argv[1]) : 20000;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    printf("kernel escolhido: %s\n", simdIsaName(simdIsa()));
+    printf("%-10s %7s %10s %10s %10s %10s %10s %6s\n", "track", "walls", "bbox ns", "scalar ns", "sse2 ns", "avx2 ns", "batch ns", "match");
+
+    // pista do jogo, carros ao longo da reta e das curvas
+    RaceTrack track;
+    BuildDefaultTrack(track);
+    std::vector<bbox> queries;
+    for (int i = 0; i < count; i++)
+    {
+        queries.push_back(playerBox(-40.0f + 200.0f * unit(rng), -10.0f + 80.0f * unit(rng)));
+    }
+    run("default", track.straightsBBoxes, queries);
+
+    // ovais: carros perto da linha central, alguns encostando nas paredes
+    const int sizes[] = {16, 100, 1000, 10000};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        std::vector<bbox> walls;
+        ovalTrack(sizes[s], walls);
+        queries.clear();
+        for (int i = 0; i < count; i++)
+        {
+            float a = 6.2831853f * unit(rng);
+            float offset = 8.0f * unit(rng);
+            queries.push_back(playerBox((400.0f + offset) * std::cos(a), (150.0f + offset) * std::sin(a)));
+        }
+        run("oval", walls, queries);
+    }
+    return 0;
+}
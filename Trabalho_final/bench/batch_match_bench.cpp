@@ -0,0 +1,116 @@
+// Confere que o RaceBatch simula o mesmo que o RaceSim: corre cada semente
+// com o piloto de seededInputs() num RaceSim, guardando os controles de cada
+// tick, e depois repete os mesmos controles numa corrida de um RaceBatch com
+// todas as sementes. Mostra a maior diferenca de posicao, o primeiro tick em
+// que as posicoes se separam e as corridas com resultado diferente (fim,
+// derrota, checkpoint, boost ou tempo de parada). Sai com 1 se algo diferir.
+//
+//   ./bench_batch_match [sementes] [segundos]
+//
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "racebatch.h"
+#include "rollout.h"
+
+// o que o RaceSim fez em uma corrida
+struct Recorded
+{
+    std::vector<RaceInputs> inputs;
+    std::vector<float> x, z; // posicao depois de cada tick
+    RaceState end;
+};
+
+int main(int argc, char *argv[])
+{
+    int seeds = argc > 1 ? atoi(argv[1]) : 64;
+    float seconds = argc > 2 ? (float)atof(argv[2]) : 40.0f;
+    const float dt = 1.0f / SIM_TICK_RATE;
+    const int ticks = (int)(seconds * SIM_TICK_RATE);
+
+    RaceTrack track;
+    BuildDefaultTrack(track);
+
+    std::vector<Recorded> recorded(seeds);
+    for (int r = 0; r < seeds; r++)
+    {
+        RaceSim sim(track);
+        sim.start();
+        std::mt19937 rng(r + 1);
+        for (int tick = 0; tick < ticks && sim.state.raceStart; tick++)
+        {
+            RaceInputs inputs = seededInputs(rng, sim.state);
+            sim.step(inputs, dt);
+            recorded[r].inputs.push_back(inputs);
+            recorded[r].x.push_back(sim.state.carPos.x);
+            recorded[r].z.push_back(sim.state.carPos.z);
+        }
+        recorded[r].end = sim.state;
+    }
+
+    RaceBatch batch(track, seeds);
+    std::vector<RaceInputs> inputs(seeds);
+    float largest = 0.0f;
+    int largestRace = -1, largestTick = -1, firstTick = -1;
+    for (int tick = 0; tick < ticks && batch.running() > 0; tick++)
+    {
+        for (int r = 0; r < seeds; r++)
+        {
+            // corrida ja parada no RaceSim: o lote tambem deve estar parado
+            inputs[r] = tick < (int)recorded[r].inputs.size() ? recorded[r].inputs[tick] : RaceInputs();
+        }
+        batch.step(&inputs[0], dt);
+        for (int r = 0; r < seeds; r++)
+        {
+            if (tick >= (int)recorded[r].x.size())
+            {
+                continue;
+            }
+            float dx = batch.posX[r] - recorded[r].x[tick];
+            float dz = batch.posZ[r] - recorded[r].z[tick];
+            float d = std::sqrt(dx * dx + dz * dz);
+            if (d > 0.0f && firstTick < 0)
+            {
+                firstTick = tick + 1;
+            }
+            if (d > largest)
+            {
+                largest = d;
+                largestRace = r;
+                largestTick = tick + 1;
+            }
+        }
+    }
+
+    int mismatches = 0;
+    for (int r = 0; r < seeds; r++)
+    {
+        const RaceState &s = recorded[r].end;
+        float endTime = batch.raceStart[r] ? batch.time : batch.endTime[r];
+        if ((bool)batch.finished[r] != s.finished || (bool)batch.lost[r] != s.lost || (bool)batch.checkpoint[r] != s.checkpoint ||
+            batch.boostpower[r] != s.boostpower || endTime != s.time)
+        {
+            printf("semente %d: RaceSim fim %d derrota %d checkpoint %d boost %g tempo %g, RaceBatch %d %d %d %g %g\n", r + 1, s.finished,
+                   s.lost, s.checkpoint, s.boostpower, s.time, batch.finished[r], batch.lost[r], batch.checkpoint[r], batch.boostpower[r],
+                   endTime);
+            mismatches++;
+        }
+    }
+
+    printf("%d corridas de ate %.0f s\n", seeds, seconds);
+    if (firstTick < 0)
+    {
+        printf("posicoes iguais em todos os ticks\n");
+    }
+    else
+    {
+        printf("posicoes separam no tick %d, maior diferenca %g m (semente %d, tick %d)\n", firstTick, largest, largestRace + 1,
+               largestTick);
+    }
+    printf("%d corridas com resultado diferente\n", mismatches);
+    return firstTick < 0 && mismatches == 0 ? 0 : 1;
+}
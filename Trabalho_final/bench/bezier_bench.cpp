@@ -0,0 +1,240 @@
+// Avaliacao de bezier: o Bezier() antigo (vetor copiado duas vezes, .at()),
+// o Bezier() atual, bezierPoint<grau> (de Casteljau sem copias) e
+// BezierPolynomial<grau> (coeficientes calculados uma vez, Horner), nas
+// curvas da pista e nas trajetorias dos oponentes. Conta as alocacoes de
+// cada um e a maior diferenca para o Bezier() antigo. Por fim, bezierSamples
+// com 4, 8 e 16 parametros por chamada em cada conjunto de instrucoes, contra
+// BezierPolynomial<3> ponto a ponto (pontos e tangentes).
+//
+//   ./bench_bezier [avaliacoes]
+//
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "bezierbatch.h"
+#include "track.h"
+
+// avaliado pelo compilador
+static constexpr float scalarPoints[4] = {0.0f, 1.0f, 3.0f, 2.0f};
+static_assert(bezierPoint<3>(scalarPoints, 0.5f) == 1.75f, "de Casteljau em tempo de compilacao");
+static_assert(BezierPolynomial<3, float>(scalarPoints)(0.5f) == 1.75f, "polinomio em tempo de compilacao");
+
+static long long allocations = 0;
+
+void *operator new(size_t size)
+{
+    allocations++;
+    void *p = malloc(size);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+// o Bezier() de antes
+static glm::vec4 copyingBezier(std::vector<glm::vec4> controlPoints, int degree, float point)
+{
+    std::vector<glm::vec4> points = controlPoints;
+    int i = degree;
+    while (i > 0)
+    {
+        for (int j = 0; j < i; j++)
+        {
+            points.at(j) = (points[j] + point * (points[j + 1] - points[j]));
+        }
+        i--;
+    }
+    return points[0];
+}
+
+struct Run
+{
+    const char *name;
+    double ns;
+    long long allocations;
+    float error;
+};
+
+static void print(const Run &run)
+{
+    printf("%-24s %9.2f %12lld %12g\n", run.name, run.ns, run.allocations, run.error);
+}
+
+template <typename F>
+static Run measure(const char *name, int count, const std::vector<glm::vec4> &reference, F evaluate)
+{
+    std::vector<glm::vec4> out(count);
+    long long before = allocations;
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+    {
+        out[i] = evaluate(i);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    Run run;
+    run.name = name;
+    run.ns = seconds * 1e9 / count;
+    run.allocations = allocations - before;
+    run.error = 0;
+    for (int i = 0; i < count && !reference.empty(); i++)
+    {
+        glm::vec4 d = out[i] - reference[i];
+        run.error = std::max(run.error, std::max(std::fabs(d.x), std::max(std::fabs(d.y), std::fabs(d.z))));
+    }
+    return run;
+}
+
+int main(int argc, char *argv[])
+{
+    int count = argc > 1 ? atoi(argv[1]) : 2000000;
+
+    RaceTrack track;
+    BuildDefaultTrack(track);
+    std::vector<std::vector<glm::vec4>> curves = track.curveList;
+    for (int p = 0; p < NUM_OPPONENTS; p++)
+    {
+        for (int s = 0; s < track.opponentPaths[p].segments(); s++)
+        {
+            const glm::vec4 *points = track.opponentPaths[p].controlPoints(s);
+            curves.push_back(std::vector<glm::vec4>(points, points + 4));
+        }
+    }
+    std::vector<BezierPolynomial<3>> polynomials;
+    for (size_t i = 0; i < curves.size(); i++)
+    {
+        polynomials.push_back(BezierPolynomial<3>(&curves[i][0]));
+    }
+    // grau 6: sete pontos seguidos das trajetorias
+    std::vector<std::vector<glm::vec4>> sextics;
+    for (size_t i = 0; i + 1 < curves.size(); i++)
+    {
+        std::vector<glm::vec4> points(curves[i].begin(), curves[i].begin() + 4);
+        points.insert(points.end(), curves[i + 1].begin() + 1, curves[i + 1].begin() + 4);
+        sextics.push_back(points);
+    }
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<int> which(count);
+    std::vector<float> t(count);
+    for (int i = 0; i < count; i++)
+    {
+        which[i] = (int)(rng() % curves.size());
+        t[i] = unit(rng);
+    }
+
+    printf("%zu curvas, %d avaliacoes\n\n", curves.size(), count);
+    printf("%-24s %9s %12s %12s\n", "grau 3", "ns/ponto", "alocacoes", "diferenca");
+    std::vector<glm::vec4> none;
+    Run old = measure("Bezier() antigo", count, none, [&](int i) { return copyingBezier(curves[which[i]], 3, t[i]); });
+    std::vector<glm::vec4> reference(count);
+    for (int i = 0; i < count; i++)
+    {
+        reference[i] = copyingBezier(curves[which[i]], 3, t[i]);
+    }
+    print(old);
+    print(measure("Bezier()", count, reference, [&](int i) { return Bezier(curves[which[i]], 3, t[i]); }));
+    print(measure("bezierPoint<3>", count, reference, [&](int i) { return bezierPoint<3>(&curves[which[i]][0], t[i]); }));
+    print(measure("BezierPolynomial<3>", count, reference, [&](int i) { return polynomials[which[i]](t[i]); }));
+
+    printf("\n%-24s %9s %12s %12s\n", "grau 6", "ns/ponto", "alocacoes", "diferenca");
+    for (int i = 0; i < count; i++)
+    {
+        which[i] %= (int)sextics.size();
+        reference[i] = copyingBezier(sextics[which[i]], 6, t[i]);
+    }
+    print(measure("Bezier() antigo", count, reference, [&](int i) { return copyingBezier(sextics[which[i]], 6, t[i]); }));
+    print(measure("Bezier()", count, reference, [&](int i) { return Bezier(sextics[which[i]], 6, t[i]); }));
+    print(measure("bezierPoint<6>", count, reference, [&](int i) { return bezierPoint<6>(&sextics[which[i]][0], t[i]); }));
+    std::vector<BezierPolynomial<6>> sexticPolynomials;
+    for (size_t i = 0; i < sextics.size(); i++)
+    {
+        sexticPolynomials.push_back(BezierPolynomial<6>(&sextics[i][0]));
+    }
+    print(measure("BezierPolynomial<6>", count, reference, [&](int i) { return sexticPolynomials[which[i]](t[i]); }));
+
+    // lotes: pontos e tangentes de uma curva em varios parametros
+    const int batch = 16;
+    int batches = count / batch;
+    std::vector<float> x(count), y(count), z(count), dx(count), dy(count), dz(count);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int b = 0; b < batches; b++)
+    {
+        const BezierPolynomial<3> &curve = polynomials[which[b * batch] % polynomials.size()];
+        for (int i = b * batch; i < (b + 1) * batch; i++)
+        {
+            glm::vec4 point = curve(t[i]);
+            glm::vec4 tangent = curve.tangent(t[i]);
+            x[i] = point.x;
+            y[i] = point.y;
+            z[i] = point.z;
+            dx[i] = tangent.x;
+            dy[i] = tangent.y;
+            dz[i] = tangent.z;
+        }
+    }
+    double loopNs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() * 1e9 / (batches * batch);
+    printf("\n%-24s %9s %12s\n", "pontos + tangentes", "ns/ponto", "diferentes");
+    printf("%-24s %9.2f %12s\n", "BezierPolynomial<3>", loopNs, "-");
+
+    const SimdIsa isas[] = {SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2};
+    const int sizes[] = {4, 8, 16};
+    std::vector<float> bx(count), by(count), bz(count), bdx(count), bdy(count), bdz(count);
+    std::vector<BezierBatchCurve> batchCurves;
+    for (size_t i = 0; i < polynomials.size(); i++)
+    {
+        batchCurves.push_back(BezierBatchCurve(polynomials[i]));
+    }
+    BezierSamples samples;
+    for (size_t s = 0; s < sizeof(isas) / sizeof(isas[0]); s++)
+    {
+        if (!setSimdIsa(isas[s]))
+        {
+            continue;
+        }
+        for (size_t n = 0; n < sizeof(sizes) / sizeof(sizes[0]); n++)
+        {
+            t0 = std::chrono::steady_clock::now();
+            for (int b = 0; b < batches; b++)
+            {
+                const BezierBatchCurve &curve = batchCurves[which[b * batch] % batchCurves.size()];
+                for (int i = b * batch; i < (b + 1) * batch; i += sizes[n])
+                {
+                    samples.x = &bx[i];
+                    samples.y = &by[i];
+                    samples.z = &bz[i];
+                    samples.dx = &bdx[i];
+                    samples.dy = &bdy[i];
+                    samples.dz = &bdz[i];
+                    bezierSamples(curve, &t[i], sizes[n], samples);
+                }
+            }
+            double ns = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() * 1e9 / (batches * batch);
+            int different = 0;
+            for (int i = 0; i < batches * batch; i++)
+            {
+                different += (bx[i] != x[i] || by[i] != y[i] || bz[i] != z[i] || bdx[i] != dx[i] || bdy[i] != dy[i] || bdz[i] != dz[i]) ? 1 : 0;
+            }
+            char name[32];
+            snprintf(name, sizeof(name), "bezierSamples %s x%d", simdIsaName(isas[s]), sizes[n]);
+            printf("%-24s %9.2f %12d\n", name, ns, different);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+// Custo por tick de achar todos os pares de carros encostando, com a grade
+// do broadphase contra testar todos os pares, para 10 a 10000 carros. A
+// coluna "update" e o OpponentPool::update (poses e grade) e "touching" o
+// OpponentPool::touching chamado depois, pela grade ou por todos os pares
+// conforme a quantidade de oponentes; a partir de onde a grade ganha de todos
+// os pares o pool passa a usa-la.
+//
+//   ./bench_broadphase [ticks]
+//
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+
+#include "opponentpool.h"
+#include "racesim.h"
+
+static long long bruteForce(const OpponentPool &pool, float radius)
+{
+    const int n = pool.size();
+    const float r2 = radius * radius;
+    long long found = 0;
+    for (int a = 0; a < n; a++)
+    {
+        for (int b = a + 1; b < n; b++)
+        {
+            float dx = pool.posX[a] - pool.posX[b];
+            float dy = pool.posY[a] - pool.posY[b];
+            float dz = pool.posZ[a] - pool.posZ[b];
+            if (dx * dx + dy * dy + dz * dz < r2)
+            {
+                found++;
+            }
+        }
+    }
+    return found;
+}
+
+// a grade montada do zero e os pares candidatos filtrados pela distancia,
+// o que OpponentPool::touching faz com muitos oponentes
+static long long gridPairs(const OpponentPool &pool, SpatialHash &grid, float radius, std::vector<CarPair> &pairs)
+{
+    const float r2 = radius * radius;
+    grid.build(pool.posX.data(), pool.posZ.data(), pool.size());
+    grid.pairs(radius, pairs);
+    long long found = 0;
+    for (size_t i = 0; i < pairs.size(); i++)
+    {
+        float dx = pool.posX[pairs[i].a] - pool.posX[pairs[i].b];
+        float dy = pool.posY[pairs[i].a] - pool.posY[pairs[i].b];
+        float dz = pool.posZ[pairs[i].a] - pool.posZ[pairs[i].b];
+        if (dx * dx + dy * dy + dz * dz < r2)
+        {
+            found++;
+        }
+    }
+    return found;
+}
+
+int main(int argc, char *argv[])
+{
+    int ticks = argc > 1 ? atoi(argv[1]) : 20;
+    const int counts[] = {10, 32, 64, 80, 96, 128, 1000, 10000};
+    const float radius = 2 * opponentHitboxRadius;
+    const float dt = 1.0f / SIM_TICK_RATE;
+
+    RaceTrack track;
+    BuildDefaultTrack(track);
+
+    printf("%8s %10s %14s %14s %14s %14s %8s\n", "cars", "pairs", "update us", "touching us", "grid us", "all pairs us", "match");
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+    {
+        int n = counts[c];
+        OpponentPool pool(track);
+        // ate 400 fileiras espalhadas pelas trajetorias, com mais carros lado
+        // a lado quando nao cabem, para a densidade nao crescer com n
+        int lanes = n / 400 + 1;
+        int rows = n / lanes + 1;
+        pool.addCrowd(n - pool.size(), lanes, 1.2f, pool.pathLength(0) * 0.8f / rows);
+
+        SpatialHash grid(radius);
+        std::vector<CarPair> pairs, contacts;
+        double update = 0.0, touching = 0.0, gridTime = 0.0, brute = 0.0;
+        long long found = 0;
+        bool match = true;
+        // os tempos pequenos sao medidos em varias repeticoes
+        const int repeats = n < 1000 ? 1000 : 1;
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            float time = 5.0f + tick * dt;
+            long long inGrid = 0, all = 0;
+            std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+            for (int k = 0; k < repeats; k++)
+            {
+                pool.update(time);
+            }
+            std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+            for (int k = 0; k < repeats; k++)
+            {
+                pool.touching(radius, contacts);
+            }
+            std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+            for (int k = 0; k < repeats; k++)
+            {
+                inGrid += gridPairs(pool, grid, radius, pairs);
+            }
+            std::chrono::steady_clock::time_point t3 = std::chrono::steady_clock::now();
+            for (int k = 0; k < repeats; k++)
+            {
+                all += bruteForce(pool, radius);
+            }
+            std::chrono::steady_clock::time_point t4 = std::chrono::steady_clock::now();
+            update += std::chrono::duration<double>(t1 - t0).count() / repeats;
+            touching += std::chrono::duration<double>(t2 - t1).count() / repeats;
+            gridTime += std::chrono::duration<double>(t3 - t2).count() / repeats;
+            brute += std::chrono::duration<double>(t4 - t3).count() / repeats;
+            found += (long long)contacts.size();
+            match = match && all == (long long)contacts.size() * repeats && inGrid == all;
+        }
+        printf("%8d %10lld %14.2f %14.2f %14.2f %14.2f %8s\n", n, found / ticks, update * 1e6 / ticks, touching * 1e6 / ticks,
+               gridTime * 1e6 / ticks, brute * 1e6 / ticks, match ? "yes" : "NO");
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+// Consulta das paredes: busca linear do checkAllbbox (com a lista copiada
+// por valor como antes, e por referencia) contra a arvore do CollisionWorld,
+// em pistas geradas com 100 a 10000 paredes e na pista do jogo.
+//
+//   ./bench_bvh [consultas]
+//
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "racesim.h"
+
+// assinatura antiga, a lista inteira era copiada a cada chamada
+static glm::vec4 checkAllbboxByValue(bbox player, std::vector<bbox> list)
+{
+    return checkAllbbox(player, list);
+}
+
+// oval com paredes por dentro e por fora, cada segmento uma caixa alinhada
+static void ovalTrack(int walls, std::vector<bbox> &boxes)
+{
+    boxes.clear();
+    int segments = walls / 2;
+    for (int side = 0; side < 2; side++)
+    {
+        float rx = side == 0 ? 400.0f : 408.0f;
+        float rz = side == 0 ? 150.0f : 158.0f;
+        for (int i = 0; i < segments; i++)
+        {
+            float a0 = 6.2831853f * i / segments;
+            float a1 = 6.2831853f * (i + 1) / segments;
+            float x0 = rx * std::cos(a0), z0 = rz * std::sin(a0);
+            float x1 = rx * std::cos(a1), z1 = rz * std::sin(a1);
+            bbox b;
+            b.minPoint = glm::vec4(std::min(x0, x1) - 0.4f, 0.167617f, std::min(z0, z1) - 0.4f, 0.0f);
+            b.maxPoint = glm::vec4(std::max(x0, x1) + 0.4f, 1.14384f, std::max(z0, z1) + 0.4f, 0.0f);
+            glm::vec4 normal = glm::vec4(-std::cos(a0), 0.0f, -std::sin(a0), 0.0f);
+            b.normal = side == 0 ? -normal : normal;
+            boxes.push_back(b);
+        }
+    }
+}
+
+static bbox playerBox(float x, float z)
+{
+    bbox b;
+    b.minPoint = glm::vec4(x - playerHalfExtent, -playerHalfExtent, z - playerHalfExtent, 1.0f);
+    b.maxPoint = glm::vec4(x + playerHalfExtent, playerHalfExtent, z + playerHalfExtent, 1.0f);
+    b.normal = glm::vec4(0.0f);
+    return b;
+}
+
+static void run(const char *name, const std::vector<bbox> &walls, const std::vector<bbox> &queries)
+{
+    std::vector<bbox> none;
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    CollisionWorld world;
+    world.build(walls, none);
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+    const int n = (int)queries.size();
+    std::vector<glm::vec4> linear(n), tree(n);
+    int byValueQueries = walls.size() > 1000 ? n / 10 : n;
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+    glm::vec4 sink = glm::vec4(0.0f);
+    for (int i = 0; i < byValueQueries; i++)
+    {
+        sink += checkAllbboxByValue(queries[i], walls);
+    }
+    std::chrono::steady_clock::time_point t3 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        linear[i] = checkAllbbox(queries[i], walls);
+    }
+    std::chrono::steady_clock::time_point t4 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        tree[i] = world.wallNormal(queries[i]);
+    }
+    std::chrono::steady_clock::time_point t5 = std::chrono::steady_clock::now();
+
+    int hits = 0;
+    bool match = true;
+    for (int i = 0; i < n; i++)
+    {
+        match = match && linear[i] == tree[i];
+        hits += linear[i] != glm::vec4(0.0f) ? 1 : 0;
+    }
+    printf("%-10s %7d %6d %9.1f %12.1f %12.1f %10.1f %6s (%d hits, %g)\n", name, (int)walls.size(), world.depth(),
+           std::chrono::duration<double>(t1 - t0).count() * 1e3,
+           std::chrono::duration<double>(t3 - t2).count() * 1e9 / byValueQueries,
+           std::chrono::duration<double>(t4 - t3).count() * 1e9 / n,
+           std::chrono::duration<double>(t5 - t4).count() * 1e9 / n,
+           match ? "yes" : "NO", hits, sink.x);
+}
+
+int main(int argc, char *argv[])
+{
+    int count = argc > 1 ? atoi(argv[1]) : 20000;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    printf("%-10s %7s %6s %9s %12s %12s %10s %6s\n", "track", "walls", "depth", "build ms", "by value ns", "by ref ns", "tree ns", "match");
+
+    // pista do jogo, carros ao longo da reta e das curvas
+    RaceTrack track;
+    BuildDefaultTrack(track);
+    std::vector<bbox> queries;
+    for (int i = 0; i < count; i++)
+    {
+        queries.push_back(playerBox(-40.0f + 200.0f * unit(rng), -10.0f + 80.0f * unit(rng)));
+    }
+    run("default", track.straightsBBoxes, queries);
+
+    // ovais: carros perto da linha central, alguns encostando nas paredes
+    const int sizes[] = {100, 1000, 10000};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        std::vector<bbox> walls;
+        ovalTrack(sizes[s], walls);
+        queries.clear();
+        for (int i = 0; i < count; i++)
+        {
+            float a = 6.2831853f * unit(rng);
+            float offset = 8.0f * unit(rng);
+            queries.push_back(playerBox((400.0f + offset) * std::cos(a), (150.0f + offset) * std::sin(a)));
+        }
+        run("oval", walls, queries);
+    }
+    return 0;
+}
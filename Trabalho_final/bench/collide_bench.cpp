@@ -0,0 +1,179 @@
+// Colisao em lote: N carros contra paredes, checkpoints, curvas e oponentes
+// (a pista com 256 oponentes a mais). Compara as chamadas por carro
+// (checkAllbbox, checkAllBezier, spheres_collision e as consultas do
+// CollisionWorld) com uma chamada de collideAll, numa thread e dividida no
+// pool, e confere que a saida dividida e igual a de uma thread e que o lote
+// acha os mesmos contatos que as consultas por carro. Termina com 1 se
+// alguma das duas conferencias falhar.
+//
+//   ./bench_collide [threads]
+//
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "racesim.h"
+#include "threadpool.h"
+
+static bool sameContact(const Contact &a, const Contact &b)
+{
+    if (a.wallNormal != b.wallNormal || a.checkpointNormal != b.checkpointNormal || a.curve != b.curve || a.carCount != b.carCount)
+    {
+        return false;
+    }
+    if (a.curve && (a.curveHit.point != b.curveHit.point || a.curveHit.normal != b.curveHit.normal || a.curveHit.t != b.curveHit.t))
+    {
+        return false;
+    }
+    for (int i = 0; i < std::min(a.carCount, (int)Contact::maxCars); i++)
+    {
+        if (a.cars[i] != b.cars[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static double elapsedNs(std::chrono::steady_clock::time_point begin, size_t count)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count() * 1e9 / count;
+}
+
+int main(int argc, char *argv[])
+{
+    int threads = argc > 1 ? atoi(argv[1]) : 0;
+    const size_t sizes[] = {1000, 10000, 100000};
+    const float reach = playerHitboxRadius + opponentHitboxRadius;
+
+    RaceTrack track;
+    BuildDefaultTrack(track);
+    const CollisionWorld &world = track.world;
+    OpponentPool opponents(track);
+    opponents.addCrowd(256);
+    opponents.update(8.0f);
+    CarSpheres spheres = opponents.spheres();
+
+    // posicoes por onde os carros passam: corridas com controles aleatorios
+    std::vector<glm::vec4> visited;
+    for (int r = 0; r < 50; r++)
+    {
+        RaceSim sim(track);
+        sim.start();
+        std::mt19937 rng(r);
+        while (sim.state.raceStart && sim.state.time < 20.0f)
+        {
+            unsigned int bits = rng();
+            RaceInputs inputs = RaceInputs();
+            inputs.forward = (bits & 7) != 0;
+            inputs.left = (bits & 0xc0) == 0;
+            inputs.right = (bits & 0x300) == 0;
+            inputs.boost = (bits & 0x3c00) == 0;
+            sim.step(inputs, 1.0f / SIM_TICK_RATE);
+            visited.push_back(sim.state.carPos);
+        }
+    }
+    // e as dos oponentes, para haver contato entre carros
+    for (int o = 0; o < opponents.size(); o++)
+    {
+        visited.push_back(glm::vec4(opponents.posX[o], 0.0f, opponents.posZ[o], 1.0f));
+    }
+
+    WorkStealingPool pool(threads);
+    printf("%d threads no pool\n\n", pool.threads());
+    printf("%8s %-22s %10s\n", "carros", "", "ns/carro");
+    bool mismatch = false;
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        size_t n = sizes[s];
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> jitter(-1.5f, 1.5f);
+        std::vector<CarState> cars(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            const glm::vec4 &p = visited[rng() % visited.size()];
+            cars[i].x = p.x + jitter(rng);
+            cars[i].z = p.z + jitter(rng);
+        }
+
+        // funcoes antigas, uma chamada de cada por carro (checkAllBezier e
+        // lento, so os primeiros carros)
+        size_t legacyCount = std::min(n, (size_t)2000);
+        int legacyContacts = 0;
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < legacyCount; i++)
+        {
+            glm::vec4 center(cars[i].x, 0.0f, cars[i].z, 1.0f);
+            bbox box;
+            box.minPoint = center - glm::vec4(playerHalfExtent, playerHalfExtent, playerHalfExtent, 0.0f);
+            box.maxPoint = center + glm::vec4(playerHalfExtent, playerHalfExtent, playerHalfExtent, 0.0f);
+            legacyContacts += checkAllbbox(box, track.straightsBBoxes) != glm::vec4(0.0f) ? 1 : 0;
+            legacyContacts += checkAllbbox(box, track.checkpoints) != glm::vec4(0.0f) ? 1 : 0;
+            legacyContacts += checkAllBezier(center, playerHitboxRadius, track.curveList, 0.01f) != glm::vec4(0.0f) ? 1 : 0;
+            for (int o = 0; o < opponents.size(); o++)
+            {
+                legacyContacts += spheres_collision(center, playerHitboxRadius, opponents.position(o), opponentHitboxRadius) ? 1 : 0;
+            }
+        }
+        printf("%8zu %-22s %10.1f\n", n, "funcoes por carro", elapsedNs(t0, legacyCount));
+
+        // consultas do CollisionWorld, uma chamada de cada por carro
+        std::vector<int> hits;
+        int worldContacts = 0;
+        t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; i++)
+        {
+            glm::vec4 center(cars[i].x, 0.0f, cars[i].z, 1.0f);
+            bbox box;
+            box.minPoint = center - glm::vec4(playerHalfExtent, playerHalfExtent, playerHalfExtent, 0.0f);
+            box.maxPoint = center + glm::vec4(playerHalfExtent, playerHalfExtent, playerHalfExtent, 0.0f);
+            CurveHit hit;
+            worldContacts += world.wallNormal(box) != glm::vec4(0.0f) ? 1 : 0;
+            worldContacts += world.checkpointNormal(box) != glm::vec4(0.0f) ? 1 : 0;
+            worldContacts += world.curveContact(center, playerHitboxRadius, hit) ? 1 : 0;
+            opponents.collide(center, reach, hits);
+            worldContacts += (int)hits.size();
+        }
+        printf("%8zu %-22s %10.1f\n", n, "CollisionWorld por carro", elapsedNs(t0, n));
+
+        CollideOptions options;
+        options.halfExtent = playerHalfExtent;
+        options.radius = playerHitboxRadius;
+        options.spheres = &spheres;
+        options.sphereReach = reach;
+        std::vector<std::vector<int>> scratch;
+        options.scratch = &scratch;
+        std::vector<Contact> single(n);
+        t0 = std::chrono::steady_clock::now();
+        world.collideAll(cars.data(), n, single.data(), options);
+        printf("%8zu %-22s %10.1f\n", n, "collideAll", elapsedNs(t0, n));
+
+        options.pool = &pool;
+        std::vector<Contact> split(n);
+        world.collideAll(cars.data(), n, split.data(), options);
+        t0 = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < 10; repeat++)
+        {
+            world.collideAll(cars.data(), n, split.data(), options);
+        }
+        printf("%8zu %-22s %10.1f\n", n, "collideAll no pool", elapsedNs(t0, n * 10));
+
+        int batchContacts = 0;
+        int different = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            batchContacts += (single[i].wallNormal != glm::vec4(0.0f) ? 1 : 0) + (single[i].checkpointNormal != glm::vec4(0.0f) ? 1 : 0) +
+                             (single[i].curve ? 1 : 0) + single[i].carCount;
+            different += sameContact(single[i], split[i]) ? 0 : 1;
+        }
+        printf("%8s contatos: %d por carro, %d em lote; saida do pool diferente em %d carros\n\n", "", worldContacts, batchContacts, different);
+        mismatch = mismatch || different != 0 || worldContacts != batchContacts;
+    }
+    if (mismatch)
+    {
+        printf("collideAll difere das consultas por carro ou entre uma thread e o pool\n");
+    }
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,100 @@
+// Colisao com as curvas: checkAllBezier (101 pontos por curva, sem copiar
+// a lista) contra o CurveCollider (polilinha adaptativa em grade +
+// Newton), na pista do jogo. Tambem mede o erro do ponto mais proximo contra
+// uma amostragem densa de cada curva.
+//
+//   ./bench_curve [consultas]
+//
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "bezier.h"
+#include "racesim.h"
+
+// menor distancia ate a curva amostrando 20000 pontos
+static float denseDistance(const std::vector<glm::vec4> &curve, const glm::vec4 &center)
+{
+    float best = 1e30f;
+    for (int i = 0; i <= 20000; i++)
+    {
+        glm::vec4 p = Bezier(curve, 3, i / 20000.0f);
+        float dx = p.x - center.x;
+        float dz = p.z - center.z;
+        best = std::min(best, std::sqrt(dx * dx + dz * dz));
+    }
+    return best;
+}
+
+int main(int argc, char *argv[])
+{
+    int count = argc > 1 ? atoi(argv[1]) : 20000;
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    RaceTrack track;
+    BuildDefaultTrack(track);
+
+    // carros perto das curvas, metade encostando
+    std::vector<glm::vec4> queries;
+    for (int i = 0; i < count; i++)
+    {
+        const std::vector<glm::vec4> &curve = track.curveList[rng() % track.curveList.size()];
+        glm::vec4 p = Bezier(curve, 3, unit(rng));
+        float a = 6.2831853f * unit(rng);
+        float r = 1.6f * unit(rng);
+        queries.push_back(glm::vec4(p.x + r * std::cos(a), 0.0f, p.z + r * std::sin(a), 1.0f));
+    }
+
+    printf("%9s %9s %9s\n", "tolerance", "segments", "build us");
+    const float tolerances[] = {0.1f, 0.01f, 0.001f};
+    for (size_t i = 0; i < sizeof(tolerances) / sizeof(tolerances[0]); i++)
+    {
+        CurveCollider collider;
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        collider.build(track.curveList, tolerances[i]);
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+        printf("%9g %9d %9.1f\n", tolerances[i], collider.segmentCount(), std::chrono::duration<double>(t1 - t0).count() * 1e6);
+    }
+
+    const CurveCollider &collider = track.world.curves();
+    std::vector<glm::vec4> legacy(count);
+    std::vector<CurveHit> hits(count);
+    std::vector<unsigned char> hit(count);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+    {
+        legacy[i] = checkAllBezier(queries[i], playerHitboxRadius, track.curveList, 0.01f);
+    }
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+    {
+        hit[i] = collider.closest(queries[i], playerHitboxRadius, hits[i]);
+    }
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+    // colisao igual nos dois, a menos de quem esta a um passo de amostragem da borda
+    int legacyHits = 0, colliderHits = 0, agree = 0;
+    float worstError = 0;
+    for (int i = 0; i < count; i++)
+    {
+        bool old = legacy[i] != glm::vec4(0.0f);
+        legacyHits += old ? 1 : 0;
+        colliderHits += hit[i] ? 1 : 0;
+        agree += old == (hit[i] != 0) ? 1 : 0;
+        if (hit[i] && i % 20 == 0)
+        {
+            float dense = denseDistance(track.curveList[hits[i].curve], queries[i]);
+            worstError = std::max(worstError, std::fabs(dense - hits[i].distance));
+        }
+    }
+
+    printf("\n%-16s %10s %8s\n", "", "ns/query", "hits");
+    printf("%-16s %10.1f %8d\n", "checkAllBezier", std::chrono::duration<double>(t1 - t0).count() * 1e9 / count, legacyHits);
+    printf("%-16s %10.1f %8d\n", "CurveCollider", std::chrono::duration<double>(t2 - t1).count() * 1e9 / count, colliderHits);
+    printf("mesmo resultado em %d de %d consultas, erro maximo da distancia %g m\n", agree, count, worstError);
+    return 0;
+}
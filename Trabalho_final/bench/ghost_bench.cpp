@@ -0,0 +1,114 @@
+// Custo por quadro de atualizar fantasmas lidos de arquivos mapeados em
+// memoria, e verificacao de que a atualizacao nao aloca memoria.
+//
+//   ./bench_ghost [fantasmas]
+//
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "ghost.h"
+#include "rollout.h"
+
+static long long allocations = 0;
+
+void *operator new(size_t size)
+{
+    allocations++;
+    void *p = malloc(size ? size : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+int main(int argc, char *argv[])
+{
+    int count = argc > 1 ? atoi(argv[1]) : 50;
+    if (count > MAX_GHOSTS)
+    {
+        count = MAX_GHOSTS;
+    }
+
+    RaceTrack track;
+    BuildDefaultTrack(track);
+    const float dt = 1.0f / SIM_TICK_RATE;
+
+    // um fantasma por semente do piloto automatico
+    std::vector<char> names(count * 32);
+    float longest = 0.0f;
+    for (int i = 0; i < count; i++)
+    {
+        char *name = &names[i * 32];
+        snprintf(name, 32, "bench_ghost_%d.fzg", i);
+        GhostWriter writer;
+        if (!writer.open(name, SIM_TICK_RATE))
+        {
+            return EXIT_FAILURE;
+        }
+        RaceSim sim(track);
+        sim.start();
+        std::mt19937 rng(100 + i);
+        writer.record(sim.state.modelPlayer);
+        while (sim.state.raceStart && sim.state.time < 20.0f)
+        {
+            sim.step(seededInputs(rng, sim.state), dt);
+            writer.record(sim.state.modelPlayer);
+        }
+        if (sim.state.time > longest)
+        {
+            longest = sim.state.time;
+        }
+        writer.close();
+    }
+
+    GhostSet ghosts;
+    for (int i = 0; i < count; i++)
+    {
+        if (!ghosts.add(&names[i * 32]))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // quadros de 60 Hz ao longo da corrida mais longa, varias vezes
+    const int passes = 20;
+    const float frameDt = 1.0f / 60.0f;
+    int frames = 0;
+    float checksum = 0.0f;
+    long long allocationsBefore = allocations;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; pass++)
+    {
+        for (float time = 0.0f; time < longest + 1.0f; time += frameDt)
+        {
+            ghosts.update(time);
+            for (int i = 0; i < ghosts.size(); i++)
+            {
+                checksum += ghosts.model(i)[3][0];
+            }
+            frames++;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    long long updateAllocations = allocations - allocationsBefore;
+
+    for (int i = 0; i < count; i++)
+    {
+        remove(&names[i * 32]);
+    }
+
+    printf("%d ghosts, %.1f s races, %d frames (checksum %g)\n", ghosts.size(), longest, frames, checksum);
+    printf("%.3f us per frame, %.1f ns per ghost, %lld allocations while updating\n",
+           seconds * 1e6 / frames, seconds * 1e9 / frames / ghosts.size(), updateAllocations);
+    return updateAllocations == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,124 @@
+// Consultas com dica por carro: as posicoes de corridas com controles
+// aleatorios sao gravadas tick a tick e depois consultadas em ordem (paredes,
+// checkpoints e curvas), sem dica e com dicas de varias margens. Mostra a
+// taxa de acerto da dica, quantos nos, caixas e segmentos cada consulta
+// olhou e se o resultado muda.
+//
+//   ./bench_hint [corridas]
+//
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "racesim.h"
+
+struct Result
+{
+    glm::vec4 wall;
+    glm::vec4 check;
+    bool curve;
+    glm::vec4 curveNormal;
+};
+
+static bbox carBox(const glm::vec4 &p)
+{
+    bbox box;
+    box.minPoint = glm::vec4(p.x - playerHalfExtent, p.y - playerHalfExtent, p.z - playerHalfExtent, p.w);
+    box.maxPoint = glm::vec4(p.x + playerHalfExtent, p.y + playerHalfExtent, p.z + playerHalfExtent, p.w);
+    box.normal = glm::vec4(0.0f);
+    return box;
+}
+
+int main(int argc, char *argv[])
+{
+    int races = argc > 1 ? atoi(argv[1]) : 200;
+
+    RaceTrack track;
+    BuildDefaultTrack(track);
+    const CollisionWorld &world = track.world;
+
+    // trajetorias: uma lista de posicoes por corrida, em ordem de tick
+    std::vector<std::vector<glm::vec4>> paths(races);
+    size_t ticks = 0;
+    for (int r = 0; r < races; r++)
+    {
+        RaceSim sim(track);
+        sim.start();
+        std::mt19937 rng(r);
+        float dt = 1.0f / SIM_TICK_RATE;
+        while (sim.state.raceStart && paths[r].size() < 6000)
+        {
+            unsigned int bits = rng();
+            RaceInputs inputs = RaceInputs();
+            inputs.forward = (bits & 7) != 0;
+            inputs.back = (bits & 0x38) == 0;
+            inputs.left = (bits & 0xc0) == 0;
+            inputs.right = (bits & 0x300) == 0;
+            inputs.boost = (bits & 0x3c00) == 0;
+            paths[r].push_back(sim.state.carPos);
+            sim.step(inputs, dt);
+        }
+        ticks += paths[r].size();
+    }
+    printf("%d corridas, %zu ticks\n\n", races, ticks);
+
+    // sem dica
+    std::vector<Result> expected(ticks);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    size_t k = 0;
+    for (int r = 0; r < races; r++)
+    {
+        for (size_t i = 0; i < paths[r].size(); i++, k++)
+        {
+            bbox box = carBox(paths[r][i]);
+            CurveHit hit;
+            expected[k].wall = world.wallNormal(box);
+            expected[k].check = world.checkpointNormal(box);
+            expected[k].curve = world.curveContact(paths[r][i], playerHitboxRadius, hit);
+            expected[k].curveNormal = expected[k].curve ? hit.normal : glm::vec4(0.0f);
+        }
+    }
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    double fullNs = std::chrono::duration<double>(t1 - t0).count() * 1e9 / ticks;
+
+    printf("%-10s %10s %8s %12s %9s\n", "margem", "ns/tick", "acerto", "testes/cons", "diferem");
+    printf("%-10s %10.1f %8s %12s %9s\n", "sem dica", fullNs, "-", "-", "-");
+    const float margins[] = {0.0f, 0.25f, 1.0f, 2.0f, 4.0f};
+    for (size_t m = 0; m < sizeof(margins) / sizeof(margins[0]); m++)
+    {
+        long long queries = 0, hits = 0, tests = 0;
+        int mismatches = 0;
+        std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+        k = 0;
+        for (int r = 0; r < races; r++)
+        {
+            CollisionHint hint(margins[m]);
+            for (size_t i = 0; i < paths[r].size(); i++, k++)
+            {
+                bbox box = carBox(paths[r][i]);
+                CurveHit hit;
+                Result result;
+                result.wall = world.wallNormal(box, hint);
+                result.check = world.checkpointNormal(box, hint);
+                result.curve = world.curveContact(paths[r][i], playerHitboxRadius, hit, hint);
+                result.curveNormal = result.curve ? hit.normal : glm::vec4(0.0f);
+                if (result.wall != expected[k].wall || result.check != expected[k].check ||
+                    result.curve != expected[k].curve || result.curveNormal != expected[k].curveNormal)
+                {
+                    mismatches++;
+                }
+            }
+            queries += hint.queries;
+            hits += hint.hits;
+            tests += hint.tests;
+        }
+        std::chrono::steady_clock::time_point t3 = std::chrono::steady_clock::now();
+        char name[32];
+        snprintf(name, sizeof(name), "%g m", margins[m]);
+        printf("%-10s %10.1f %7.1f%% %12.2f %9d\n", name, std::chrono::duration<double>(t3 - t2).count() * 1e9 / ticks,
+               100.0 * hits / queries, (double)tests / queries, mismatches);
+    }
+    return 0;
+}
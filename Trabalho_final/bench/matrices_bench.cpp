@@ -0,0 +1,298 @@
+// Funcoes de matrices.h com codigo escalar, com SSE e os operadores e funcoes
+// da propria GLM: produto de matrizes, matriz por vetor, produto vetorial,
+// produto escalar, normalizacao e a sequencia Translate * Rotate_Y *
+// Translate * model que gira o carro do player. Mostra o tempo por operacao
+// e a maior diferenca de cada versao para a GLM (zero: mesmas operacoes na
+// mesma ordem).
+//
+//   ./bench_matrices [repeticoes]
+//
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+
+#include <glm/geometric.hpp>
+
+#include "matrices.h"
+
+static const int count = 1024;
+static const int rounds = 10;
+
+enum Variant
+{
+    SCALAR,
+    SIMD,
+    GLM
+};
+static const char *variantNames[3] = {"escalar", "SSE", "GLM"};
+
+static float randomFloat()
+{
+    return 2.0f * rand() / RAND_MAX - 1.0f;
+}
+
+static float maxDifference(const glm::vec4 &a, const glm::vec4 &b)
+{
+    glm::vec4 d = glm::abs(a - b);
+    return std::max(std::max(d.x, d.y), std::max(d.z, d.w));
+}
+
+static float maxDifference(const glm::mat4 &a, const glm::mat4 &b)
+{
+    float d = 0.0f;
+    for (int c = 0; c < 4; c++)
+    {
+        d = std::max(d, maxDifference(a[c], b[c]));
+    }
+    return d;
+}
+
+struct Inputs
+{
+    std::vector<glm::mat4> a, b;
+    std::vector<glm::vec4> u, v;
+    std::vector<float> angle;
+};
+
+// resultados de uma versao, comparados com os da GLM
+struct Outputs
+{
+    std::vector<glm::mat4> m;
+    std::vector<glm::vec4> v;
+    std::vector<float> f;
+};
+
+typedef void (*Kernel)(const Inputs &in, Outputs &out, Variant variant);
+
+static void multiplyMatrices(const Inputs &in, Outputs &out, Variant variant)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (variant == SCALAR)
+        {
+            out.m[i] = Matrix_MultiplyScalar(in.a[i], in.b[i]);
+        }
+#ifdef MATRICES_HAS_SSE
+        else if (variant == SIMD)
+        {
+            out.m[i] = Matrix_MultiplySimd(in.a[i], in.b[i]);
+        }
+#endif
+        else
+        {
+            out.m[i] = in.a[i] * in.b[i];
+        }
+    }
+}
+
+static void multiplyVector(const Inputs &in, Outputs &out, Variant variant)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (variant == SCALAR)
+        {
+            out.v[i] = Matrix_MultiplyScalar(in.a[i], in.u[i]);
+        }
+#ifdef MATRICES_HAS_SSE
+        else if (variant == SIMD)
+        {
+            out.v[i] = Matrix_MultiplySimd(in.a[i], in.u[i]);
+        }
+#endif
+        else
+        {
+            out.v[i] = in.a[i] * in.u[i];
+        }
+    }
+}
+
+static void cross(const Inputs &in, Outputs &out, Variant variant)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (variant == SCALAR)
+        {
+            out.v[i] = crossproductScalar(in.u[i], in.v[i]);
+        }
+#ifdef MATRICES_HAS_SSE
+        else if (variant == SIMD)
+        {
+            out.v[i] = crossproductSimd(in.u[i], in.v[i]);
+        }
+#endif
+        else
+        {
+            out.v[i] = glm::vec4(glm::cross(glm::vec3(in.u[i]), glm::vec3(in.v[i])), 0.0f);
+        }
+    }
+}
+
+static void dot(const Inputs &in, Outputs &out, Variant variant)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (variant == SCALAR)
+        {
+            out.f[i] = dotproductScalar(in.u[i], in.v[i]);
+        }
+#ifdef MATRICES_HAS_SSE
+        else if (variant == SIMD)
+        {
+            out.f[i] = dotproductSimd(in.u[i], in.v[i]);
+        }
+#endif
+        else
+        {
+            out.f[i] = glm::dot(glm::vec3(in.u[i]), glm::vec3(in.v[i]));
+        }
+    }
+}
+
+static void unit(const Inputs &in, Outputs &out, Variant variant)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (variant == SCALAR)
+        {
+            out.v[i] = unitvectorScalar(in.u[i]);
+        }
+#ifdef MATRICES_HAS_SSE
+        else if (variant == SIMD)
+        {
+            out.v[i] = unitvectorSimd(in.u[i]);
+        }
+#endif
+        else
+        {
+            out.v[i] = glm::normalize(in.u[i]);
+        }
+    }
+}
+
+// o giro do carro do player de RaceSim: Translate * Rotate_Y * Translate * model
+static void rotateAround(const Inputs &in, Outputs &out, Variant variant)
+{
+    for (int i = 0; i < count; i++)
+    {
+        const glm::vec4 &p = in.u[i];
+        glm::mat4 there = Matrix_Translate(p.x, p.y, p.z);
+        glm::mat4 rotation = Matrix_Rotate_Y(in.angle[i]);
+        glm::mat4 back = Matrix_Translate(-p.x, -p.y, -p.z);
+        if (variant == SCALAR)
+        {
+            out.m[i] = Matrix_MultiplyScalar(Matrix_MultiplyScalar(Matrix_MultiplyScalar(there, rotation), back), in.a[i]);
+        }
+#ifdef MATRICES_HAS_SSE
+        else if (variant == SIMD)
+        {
+            out.m[i] = Matrix_MultiplySimd(Matrix_MultiplySimd(Matrix_MultiplySimd(there, rotation), back), in.a[i]);
+        }
+#endif
+        else
+        {
+            out.m[i] = there * rotation * back * in.a[i];
+        }
+    }
+}
+
+static float checksum(const Outputs &out)
+{
+    float sum = 0.0f;
+    for (int i = 0; i < count; i++)
+    {
+        sum += out.m[i][3][0] + out.v[i].x + out.f[i];
+    }
+    return sum;
+}
+
+int main(int argc, char *argv[])
+{
+    int repetitions = argc > 1 ? atoi(argv[1]) : 2000;
+
+    srand(11);
+    Inputs in;
+    for (int i = 0; i < count; i++)
+    {
+        glm::mat4 a, b;
+        for (int c = 0; c < 4; c++)
+        {
+            a[c] = glm::vec4(randomFloat(), randomFloat(), randomFloat(), randomFloat());
+            b[c] = glm::vec4(randomFloat(), randomFloat(), randomFloat(), randomFloat());
+        }
+        in.a.push_back(a);
+        in.b.push_back(b);
+        // vetores (w = 0), como pedem dotproduct() e crossproduct()
+        in.u.push_back(glm::vec4(randomFloat(), randomFloat(), randomFloat(), 0.0f));
+        in.v.push_back(glm::vec4(randomFloat(), randomFloat(), randomFloat(), 0.0f));
+        in.angle.push_back(3.14159265f * randomFloat());
+    }
+
+    const char *names[] = {"mat4 * mat4", "mat4 * vec4", "crossproduct", "dotproduct", "unitvector", "T * R_Y * T * M"};
+    const Kernel kernels[] = {multiplyMatrices, multiplyVector, cross, dot, unit, rotateAround};
+#ifdef MATRICES_HAS_SSE
+    const bool hasSimd = true;
+#else
+    const bool hasSimd = false; // sem SSE a coluna fica vazia
+#endif
+#ifdef MATRICES_SIMD
+    printf("%d operacoes x %d repeticoes, matrices.h usa SSE\n", count, repetitions);
+#else
+    printf("%d operacoes x %d repeticoes, matrices.h usa codigo escalar\n", count, repetitions);
+#endif
+    printf("%18s %12s %12s %12s %25s\n", "ns/op", variantNames[SCALAR], variantNames[SIMD], variantNames[GLM], "diferenca da GLM");
+    printf("%18s %12s %12s %12s %12s %12s\n", "", "", "", "", variantNames[SCALAR], variantNames[SIMD]);
+
+    float sum = 0.0f;
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+    {
+        Outputs out[3];
+        double ns[3];
+        float difference[2] = {0.0f, 0.0f};
+        // as versoes se alternam em rodadas e vale a mais rapida de cada uma,
+        // para que uma oscilacao da CPU nao pese so sobre uma delas
+        for (int v = SCALAR; v <= GLM; v++)
+        {
+            out[v].m.assign(count, glm::mat4(0.0f));
+            out[v].v.assign(count, glm::vec4(0.0f));
+            out[v].f.assign(count, 0.0f);
+            ns[v] = 1e30;
+        }
+        for (int round = 0; round < rounds; round++)
+        {
+            for (int v = SCALAR; v <= GLM; v++)
+            {
+                if (v == SIMD && !hasSimd)
+                {
+                    continue;
+                }
+                std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+                for (int r = 0; r < repetitions / rounds; r++)
+                {
+                    kernels[k](in, out[v], (Variant)v);
+                }
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+                ns[v] = std::min(ns[v], seconds * 1e9 / ((double)(repetitions / rounds) * count));
+                sum += checksum(out[v]);
+            }
+        }
+        if (!hasSimd)
+        {
+            ns[SIMD] = 0.0;
+        }
+        for (int v = SCALAR; v <= SIMD && (v == SCALAR || hasSimd); v++)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                difference[v] = std::max(difference[v], maxDifference(out[v].m[i], out[GLM].m[i]));
+                difference[v] = std::max(difference[v], maxDifference(out[v].v[i], out[GLM].v[i]));
+                difference[v] = std::max(difference[v], std::fabs(out[v].f[i] - out[GLM].f[i]));
+            }
+        }
+        printf("%18s %12.2f %12.2f %12.2f %12g %12g\n", names[k], ns[SCALAR], ns[SIMD], ns[GLM], difference[SCALAR], difference[SIMD]);
+    }
+    printf("(checksum %g)\n", sum);
+    return 0;
+}
@@ -0,0 +1,127 @@
+// Colisor de malha: carrega as paredes de data/Track.obj, monta a BVH e mede
+// consultas de esfera (o carro) e de raio contra a malha, conferindo com o
+// teste de todos os triangulos.
+//
+//   ./bench_mesh [Track.obj] [consultas]
+//
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "racesim.h"
+
+static double seconds(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b)
+{
+    return std::chrono::duration<double>(b - a).count();
+}
+
+int main(int argc, char *argv[])
+{
+    const char *filename = argc > 1 ? argv[1] : "data/Track.obj";
+    int count = argc > 2 ? atoi(argv[2]) : 100000;
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    RaceTrack track;
+    BuildDefaultTrack(track);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    if (!LoadTrackMesh(track, filename))
+    {
+        return 1;
+    }
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    const TrackMesh &mesh = track.mesh;
+
+    // so a montagem da BVH, sem ler o arquivo
+    std::vector<glm::vec4> vertices;
+    for (int i = 0; i < mesh.triangleCount(); i++)
+    {
+        glm::vec4 a, b, c;
+        mesh.triangle(i, a, b, c);
+        vertices.push_back(a);
+        vertices.push_back(b);
+        vertices.push_back(c);
+    }
+    TrackMesh rebuilt;
+    const int builds = 20;
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+    for (int i = 0; i < builds; i++)
+    {
+        rebuilt.build(vertices);
+    }
+    std::chrono::steady_clock::time_point t3 = std::chrono::steady_clock::now();
+
+    printf("%d triangulos de parede, %d nos, profundidade %d\n", mesh.triangleCount(), mesh.nodeCount(), mesh.depth());
+    printf("carregar .obj + BVH %.1f ms, so BVH %.2f ms\n\n", seconds(t0, t1) * 1e3, seconds(t2, t3) * 1e3 / builds);
+
+    // carros na altura da simulacao, espalhados pela pista
+    glm::vec4 min, max;
+    mesh.bounds(min, max);
+    std::vector<glm::vec4> centers(count), directions(count);
+    for (int i = 0; i < count; i++)
+    {
+        centers[i] = glm::vec4(min.x + (max.x - min.x) * unit(rng), 0.0f, min.z + (max.z - min.z) * unit(rng), 1.0f);
+        float a = 6.2831853f * unit(rng);
+        directions[i] = glm::vec4(std::cos(a), 0.0f, std::sin(a), 0.0f);
+    }
+
+    std::vector<MeshHit> spheres(count), rays(count);
+    std::vector<unsigned char> sphereHit(count), rayHit(count);
+    std::chrono::steady_clock::time_point t4 = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+    {
+        sphereHit[i] = mesh.sphere(centers[i], playerHitboxRadius, spheres[i]);
+    }
+    std::chrono::steady_clock::time_point t5 = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+    {
+        rayHit[i] = mesh.ray(centers[i], directions[i], 50.0f, rays[i]);
+    }
+    std::chrono::steady_clock::time_point t6 = std::chrono::steady_clock::now();
+
+    // referencia: cada triangulo sozinho, testados todos
+    std::vector<TrackMesh> single(mesh.triangleCount());
+    for (int k = 0; k < mesh.triangleCount(); k++)
+    {
+        single[k].build(std::vector<glm::vec4>(vertices.begin() + 3 * k, vertices.begin() + 3 * k + 3));
+    }
+    int checked = std::min(count, 2000);
+    int sphereMismatch = 0, rayMismatch = 0, sphereHits = 0, rayHits = 0;
+    std::chrono::steady_clock::time_point t7 = std::chrono::steady_clock::now();
+    for (int i = 0; i < checked; i++)
+    {
+        bool touching = false, crossing = false;
+        float nearest = 1e30f, first = 1e30f;
+        for (int k = 0; k < mesh.triangleCount(); k++)
+        {
+            MeshHit hit;
+            if (single[k].sphere(centers[i], playerHitboxRadius, hit))
+            {
+                touching = true;
+                nearest = std::min(nearest, hit.distance);
+            }
+            if (single[k].ray(centers[i], directions[i], 50.0f, hit))
+            {
+                crossing = true;
+                first = std::min(first, hit.distance);
+            }
+        }
+        sphereMismatch += touching != (sphereHit[i] != 0) || (touching && std::fabs(nearest - spheres[i].distance) > 1e-4f);
+        rayMismatch += crossing != (rayHit[i] != 0) || (crossing && std::fabs(first - rays[i].distance) > 1e-3f);
+    }
+    std::chrono::steady_clock::time_point t8 = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+    {
+        sphereHits += sphereHit[i];
+        rayHits += rayHit[i];
+    }
+
+    printf("%-8s %10s %10s %10s %14s\n", "query", "ns/query", "hits", "mismatch", "cars/ms");
+    printf("%-8s %10.1f %10d %10d %14.0f\n", "sphere", seconds(t4, t5) * 1e9 / count, sphereHits, sphereMismatch, count / (seconds(t4, t5) * 1e3));
+    printf("%-8s %10.1f %10d %10d %14.0f\n", "ray", seconds(t5, t6) * 1e9 / count, rayHits, rayMismatch, count / (seconds(t5, t6) * 1e3));
+    printf("(todos os triangulos: %.0f ns por carro, esfera + raio)\n", seconds(t7, t8) * 1e9 / checked);
+    return 0;
+}
@@ -0,0 +1,224 @@
+// Custo de mover e colidir muitos oponentes por tick: OpponentPool contra o
+// codigo antigo, que chamava opponentMovement() para cada oponente (com as
+// seis listas de pontos copiadas e a matriz acumulada, como era) e contra o
+// opponentMovement() atual, que monta a matriz a partir da BezierSpline. Mostra
+// tambem a velocidade de cada oponente da pista ao longo da trajetoria, que
+// variava com o tamanho dos segmentos e agora e constante.
+//
+//   ./bench_opponents [ticks]
+//
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+
+#include "matrices.h"
+#include "opponent.h"
+#include "opponentpool.h"
+#include "racesim.h"
+
+// segundos por segmento de bezier do codigo antigo
+static const float legacyTimeScale[NUM_OPPONENTS] = {5.0f, 8.0f};
+
+// o opponentMovement() de antes: seis listas copiadas e um if por segmento
+static glm::mat4 copyingMovement(glm::mat4 model, float bezierTime, std::vector<glm::vec4> controlPoints1, std::vector<glm::vec4> controlPoints2, std::vector<glm::vec4> controlPoints3, std::vector<glm::vec4> controlPoints4, std::vector<glm::vec4> controlPoints5, std::vector<glm::vec4> controlPoints6, int degree, glm::vec4 &forward, glm::vec4 &pos, glm::vec4 &oldpos)
+{
+    glm::mat4 returnModel = model;
+    glm::vec4 BezierPoint;
+    if (bezierTime <= 1)
+    {
+        BezierPoint = Bezier(controlPoints1, degree, bezierTime);
+    }
+    else if (bezierTime <= 2)
+    {
+        BezierPoint = Bezier(controlPoints2, degree, bezierTime - 1);
+    }
+    else if (bezierTime <= 3)
+    {
+        BezierPoint = Bezier(controlPoints3, degree, bezierTime - 2);
+    }
+    else if (bezierTime <= 4)
+    {
+        BezierPoint = Bezier(controlPoints4, degree, bezierTime - 3);
+    }
+    else if (bezierTime <= 5)
+    {
+        BezierPoint = Bezier(controlPoints5, degree, bezierTime - 4);
+    }
+    else if (bezierTime <= 6)
+    {
+        BezierPoint = Bezier(controlPoints6, degree, bezierTime - 5);
+    }
+    else
+    {
+        return returnModel;
+    }
+    glm::vec4 newPoint = BezierPoint - oldpos;
+    float dotprod = std::min(std::max(dotproduct(normalize(newPoint), forward), -1.0f), 1.0f);
+    float angle = acos(dotprod);
+    if (crossproduct(newPoint, forward).y < 0)
+    {
+        angle = -1 * angle;
+    }
+    forward = normalize(newPoint);
+    returnModel = Matrix_Translate(pos.x, pos.y, pos.z) * Matrix_Rotate_Y(-angle) * Matrix_Translate(-pos.x, -pos.y, -pos.z) * returnModel;
+    returnModel = Matrix_Translate(newPoint.x, newPoint.y, newPoint.z) * returnModel;
+    pos = Matrix_Translate(newPoint.x, newPoint.y, newPoint.z) * pos;
+    oldpos = BezierPoint;
+    return returnModel;
+}
+
+// estado de um oponente como era guardado antes do OpponentPool
+struct LegacyOpponent
+{
+    glm::mat4 model;
+    glm::vec4 forward, pos, oldpos;
+};
+
+static double legacyTicks(const RaceTrack &track, int count, int ticks, bool copying, float &checksum)
+{
+    // as listas de pontos de cada segmento, como eram guardadas na pista
+    std::vector<std::vector<glm::vec4>> lists[NUM_OPPONENTS];
+    for (int p = 0; p < NUM_OPPONENTS; p++)
+    {
+        for (int s = 0; s < track.opponentPaths[p].segments(); s++)
+        {
+            const glm::vec4 *points = track.opponentPaths[p].controlPoints(s);
+            lists[p].push_back(std::vector<glm::vec4>(points, points + 4));
+        }
+    }
+    std::vector<LegacyOpponent> opponents(count);
+    for (int i = 0; i < count; i++)
+    {
+        int p = i % NUM_OPPONENTS;
+        opponents[i].oldpos = track.opponentStart[p];
+        opponents[i].model = Matrix_Translate(track.opponentStart[p].x, track.opponentStart[p].y, track.opponentStart[p].z) * Matrix_Rotate_Y(3.14159265f / 2) * Matrix_Scale(0.0012f, 0.0012f, 0.0012f);
+        opponents[i].forward = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+        opponents[i].pos = track.opponentStart[p];
+    }
+    const float dt = 1.0f / SIM_TICK_RATE;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int tick = 1; tick <= ticks; tick++)
+    {
+        glm::vec4 player = glm::vec4(tick * dt * 20.0f, 0.0f, 0.0f, 1.0f);
+        for (int i = 0; i < count; i++)
+        {
+            int p = i % NUM_OPPONENTS;
+            LegacyOpponent &o = opponents[i];
+            if (spheres_collision(player, playerHitboxRadius, o.pos, opponentHitboxRadius))
+            {
+                checksum += 1.0f;
+            }
+            float bezierTime = tick * dt / legacyTimeScale[p];
+            if (copying)
+            {
+                const std::vector<std::vector<glm::vec4>> &path = lists[p];
+                o.model = copyingMovement(o.model, bezierTime, path[0], path[1], path[2], path[3], path[4], path[5], 3, o.forward, o.pos, o.oldpos);
+            }
+            else
+            {
+                o.model = opponentMovement(bezierTime, track.opponentPaths[p], o.forward, o.pos);
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    for (int i = 0; i < count; i++)
+    {
+        checksum += opponents[i].model[3][0];
+    }
+    return seconds;
+}
+
+static double poolTicks(const RaceTrack &track, int count, int ticks, float &checksum)
+{
+    OpponentPool pool(track);
+    pool.addCrowd(count - pool.size());
+    std::vector<int> hits;
+    const float dt = 1.0f / SIM_TICK_RATE;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int tick = 1; tick <= ticks; tick++)
+    {
+        glm::vec4 player = glm::vec4(tick * dt * 20.0f, 0.0f, 0.0f, 1.0f);
+        pool.collide(player, playerHitboxRadius + opponentHitboxRadius, hits);
+        checksum += (float)hits.size();
+        pool.update(tick * dt);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    for (int i = 0; i < pool.size(); i++)
+    {
+        checksum += pool.model(i)[3][0];
+    }
+    return seconds;
+}
+
+// menor e maior velocidade, em m/s, de um tick ao outro enquanto o oponente
+// percorre a trajetoria. Nas quinas entre segmentos a distancia em linha reta
+// de um tick e um pouco menor que o arco percorrido
+static void speedRange(const RaceTrack &track, int p, bool legacy, float &minSpeed, float &maxSpeed)
+{
+    const float dt = 1.0f / SIM_TICK_RATE;
+    OpponentPool pool(track);
+    LegacyOpponent o;
+    o.oldpos = track.opponentStart[p];
+    o.model = glm::mat4(1.0f);
+    o.forward = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+    o.pos = track.opponentStart[p];
+    float duration = legacy ? track.opponentPaths[p].segments() * legacyTimeScale[p] : pool.pathLength(p) / pool.speed[p];
+    minSpeed = 1e30f;
+    maxSpeed = 0.0f;
+    glm::vec4 last = legacy ? o.oldpos : pool.position(p);
+    // o primeiro e o ultimo tick ficam de fora, la o oponente para
+    for (int tick = 1; tick * dt < duration - dt; tick++)
+    {
+        glm::vec4 now;
+        if (legacy)
+        {
+            opponentMovement(tick * dt / legacyTimeScale[p], track.opponentPaths[p], o.forward, o.pos);
+            now = o.pos;
+        }
+        else
+        {
+            pool.update(tick * dt);
+            now = pool.position(p);
+        }
+        if (tick > 1)
+        {
+            float speed = norm(now - last) / dt;
+            minSpeed = std::min(minSpeed, speed);
+            maxSpeed = std::max(maxSpeed, speed);
+        }
+        last = now;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int ticks = argc > 1 ? atoi(argv[1]) : 360;
+    const int counts[] = {2, 16, 128, 512, 2048};
+
+    RaceTrack track;
+    BuildDefaultTrack(track);
+
+    float checksum = 0.0f;
+    printf("%d ticks\n", ticks);
+    printf("%10s %16s %16s %16s %10s\n", "opponents", "legacy us/tick", "spline us/tick", "pool us/tick", "speedup");
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+    {
+        int n = counts[c];
+        double legacy = legacyTicks(track, n, ticks, true, checksum);
+        double spline = legacyTicks(track, n, ticks, false, checksum);
+        double pool = poolTicks(track, n, ticks, checksum);
+        printf("%10d %16.2f %16.2f %16.2f %9.1fx\n", n, legacy * 1e6 / ticks, spline * 1e6 / ticks, pool * 1e6 / ticks, legacy / pool);
+    }
+    printf("(checksum %g)\n\n", checksum);
+
+    printf("%10s %22s %22s\n", "path", "legacy m/s min-max", "pool m/s min-max");
+    for (int p = 0; p < NUM_OPPONENTS; p++)
+    {
+        float legacyMin, legacyMax, poolMin, poolMax;
+        speedRange(track, p, true, legacyMin, legacyMax);
+        speedRange(track, p, false, poolMin, poolMax);
+        printf("%10d %10.2f - %-9.2f %10.2f - %-9.2f\n", p, legacyMin, legacyMax, poolMin, poolMax);
+    }
+    return 0;
+}
@@ -0,0 +1,169 @@
+// Progresso na pista e classificacao de muitos carros por tick. Mede o ponto
+// mais proximo na linha central procurando na grade (locate) e perto da
+// resposta do tick anterior (follow), e a classificacao incremental
+// (RaceRanking: follow de cada carro e ordenacao por insercao) com os
+// oponentes do OpponentPool. Mostra tambem o erro contra a busca em todos os
+// pontos da linha central, as voltas contadas e quanto tempo um carro na
+// contramao leva para ser detectado.
+//
+//   ./bench_progress [ticks]
+//
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+
+#include "opponentpool.h"
+#include "racesim.h"
+
+// distancia ao longo da linha central do ponto mais proximo, testando
+// pontos a cada centimetro
+static float bruteForce(const std::vector<glm::vec4> &points, float spacing, float x, float z)
+{
+    float best = 1e30f;
+    int bestIndex = 0;
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        float dx = x - points[i].x, dz = z - points[i].z;
+        if (dx * dx + dz * dz < best)
+        {
+            best = dx * dx + dz * dz;
+            bestIndex = (int)i;
+        }
+    }
+    return bestIndex * spacing;
+}
+
+int main(int argc, char *argv[])
+{
+    int ticks = argc > 1 ? atoi(argv[1]) : 360;
+    const int counts[] = {2, 16, 128, 512, 2048};
+
+    RaceTrack track;
+    BuildDefaultTrack(track);
+    const TrackProgress &progress = track.progress;
+    const float length = progress.length();
+    printf("linha central: %.1f m\n", length);
+
+    // erro contra a busca em todos os pontos, a ate 6 m para cada lado. O
+    // maior fica nas emendas dos segmentos, onde a linha central faz uma
+    // quina que a poligonal arredonda
+    ArcLengthTable table;
+    table.build(track.centerline, 0.01f);
+    std::vector<glm::vec4> points((int)(length / 0.01f));
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        glm::vec4 tangent;
+        table.sample(i * 0.01f, points[i], tangent);
+    }
+    srand(7);
+    float locateError = 0.0f, followError = 0.0f;
+    double meanError = 0.0;
+    const int queries = 2000;
+    for (int i = 0; i < queries; i++)
+    {
+        float d = length * rand() / RAND_MAX;
+        float side = 12.0f * rand() / RAND_MAX - 6.0f;
+        glm::vec4 point, tangent;
+        table.sample(d, point, tangent);
+        float t = std::sqrt(tangent.x * tangent.x + tangent.z * tangent.z);
+        float x = point.x - side * tangent.z / t, z = point.z + side * tangent.x / t;
+        float exact = bruteForce(points, 0.01f, x, z);
+        // perto do inicio da volta as duas respostas podem estar nas pontas
+        float e = std::fabs(progress.locate(x, z) - exact);
+        locateError = std::max(locateError, std::min(e, length - e));
+        meanError += std::min(e, length - e) / queries;
+        e = std::fabs(progress.follow(x, z, std::fmod(exact + 2.0f, length)) - exact);
+        followError = std::max(followError, std::min(e, length - e));
+    }
+    printf("erro: medio %.3f m, maximo locate %.3f m, follow %.3f m\n\n", meanError, locateError, followError);
+
+    float checksum = 0.0f;
+    const float dt = 1.0f / SIM_TICK_RATE;
+    printf("%d ticks\n", ticks);
+    printf("%10s %14s %14s %14s %14s\n", "carros", "locate ns/car", "follow ns/car", "rank ns/car", "total ns/car");
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+    {
+        OpponentPool pool(track);
+        pool.addCrowd(counts[c] - pool.size());
+        const int n = pool.size();
+        RaceRanking ranking(progress);
+        ranking.reset(n);
+        for (int i = 0; i < n; i++)
+        {
+            ranking.place(i, pool.posX[i], pool.posZ[i]);
+        }
+        ranking.rank();
+        double locate = 0.0, follow = 0.0, rank = 0.0;
+        for (int tick = 1; tick <= ticks; tick++)
+        {
+            pool.update(tick * dt);
+            std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < n; i++)
+            {
+                checksum += progress.locate(pool.posX[i], pool.posZ[i]);
+            }
+            std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+            for (int i = 0; i < n; i++)
+            {
+                ranking.update(i, pool.posX[i], pool.posZ[i], pool.forwardX[i], pool.forwardZ[i], dt);
+            }
+            std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+            ranking.rank();
+            std::chrono::steady_clock::time_point t3 = std::chrono::steady_clock::now();
+            locate += std::chrono::duration<double>(t1 - t0).count();
+            follow += std::chrono::duration<double>(t2 - t1).count();
+            rank += std::chrono::duration<double>(t3 - t2).count();
+        }
+        checksum += ranking.progress(ranking.order()[0]);
+        double perCar = 1e9 / ((double)ticks * n);
+        printf("%10d %14.1f %14.1f %14.1f %14.1f\n", n, locate * perCar, follow * perCar, rank * perCar, (follow + rank) * perCar);
+    }
+    printf("(checksum %g)\n\n", checksum);
+
+    // os dois oponentes da pista por dois minutos: o mais rapido abre voltas
+    OpponentPool pool(track);
+    RaceRanking ranking(progress);
+    ranking.reset(pool.size());
+    for (int i = 0; i < pool.size(); i++)
+    {
+        ranking.place(i, pool.posX[i], pool.posZ[i]);
+    }
+    const int minutes = 2;
+    for (int tick = 1; tick <= minutes * 60 * (int)SIM_TICK_RATE; tick++)
+    {
+        pool.update(tick * dt);
+        for (int i = 0; i < pool.size(); i++)
+        {
+            ranking.update(i, pool.posX[i], pool.posZ[i], pool.forwardX[i], pool.forwardZ[i], dt);
+        }
+        ranking.rank();
+    }
+    for (int k = 0; k < pool.size(); k++)
+    {
+        int i = ranking.order()[k];
+        float expected = minutes * 60.0f * pool.speed[i] / pool.pathLength(pool.path[i]);
+        printf("%do lugar: oponente %d, %.3f voltas (%.3f pela trajetoria)\n", k + 1, i, ranking.progress(i), expected);
+    }
+
+    // um carro a 15 m/s de frente para o sentido contrario da pista
+    ranking.reset(1);
+    glm::vec4 point, tangent;
+    table.sample(100.0f, point, tangent);
+    ranking.place(0, point.x, point.z);
+    float detected = -1.0f;
+    for (int tick = 1; tick <= 5 * (int)SIM_TICK_RATE && detected < 0.0f; tick++)
+    {
+        table.sample(100.0f - 15.0f * tick * dt, point, tangent);
+        float t = std::sqrt(tangent.x * tangent.x + tangent.z * tangent.z);
+        ranking.update(0, point.x, point.z, -tangent.x / t, -tangent.z / t, dt);
+        if (ranking.wrongWay(0))
+        {
+            detected = tick * dt;
+        }
+    }
+    printf("contramao detectada em %.2f s\n", detected);
+    return 0;
+}
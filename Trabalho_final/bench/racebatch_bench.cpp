@@ -0,0 +1,56 @@
+// Vazao do RaceBatch: passos de corrida por segundo para lotes de 1, 64, 1024
+// e 16384 corridas independentes.
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "racebatch.h"
+
+int main()
+{
+    const int sizes[] = {1, 64, 1024, 16384};
+    const float dt = 1.0f / SIM_TICK_RATE;
+    const long long stepsPerSize = 1000000; // passos de corrida medidos em cada tamanho
+
+    RaceTrack track;
+    BuildDefaultTrack(track);
+
+    printf("%8s %14s %14s %10s\n", "races", "race-steps", "race-steps/s", "ns/step");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        int n = sizes[s];
+        RaceBatch batch(track, n);
+        std::vector<RaceInputs> inputs(n);
+        std::mt19937 rng(1234);
+
+        long long raceSteps = 0;
+        double seconds = 0.0;
+        while (raceSteps < stepsPerSize)
+        {
+            batch.startAll();
+            // corridas curtas, recomeçadas, para medir carros em movimento
+            for (int tick = 0; tick < 300 && batch.running() > 0; tick++)
+            {
+                for (int r = 0; r < n; r++)
+                {
+                    unsigned int bits = rng();
+                    inputs[r].forward = (bits & 7) != 0;
+                    inputs[r].back = (bits & 0x38) == 0;
+                    inputs[r].left = (bits & 0xc0) == 0;
+                    inputs[r].right = (bits & 0x300) == 0;
+                    inputs[r].boost = (bits & 0x3c00) == 0;
+                    inputs[r].strafeLeft = (bits & 0xc000) == 0;
+                    inputs[r].strafeRight = (bits & 0x30000) == 0;
+                }
+                int active = batch.running();
+                std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+                batch.step(&inputs[0], dt);
+                seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+                raceSteps += active;
+            }
+        }
+        printf("%8d %14lld %14.0f %10.1f\n", n, raceSteps, raceSteps / seconds, seconds * 1e9 / raceSteps);
+    }
+    return 0;
+}
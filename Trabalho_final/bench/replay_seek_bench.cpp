@@ -0,0 +1,148 @@
+// Tempo de busca (seek) em replays: com keyframes a cada K ticks contra
+// simular desde o inicio, e verificacao de que o estado depois da busca e
+// identico ao obtido reproduzindo o replay em sequencia.
+//
+//   ./bench_replay_seek [segundos de corrida] [buscas]
+//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "replay.h"
+
+static const char *withKeyframes = "bench_seek_keyframes.fzr";
+static const char *withoutKeyframes = "bench_seek_plain.fzr";
+
+// vai e volta perto da largada, virando de vez em quando, para nao bater
+// nas paredes e a corrida durar o tempo pedido
+static int recordReplay(const RaceTrack &track, float seconds)
+{
+    ReplayWriter keyframed;
+    ReplayWriter plain;
+    if (!keyframed.open(withKeyframes, SIM_TICK_RATE) || !plain.open(withoutKeyframes, SIM_TICK_RATE, ReplaySetup(), 0))
+    {
+        return 0;
+    }
+    RaceSim sim(track);
+    sim.start();
+    std::mt19937 rng(3);
+    RaceInputs inputs;
+    const float dt = 1.0f / SIM_TICK_RATE;
+    while (sim.state.raceStart && sim.state.time < seconds)
+    {
+        int phase = keyframed.ticks() % 120;
+        inputs.forward = phase < 40;
+        inputs.back = phase >= 60 && phase < 100;
+        if (phase == 0)
+        {
+            unsigned int turn = rng() % 3;
+            inputs.left = turn == 1;
+            inputs.right = turn == 2;
+        }
+        keyframed.record(inputs, sim);
+        plain.record(inputs, sim);
+        sim.step(inputs, dt);
+    }
+    int ticks = keyframed.ticks();
+    keyframed.close();
+    plain.close();
+    return ticks;
+}
+
+static double seekAll(const RaceTrack &track, const char *filename, const std::vector<int> &targets,
+                      const std::vector<RaceState> &expected, int &mismatches)
+{
+    ReplayReader reader;
+    if (!reader.open(filename))
+    {
+        exit(EXIT_FAILURE);
+    }
+    RaceSim sim(track);
+    mismatches = 0;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+        if (!reader.seek(targets[i], sim) || memcmp(&sim.state, &expected[i], sizeof(RaceState)) != 0)
+        {
+            mismatches++;
+        }
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+int main(int argc, char *argv[])
+{
+    float seconds = argc > 1 ? (float)atof(argv[1]) : 300.0f;
+    int seeks = argc > 2 ? atoi(argv[2]) : 8;
+
+    RaceTrack track;
+    BuildDefaultTrack(track);
+
+    int ticks = recordReplay(track, seconds);
+    if (ticks == 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // ticks sorteados, fora de ordem como num scrubbing de verdade
+    std::mt19937 rng(11);
+    std::vector<int> targets(seeks);
+    for (int i = 0; i < seeks; i++)
+    {
+        targets[i] = (int)(rng() % ticks);
+    }
+
+    // estado de referencia em cada tick sorteado, reproduzindo em sequencia
+    std::vector<int> order(targets);
+    std::sort(order.begin(), order.end());
+    std::vector<RaceState> sorted(seeks);
+    {
+        ReplayReader reader;
+        reader.open(withoutKeyframes);
+        RaceSim sim(track);
+        sim.start();
+        RaceInputs inputs;
+        const float dt = 1.0f / reader.tickRate();
+        for (int i = 0; i < seeks; i++)
+        {
+            while (reader.tick() < order[i] && reader.next(inputs))
+            {
+                sim.step(inputs, dt);
+            }
+            memcpy(&sorted[i], &sim.state, sizeof(RaceState));
+        }
+    }
+    std::vector<RaceState> expected(seeks);
+    for (int i = 0; i < seeks; i++)
+    {
+        size_t at = std::lower_bound(order.begin(), order.end(), targets[i]) - order.begin();
+        memcpy(&expected[i], &sorted[at], sizeof(RaceState));
+    }
+
+    int keyframedMismatches;
+    int plainMismatches;
+    double keyframed = seekAll(track, withKeyframes, targets, expected, keyframedMismatches);
+    double plain = seekAll(track, withoutKeyframes, targets, expected, plainMismatches);
+
+    FILE *file = fopen(withKeyframes, "rb");
+    fseek(file, 0, SEEK_END);
+    long keyframedSize = ftell(file);
+    fclose(file);
+    file = fopen(withoutKeyframes, "rb");
+    fseek(file, 0, SEEK_END);
+    long plainSize = ftell(file);
+    fclose(file);
+    remove(withKeyframes);
+    remove(withoutKeyframes);
+
+    printf("replay: %d ticks (%.1f s), keyframe every %d ticks\n", ticks, ticks / SIM_TICK_RATE, REPLAY_KEYFRAME_INTERVAL);
+    printf("%-18s %10s %14s %10s\n", "", "bytes", "ms/seek", "mismatch");
+    printf("%-18s %10ld %14.3f %10d\n", "keyframes", keyframedSize, keyframed * 1000.0 / seeks, keyframedMismatches);
+    printf("%-18s %10ld %14.3f %10d\n", "from start", plainSize, plain * 1000.0 / seeks, plainMismatches);
+    printf("speedup %.1fx\n", plain / keyframed);
+    return keyframedMismatches == 0 && plainMismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,59 @@
+// Escalabilidade do executor de corridas: mesmo conjunto de corridas com 1, 2,
+// 4, ... threads ate o numero de nucleos, com speedup e eficiencia.
+//
+//   ./bench_rollout [corridas] [max threads]
+//
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "rollout.h"
+
+int main(int argc, char *argv[])
+{
+    int races = argc > 1 ? atoi(argv[1]) : 64;
+    int maxThreads = argc > 2 ? atoi(argv[2]) : (int)std::thread::hardware_concurrency();
+    if (maxThreads <= 0)
+    {
+        maxThreads = 1;
+    }
+
+    RaceTrack track;
+    BuildDefaultTrack(track);
+
+    // corridas de tamanhos bem diferentes: as sementes geram pilotos que batem
+    // cedo e perdem o boost ou que ficam rodando ate o limite de tempo
+    std::vector<RolloutSpec> specs(races);
+    for (int i = 0; i < races; i++)
+    {
+        specs[i].seed = 1 + i;
+        specs[i].script = NULL;
+    }
+
+    std::vector<int> counts;
+    for (int t = 1; t < maxThreads; t *= 2)
+    {
+        counts.push_back(t);
+    }
+    counts.push_back(maxThreads);
+
+    printf("%8s %10s %10s %10s %10s\n", "threads", "seconds", "speedup", "efficiency", "steals");
+    double baseline = 0.0;
+    for (size_t c = 0; c < counts.size(); c++)
+    {
+        WorkStealingPool pool(counts[c]);
+        std::vector<RolloutResult> results;
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        runRollouts(track, specs, results, pool, 1.0f / SIM_TICK_RATE, 60.0f);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        if (c == 0)
+        {
+            baseline = seconds;
+        }
+        double speedup = baseline / seconds;
+        printf("%8d %10.3f %10.2f %9.0f%% %10lld\n", counts[c], seconds, speedup, 100.0 * speedup / counts[c], pool.steals());
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+// Custo de salvar e restaurar o estado completo de uma corrida, e verificacao
+// de que restaurar e simular de novo reproduz exatamente o mesmo estado.
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <random>
+
+#include "rollout.h"
+
+int main()
+{
+    RaceTrack track;
+    BuildDefaultTrack(track);
+    RaceSim sim(track);
+    sim.start();
+    const float dt = 1.0f / SIM_TICK_RATE;
+
+    std::mt19937 rng(7);
+    for (int i = 0; i < 300; i++)
+    {
+        sim.step(seededInputs(rng, sim.state), dt);
+    }
+
+    // rollback: salva, simula, restaura e simula de novo com as mesmas entradas
+    RaceSnapshot snapshot;
+    sim.save(snapshot);
+    std::mt19937 replayRng = rng;
+    for (int i = 0; i < 600; i++)
+    {
+        sim.step(seededInputs(rng, sim.state), dt);
+    }
+    RaceState first;
+    std::memcpy(&first, &sim.state, sizeof(RaceState));
+    if (!sim.restore(snapshot))
+    {
+        printf("restore failed\n");
+        return 1;
+    }
+    for (int i = 0; i < 600; i++)
+    {
+        sim.step(seededInputs(replayRng, sim.state), dt);
+    }
+    bool identical = std::memcmp(&first, &sim.state, sizeof(RaceState)) == 0;
+    printf("snapshot size %u bytes, rollback reproduces the race: %s\n", (unsigned int)sizeof(RaceSnapshot), identical ? "yes" : "NO");
+
+    const int iterations = 10000000;
+    RaceSnapshot slots[2];
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        sim.save(slots[i & 1]);
+    }
+    double saveSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        sim.restore(slots[i & 1]);
+    }
+    double restoreSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    // restaurar nao move os oponentes, o custo nao depende de quantos sao
+    RaceSim crowd(track);
+    crowd.opponents.addCrowd(1000);
+    crowd.start();
+    crowd.save(slots[0]);
+    crowd.save(slots[1]);
+    begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        crowd.restore(slots[i & 1]);
+    }
+    double crowdSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    begin = std::chrono::steady_clock::now();
+    crowd.syncOpponents();
+    double syncSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    printf("save    %.1f ns\n", saveSeconds * 1e9 / iterations);
+    printf("restore %.1f ns\n", restoreSeconds * 1e9 / iterations);
+    printf("restore %.1f ns with %d opponents, moving them at the next step %.1f us\n", crowdSeconds * 1e9 / iterations,
+           crowd.opponents.size(), syncSeconds * 1e6);
+    return identical ? 0 : 1;
+}
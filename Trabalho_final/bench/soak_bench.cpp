@@ -0,0 +1,347 @@
+// Uma hora (ou mais) de voltas dos dois oponentes da pista, a 120 ticks por
+// segundo, com o relogio do RaceSim (raceClock: o tempo derivado do numero do
+// tick). Compara a matriz acumulada tick a tick, como o opponentMovement()
+// antigo fazia (translacao, rotacao pelo acos, translacao), com a matriz
+// montada do zero a cada tick a partir do ponto e da tangente da spline
+// (opponentMovement() atual e OpponentPool). A referencia e calculada a
+// parte, em double: o tempo exato do tick, a curva pelos pontos de controle
+// e, para o OpponentPool, o comprimento de arco integrado e invertido por
+// Newton, sem BezierPolynomial nem ArcLengthTable. A cada 10 minutos mostra
+// o maior erro de cada uma: da posicao, em metros, e da base (as tres
+// primeiras colunas), relativo a escala do modelo, e quanto o raceClock e um
+// relogio somado tick a tick em float (o do RaceSim antes) se afastam do
+// tempo exato. No fim, o tempo e as operacoes de ponto flutuante por
+// atualizacao.
+//
+// As matrizes montadas do zero (opponentMovement e OpponentPool) so se
+// afastam da referencia pela precisao do tempo em float, que cai devagar com
+// as horas; se passarem de maxPositionError ou maxBasisError por hora de
+// corrida o programa termina com 1. A acumulada nao e verificada: e ela que
+// mostra a deriva.
+//
+//   ./bench_soak [horas]
+//
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+
+#include "matrices.h"
+#include "opponent.h"
+#include "opponentpool.h"
+#include "racesim.h"
+
+// erros aceitos nas matrizes montadas do zero, por hora de corrida: 5 cm e
+// 1% da escala do modelo (com uma hora ficam em 3.3 cm e 0.35%)
+static const double maxPositionError = 0.05;
+static const double maxBasisError = 0.01;
+
+// segundos por segmento de bezier do codigo antigo
+static const float legacyTimeScale[NUM_OPPONENTS] = {5.0f, 8.0f};
+
+// operacoes de ponto flutuante por atualizacao, contadas a mao:
+//  acumulada: ponto na spline (Horner, 24), newPoint (4), duas normalize
+//   (2 x 12 e um sqrt cada), dotproduct (7), crossproduct (9), tres produtos
+//   de mat4 (3 x 112) e mais um na translacao final (112), pos (28) e ainda
+//   acos, sin e cos
+//  opponentMovement: segmento (4), ponto (24), tangente (28), comprimento no
+//   plano XZ (3 e um sqrt), forward (2 divisoes), base (4)
+//  OpponentPool: distancia e volta (5), tabela de comprimento de arco (10),
+//   ponto e tangente (52), forward (3, um sqrt, 2 divisoes), faixa (4), base (4)
+static const char *flops[3] = {"544 + 2 sqrt + acos/sin/cos", "65 + sqrt", "80 + sqrt"};
+
+// o opponentMovement() de antes, ja sobre a BezierSpline: a matriz do tick
+// anterior girada e transladada pelo passo da curva
+static glm::mat4 accumulatingMovement(glm::mat4 model, float bezierTime, const BezierSpline &path, glm::vec4 &forward, glm::vec4 &pos, glm::vec4 &oldpos)
+{
+    glm::vec4 BezierPoint = path.point(bezierTime);
+    glm::vec4 newPoint = BezierPoint - oldpos;
+    float dotprod = std::min(std::max(dotproduct(normalize(newPoint), forward), -1.0f), 1.0f);
+    float angle = acos(dotprod);
+    if (crossproduct(newPoint, forward).y < 0)
+    {
+        angle = -1 * angle;
+    }
+    forward = normalize(newPoint);
+    model = Matrix_Translate(pos.x, pos.y, pos.z) * Matrix_Rotate_Y(-angle) * Matrix_Translate(-pos.x, -pos.y, -pos.z) * model;
+    model = Matrix_Translate(newPoint.x, newPoint.y, newPoint.z) * model;
+    pos = Matrix_Translate(newPoint.x, newPoint.y, newPoint.z) * pos;
+    oldpos = BezierPoint;
+    return model;
+}
+
+// ponto e derivada de um segmento em double, pela forma de Bernstein
+static void exactCurve(const BezierSpline &path, int segment, double t, double p[3], double d[3])
+{
+    const glm::vec4 *c = path.controlPoints(segment);
+    double u = 1.0 - t;
+    double b[4] = {u * u * u, 3.0 * u * u * t, 3.0 * u * t * t, t * t * t};
+    double db[3] = {3.0 * u * u, 6.0 * u * t, 3.0 * t * t};
+    for (int k = 0; k < 3; k++)
+    {
+        p[k] = b[0] * c[0][k] + b[1] * c[1][k] + b[2] * c[2][k] + b[3] * c[3][k];
+        d[k] = db[0] * (c[1][k] - c[0][k]) + db[1] * (c[2][k] - c[1][k]) + db[2] * (c[3][k] - c[2][k]);
+    }
+}
+
+// o mesmo no tempo de bezier u, com a convencao da BezierSpline (u = 1 e o
+// fim do segmento 0, u da a volta, as trajetorias sao fechadas). Devolve o
+// segmento e t nele
+static int exactPoint(const BezierSpline &path, double u, double &t, double p[3], double d[3])
+{
+    int n = path.segments();
+    u -= std::floor(u / n) * n;
+    int s = std::min(std::max((int)std::ceil(u) - 1, 0), n - 1);
+    t = u - s;
+    exactCurve(path, s, t, p, d);
+    return s;
+}
+
+static double exactSpeed(const BezierSpline &path, int segment, double t)
+{
+    double p[3], d[3];
+    exactCurve(path, segment, t, p, d);
+    return std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+}
+
+// comprimento de arco de t0 a t1 num segmento, Gauss-Legendre de 5 pontos
+static double exactLength(const BezierSpline &path, int segment, double t0, double t1)
+{
+    static const double x[5] = {0.0, -0.5384693101056831, 0.5384693101056831, -0.9061798459386640, 0.9061798459386640};
+    static const double w[5] = {0.5688888888888889, 0.4786286704993665, 0.4786286704993665, 0.2369268850561891, 0.2369268850561891};
+    double half = 0.5 * (t1 - t0), middle = 0.5 * (t0 + t1), sum = 0.0;
+    for (int i = 0; i < 5; i++)
+    {
+        sum += w[i] * exactSpeed(path, segment, middle + half * x[i]);
+    }
+    return sum * half;
+}
+
+// comprimento de arco acumulado em nos de 1/1024 de segmento, e a inversao
+// por Newton entre eles
+struct ExactArcLength
+{
+    static const int steps = 1024;
+    const BezierSpline *path;
+    std::vector<double> nodes; // comprimento do inicio ate cada no
+
+    void build(const BezierSpline &spline)
+    {
+        path = &spline;
+        nodes.assign(1, 0.0);
+        for (int s = 0; s < spline.segments(); s++)
+        {
+            for (int i = 0; i < steps; i++)
+            {
+                nodes.push_back(nodes.back() + exactLength(spline, s, (double)i / steps, (double)(i + 1) / steps));
+            }
+        }
+    }
+    double length() const { return nodes.back(); }
+
+    // segmento e t na distancia, ja dentro de [0, length()]
+    int parameter(double distance, double &t) const
+    {
+        int k = (int)(std::upper_bound(nodes.begin(), nodes.end(), distance) - nodes.begin()) - 1;
+        k = std::min(std::max(k, 0), (int)nodes.size() - 2);
+        int s = k / steps;
+        double t0 = (double)(k % steps) / steps;
+        t = t0 + (distance - nodes[k]) / exactSpeed(*path, s, t0);
+        for (int i = 0; i < 4; i++)
+        {
+            t -= (nodes[k] + exactLength(*path, s, t0, t) - distance) / exactSpeed(*path, s, t);
+        }
+        return s;
+    }
+};
+
+// distancia da posicao, em metros
+static double positionError(const glm::mat4 &model, const double p[3])
+{
+    double dx = model[3][0] - p[0], dy = model[3][1] - p[1], dz = model[3][2] - p[2];
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+// maior diferenca da base, relativa a escala, contra o modelo virado para
+// (fx, fz) no plano XZ
+static double basisError(const glm::mat4 &model, double fx, double fz)
+{
+    double length = std::sqrt(fx * fx + fz * fz);
+    fx /= length;
+    fz /= length;
+    const double exact[3][3] = {{fz, 0.0, -fx}, {0.0, 1.0, 0.0}, {fx, 0.0, fz}};
+    double basis = 0.0;
+    for (int c = 0; c < 3; c++)
+    {
+        for (int r = 0; r < 3; r++)
+        {
+            basis = std::max(basis, std::fabs(model[c][r] / opponentScale - exact[c][r]));
+        }
+    }
+    return basis;
+}
+
+// erro da base contra a tangente d do segmento s em t. As splines tem quinas
+// entre os segmentos: a menos de 5 cm da juncao o modelo pode estar do outro
+// lado pelo arredondamento do tempo, e vale a direcao mais proxima
+static double cornerBasisError(const glm::mat4 &model, const BezierSpline &path, int s, double t, const double d[3])
+{
+    const double corner = 0.05;
+    double speed = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    double error = basisError(model, d[0], d[2]);
+    int n = path.segments();
+    double p[3], other[3];
+    if (t * speed < corner)
+    {
+        exactCurve(path, (s + n - 1) % n, 1.0, p, other);
+        error = std::min(error, basisError(model, other[0], other[2]));
+    }
+    else if ((1.0 - t) * speed < corner)
+    {
+        exactCurve(path, (s + 1) % n, 0.0, p, other);
+        error = std::min(error, basisError(model, other[0], other[2]));
+    }
+    return error;
+}
+
+int main(int argc, char *argv[])
+{
+    float hours = argc > 1 ? (float)atof(argv[1]) : 1.0f;
+    const unsigned int ticks = (unsigned int)(hours * 3600.0f * SIM_TICK_RATE);
+    const unsigned int checkpoint = 600 * (unsigned int)SIM_TICK_RATE;
+    // o passo que o jogo passa ao RaceSim
+    const float dt = 1.0f / SIM_TICK_RATE;
+
+    RaceTrack track;
+    BuildDefaultTrack(track);
+    OpponentPool pool(track);
+    ExactArcLength arcs[NUM_OPPONENTS];
+
+    glm::mat4 accumulated[NUM_OPPONENTS];
+    glm::vec4 forward[NUM_OPPONENTS], pos[NUM_OPPONENTS], oldpos[NUM_OPPONENTS];
+    glm::vec4 rebuiltForward[NUM_OPPONENTS], rebuiltPos[NUM_OPPONENTS];
+    double previous[NUM_OPPONENTS][3]; // ponto exato do tick anterior
+    for (int p = 0; p < NUM_OPPONENTS; p++)
+    {
+        arcs[p].build(track.opponentPaths[p]);
+        pos[p] = oldpos[p] = rebuiltPos[p] = track.opponentPaths[p].point(0.0f);
+        forward[p] = rebuiltForward[p] = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+        accumulated[p] = Matrix_Translate(pos[p].x, pos[p].y, pos[p].z) * Matrix_Rotate_Y(3.14159265f / 2) * Matrix_Scale(opponentScale, opponentScale, opponentScale);
+        double t, d[3];
+        exactPoint(track.opponentPaths[p], 0.0, t, previous[p], d);
+    }
+
+    printf("%.2f h, %u ticks, %d oponentes\n", hours, ticks, NUM_OPPONENTS);
+    printf("%8s %22s %22s %22s %22s\n", "", "relogio (s)", "acumulada", "opponentMovement", "OpponentPool");
+    printf("%8s %11s %10s %11s %10s %11s %10s %11s %10s\n", "minutos", "raceClock", "somado", "pos (m)", "base", "pos (m)", "base", "pos (m)", "base");
+    double error[3][2] = {{0.0, 0.0}, {0.0, 0.0}, {0.0, 0.0}};
+    double clockError = 0.0, summedError = 0.0;
+    float summed = 0.0f;
+    for (unsigned int tick = 1; tick <= ticks; tick++)
+    {
+        // cada metodo recebe o tempo do RaceSim; a referencia usa o exato
+        float time = raceClock(tick, dt);
+        double seconds = tick / (double)SIM_TICK_RATE;
+        summed += dt;
+        clockError = std::max(clockError, std::fabs(time - seconds));
+        summedError = std::max(summedError, std::fabs(summed - seconds));
+
+        pool.update(time);
+        for (int p = 0; p < NUM_OPPONENTS; p++)
+        {
+            const BezierSpline &path = track.opponentPaths[p];
+            float bezierTime = time / legacyTimeScale[p];
+            double point[3], tangent[3], t;
+            int segment = exactPoint(path, seconds / legacyTimeScale[p], t, point, tangent);
+
+            // o metodo antigo: no ponto da curva, virado para a corda do
+            // ultimo tick
+            accumulated[p] = accumulatingMovement(accumulated[p], bezierTime, path, forward[p], pos[p], oldpos[p]);
+            error[0][0] = std::max(error[0][0], positionError(accumulated[p], point));
+            error[0][1] = std::max(error[0][1], basisError(accumulated[p], point[0] - previous[p][0], point[2] - previous[p][2]));
+            for (int k = 0; k < 3; k++)
+            {
+                previous[p][k] = point[k];
+            }
+
+            // o atual: no ponto da curva, virado para a tangente
+            glm::mat4 rebuilt = opponentMovement(bezierTime, path, rebuiltForward[p], rebuiltPos[p]);
+            error[1][0] = std::max(error[1][0], positionError(rebuilt, point));
+            error[1][1] = std::max(error[1][1], cornerBasisError(rebuilt, path, segment, t, tangent));
+
+            // o do OpponentPool: na distancia percorrida, deslocado para a faixa
+            double distance = std::max(seconds + pool.timeOffset[p], 0.0) * pool.speed[p];
+            distance -= std::floor(distance / arcs[p].length()) * arcs[p].length();
+            segment = arcs[p].parameter(distance, t);
+            exactCurve(path, segment, t, point, tangent);
+            double length = std::sqrt(tangent[0] * tangent[0] + tangent[2] * tangent[2]);
+            point[0] -= pool.lane[p] * tangent[2] / length;
+            point[2] += pool.lane[p] * tangent[0] / length;
+            error[2][0] = std::max(error[2][0], positionError(pool.model(p), point));
+            error[2][1] = std::max(error[2][1], cornerBasisError(pool.model(p), path, segment, t, tangent));
+        }
+        if (tick % checkpoint == 0 || tick == ticks)
+        {
+            printf("%8.0f %11.2e %10.2e %11.2e %10.2e %11.2e %10.2e %11.2e %10.2e\n", seconds / 60.0, clockError, summedError, error[0][0], error[0][1],
+                   error[1][0], error[1][1], error[2][0], error[2][1]);
+        }
+    }
+
+    // limites proporcionais a duracao, no minimo o de uma hora
+    const double scale = std::max((double)hours, 1.0);
+    const char *checked[3] = {"acumulada", "opponentMovement", "OpponentPool"};
+    bool failed = false;
+    for (int method = 1; method < 3; method++)
+    {
+        if (error[method][0] > maxPositionError * scale || error[method][1] > maxBasisError * scale)
+        {
+            printf("%s: erro acima do limite (pos %.2e m, base %.2e)\n", checked[method], maxPositionError * scale, maxBasisError * scale);
+            failed = true;
+        }
+    }
+    if (!failed)
+    {
+        printf("matrizes montadas do zero dentro do limite (pos %.2e m, base %.2e)\n", maxPositionError * scale, maxBasisError * scale);
+    }
+
+    // tempo por atualizacao de um oponente, numa volta, sem as verificacoes
+    const int timed = 60 * SIM_TICK_RATE;
+    double nanoseconds[3];
+    float checksum = 0.0f;
+    for (int method = 0; method < 3; method++)
+    {
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        for (int tick = 1; tick <= timed; tick++)
+        {
+            float seconds = raceClock(tick, dt);
+            if (method == 2)
+            {
+                pool.update(seconds);
+                continue;
+            }
+            for (int p = 0; p < NUM_OPPONENTS; p++)
+            {
+                float bezierTime = seconds / legacyTimeScale[p];
+                if (method == 0)
+                {
+                    accumulated[p] = accumulatingMovement(accumulated[p], bezierTime, track.opponentPaths[p], forward[p], pos[p], oldpos[p]);
+                }
+                else
+                {
+                    accumulated[p] = opponentMovement(bezierTime, track.opponentPaths[p], rebuiltForward[p], rebuiltPos[p]);
+                }
+            }
+        }
+        nanoseconds[method] = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count() * 1e9 / ((double)timed * NUM_OPPONENTS);
+        checksum += accumulated[0][3][0] + pool.model(0)[3][0];
+    }
+    printf("\n%18s %14s %30s\n", "", "ns/atualizacao", "flops/atualizacao");
+    for (int method = 0; method < 3; method++)
+    {
+        printf("%18s %14.1f %30s\n", checked[method], nanoseconds[method], flops[method]);
+    }
+    printf("(checksum %g)\n", checksum);
+    return failed ? 1 : 0;
+}
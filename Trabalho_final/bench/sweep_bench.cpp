@@ -0,0 +1,121 @@
+// Colisao continua: carros com passos de 0.5 a 6 m (boost com tickrate
+// baixo) perto das paredes e curvas da pista do jogo. Compara o teste so na
+// posicao final (o que o passo fazia antes) e a varredura do CollisionWorld
+// com a referencia de amostrar o caminho a cada centimetro, e mede o custo.
+//
+//   ./bench_sweep [consultas]
+//
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "bezier.h"
+#include "racesim.h"
+
+static bbox playerBox(const glm::vec4 &center)
+{
+    bbox b;
+    b.minPoint = glm::vec4(center.x - playerHalfExtent, center.y - playerHalfExtent, center.z - playerHalfExtent, 1.0f);
+    b.maxPoint = glm::vec4(center.x + playerHalfExtent, center.y + playerHalfExtent, center.z + playerHalfExtent, 1.0f);
+    b.normal = glm::vec4(0.0f);
+    return b;
+}
+
+static bool touches(const RaceTrack &track, const glm::vec4 &center)
+{
+    CurveHit hit;
+    return track.world.wallNormal(playerBox(center)) != glm::vec4(0.0f) ||
+           track.world.curveContact(center, playerHitboxRadius, hit);
+}
+
+struct Move
+{
+    glm::vec4 start;
+    glm::vec4 motion;
+};
+
+int main(int argc, char *argv[])
+{
+    int count = argc > 1 ? atoi(argv[1]) : 20000;
+    std::mt19937 rng(13);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    RaceTrack track;
+    BuildDefaultTrack(track);
+
+    // partidas livres perto de uma parede reta ou de uma curva
+    std::vector<Move> moves;
+    while ((int)moves.size() < count)
+    {
+        glm::vec4 anchor;
+        if (rng() % 2)
+        {
+            const bbox &wall = track.straightsBBoxes[rng() % track.straightsBBoxes.size()];
+            anchor = glm::vec4(wall.minPoint.x + (wall.maxPoint.x - wall.minPoint.x) * unit(rng), 0.0f,
+                               wall.minPoint.z + (wall.maxPoint.z - wall.minPoint.z) * unit(rng), 1.0f);
+        }
+        else
+        {
+            anchor = Bezier(track.curveList[rng() % track.curveList.size()], 3, unit(rng));
+        }
+        float a = 6.2831853f * unit(rng);
+        float r = 1.0f + 3.0f * unit(rng);
+        Move move;
+        move.start = anchor + glm::vec4(r * std::cos(a), 0.0f, r * std::sin(a), 0.0f);
+        if (touches(track, move.start))
+        {
+            continue;
+        }
+        // em direcao a ancora, passando por ela
+        float length = 0.5f + 5.5f * unit(rng);
+        glm::vec4 towards = anchor - move.start;
+        move.motion = towards / std::sqrt(towards.x * towards.x + towards.z * towards.z) * length;
+        moves.push_back(move);
+    }
+
+    // referencia: o caminho amostrado a cada centimetro
+    std::vector<unsigned char> reference(count);
+    for (int i = 0; i < count; i++)
+    {
+        float length = std::sqrt(moves[i].motion.x * moves[i].motion.x + moves[i].motion.z * moves[i].motion.z);
+        int samples = (int)(length / 0.01f) + 1;
+        for (int j = 1; j <= samples && !reference[i]; j++)
+        {
+            reference[i] = touches(track, moves[i].start + moves[i].motion * ((float)j / samples));
+        }
+    }
+
+    std::vector<unsigned char> discrete(count), swept(count);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+    {
+        discrete[i] = touches(track, moves[i].start + moves[i].motion);
+    }
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    float sink = 0;
+    for (int i = 0; i < count; i++)
+    {
+        float fraction = track.world.sweepFraction(moves[i].start, playerHalfExtent, playerHitboxRadius, moves[i].motion);
+        swept[i] = fraction < 1.0f || touches(track, moves[i].start + moves[i].motion);
+        sink += fraction;
+    }
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+    int hits = 0, discreteMissed = 0, sweptMissed = 0, sweptExtra = 0;
+    for (int i = 0; i < count; i++)
+    {
+        hits += reference[i];
+        discreteMissed += reference[i] && !discrete[i];
+        sweptMissed += reference[i] && !swept[i];
+        sweptExtra += !reference[i] && swept[i];
+    }
+    printf("%d movimentos, %d encostam em parede ou curva no caminho\n\n", count, hits);
+    printf("%-14s %10s %10s %10s\n", "", "ns/move", "missed", "extra");
+    printf("%-14s %10.1f %10d %10s\n", "end position", std::chrono::duration<double>(t1 - t0).count() * 1e9 / count, discreteMissed, "-");
+    printf("%-14s %10.1f %10d %10d\n", "sweep", std::chrono::duration<double>(t2 - t1).count() * 1e9 / count, sweptMissed, sweptExtra);
+    printf("(%g)\n", sink);
+    return 0;
+}
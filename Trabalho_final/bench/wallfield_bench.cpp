@@ -0,0 +1,125 @@
+// Campo de distancia das paredes: tempo de gerar o campo a partir de
+// data/Track.obj e de abrir o cache mapeado em memoria, custo por carro da
+// consulta (caixas + curvas contra uma leitura bilinear) e corridas em lote
+// com 10000 carros com cada tipo de parede.
+//
+//   ./bench_wallfield [Track.obj] [cache]
+//
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "racebatch.h"
+
+static double seconds(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b)
+{
+    return std::chrono::duration<double>(b - a).count();
+}
+
+static double batchSteps(const RaceTrack &track, int cars, int steps)
+{
+    RaceBatch batch(track, cars);
+    std::vector<RaceInputs> inputs(cars);
+    std::mt19937 rng(3);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int s = 0; s < steps; s++)
+    {
+        for (int i = 0; i < cars; i++)
+        {
+            unsigned int bits = rng();
+            inputs[i] = RaceInputs();
+            inputs[i].forward = (bits & 3) != 0;
+            inputs[i].left = (bits & 0x1c) == 0;
+            inputs[i].right = (bits & 0xe0) == 0;
+            inputs[i].boost = (bits & 0x3f00) == 0;
+        }
+        batch.step(&inputs[0], 1.0f / SIM_TICK_RATE);
+    }
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    return (double)cars * steps / seconds(t0, t1);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *meshFile = argc > 1 ? argv[1] : "data/Track.obj";
+    const char *cacheFile = argc > 2 ? argv[2] : "bin/wallfield_bench.sdf";
+    remove(cacheFile);
+
+    RaceTrack boxes;
+    BuildDefaultTrack(boxes);
+
+    RaceTrack field;
+    BuildDefaultTrack(field);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    if (!LoadWallField(field, meshFile, cacheFile))
+    {
+        return 1;
+    }
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    field.world.wallField().close();
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+    if (!LoadWallField(field, meshFile, cacheFile))
+    {
+        return 1;
+    }
+    std::chrono::steady_clock::time_point t3 = std::chrono::steady_clock::now();
+    const WallField &walls = field.world.wallField();
+    printf("campo %d x %d, celula %g m\n", walls.cellsX(), walls.cellsZ(), walls.cellSize());
+    printf("gerar e salvar %.0f ms, abrir o cache %.2f ms\n\n", seconds(t0, t1) * 1e3, seconds(t2, t3) * 1e3);
+
+    // carros espalhados pela pista
+    const int count = 200000;
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<glm::vec4> centers(count);
+    for (int i = 0; i < count; i++)
+    {
+        centers[i] = glm::vec4(-60.0f + 200.0f * unit(rng), 0.0f, -10.0f + 130.0f * unit(rng), 1.0f);
+    }
+
+    int legacyCount = count / 100;
+    int legacyHits = 0, worldHits = 0, fieldHits = 0;
+    std::chrono::steady_clock::time_point t4 = std::chrono::steady_clock::now();
+    for (int i = 0; i < legacyCount; i++)
+    {
+        bbox box;
+        box.minPoint = centers[i] - glm::vec4(playerHalfExtent, playerHalfExtent, playerHalfExtent, 0.0f);
+        box.maxPoint = centers[i] + glm::vec4(playerHalfExtent, playerHalfExtent, playerHalfExtent, 0.0f);
+        box.normal = glm::vec4(0.0f);
+        legacyHits += checkAllbbox(box, boxes.straightsBBoxes) != glm::vec4(0.0f) ||
+                      checkAllBezier(centers[i], playerHitboxRadius, boxes.curveList, 0.01f) != glm::vec4(0.0f);
+    }
+    std::chrono::steady_clock::time_point t5 = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+    {
+        bbox box;
+        box.minPoint = centers[i] - glm::vec4(playerHalfExtent, playerHalfExtent, playerHalfExtent, 0.0f);
+        box.maxPoint = centers[i] + glm::vec4(playerHalfExtent, playerHalfExtent, playerHalfExtent, 0.0f);
+        box.normal = glm::vec4(0.0f);
+        CurveHit hit;
+        worldHits += boxes.world.wallNormal(box) != glm::vec4(0.0f) || boxes.world.curveContact(centers[i], playerHitboxRadius, hit);
+    }
+    std::chrono::steady_clock::time_point t6 = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+    {
+        glm::vec4 normal;
+        fieldHits += walls.distance(centers[i], normal) < playerHalfExtent;
+    }
+    std::chrono::steady_clock::time_point t7 = std::chrono::steady_clock::now();
+
+    printf("%-22s %10s %10s\n", "", "ns/car", "hits %");
+    printf("%-22s %10.1f %10.2f\n", "boxes + checkAllBezier", seconds(t4, t5) * 1e9 / legacyCount, 100.0 * legacyHits / legacyCount);
+    printf("%-22s %10.1f %10.2f\n", "tree + curve grid", seconds(t5, t6) * 1e9 / count, 100.0 * worldHits / count);
+    printf("%-22s %10.1f %10.2f\n", "wall field", seconds(t6, t7) * 1e9 / count, 100.0 * fieldHits / count);
+
+    const int cars = 10000;
+    const int steps = 240;
+    printf("\nRaceBatch, %d carros, %d passos\n", cars, steps);
+    printf("%-22s %12.0f race-steps/s\n", "boxes + curves", batchSteps(boxes, cars, steps));
+    printf("%-22s %12.0f race-steps/s\n", "wall field", batchSteps(field, cars, steps));
+    remove(cacheFile);
+    return 0;
+}
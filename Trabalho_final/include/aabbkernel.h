@@ -0,0 +1,34 @@
+#ifndef _AABBKERNEL_H
+#define _AABBKERNEL_H
+
+#include <vector>
+
+#include "collisions.h"
+#include "simdisa.h"
+
+// boxes as one array per coordinate, without w and normal, so the overlap
+// test reads only what it needs and can test several boxes per instruction.
+// The arrays are padded to a multiple of 8 with boxes that never overlap.
+struct AabbSoA
+{
+    void assign(const std::vector<bbox> &boxes);
+    int size() const { return count; }
+
+    int count;  // real boxes
+    int padded; // length of the arrays
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+};
+
+// index of the first box overlapping the car box, in array order, or -1.
+// Same test as bbcollision(), bounds included
+int firstOverlap(const AabbSoA &boxes, const float carMin[3], const float carMax[3]);
+
+// the same for many car boxes given as arrays, out[i] for car i. With SSE2
+// and AVX2 each box is tested against 4 or 8 cars per instruction, so the
+// boxes are read once per group of cars; a group stops when all its cars
+// found a box, which is fast when few cars touch any (a car on the track)
+void firstOverlaps(const AabbSoA &boxes, const float *carMinX, const float *carMinY, const float *carMinZ,
+                   const float *carMaxX, const float *carMaxY, const float *carMaxZ, int cars, int *out);
+
+#endif // _AABBKERNEL_H
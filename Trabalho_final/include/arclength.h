@@ -0,0 +1,40 @@
+#ifndef _ARCLENGTH_H
+#define _ARCLENGTH_H
+
+#include <vector>
+#include <glm/vec4.hpp>
+
+#include "spline.h"
+
+// a spline reparameterized by distance. build() measures it once and stores
+// the bezier time at evenly spaced distances, so finding the point at a distance
+// is one table lookup and one cubic, the same cost on every segment, without
+// searching. Distances wrap around a closed spline
+class ArcLengthTable
+{
+public:
+    ArcLengthTable();
+
+    // keeps a copy of spline, every segment is measured with samplesPerSegment
+    // chords and the table has an entry at most spacing meters apart
+    void build(const BezierSpline &spline, float spacing = 0.25f, int samplesPerSegment = 256);
+
+    float length() const { return m_length; }
+    const BezierSpline &spline() const { return m_spline; }
+
+    // bezier time at distance along the spline, distance wrapped around a
+    // closed spline and clamped to [0, length()] on an open one
+    float parameter(float distance) const;
+    // point at distance and the derivative of the curve there (not unit,
+    // zero length only where the control points are repeated)
+    void sample(float distance, glm::vec4 &point, glm::vec4 &tangent) const;
+
+private:
+    BezierSpline m_spline;
+    std::vector<float> m_parameter;    // bezier time at i * m_spacing meters
+    std::vector<float> m_segmentStart; // distance where each segment starts
+    float m_spacing, m_inverseSpacing;
+    float m_length, m_inverseLength;
+};
+
+#endif // _ARCLENGTH_H
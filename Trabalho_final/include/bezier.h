@@ -1,14 +1,161 @@
-inline glm::vec4 Bezier(std::vector<glm::vec4> controlPoints, int degree, float point)
+#ifndef _BEZIER_H
+#define _BEZIER_H
+
+#include <vector>
+#include <glm/vec4.hpp>
+
+template <typename T>
+constexpr T bezierLerp(const T &a, const T &b, float t)
 {
-    std::vector<glm::vec4> points = controlPoints;
-    int i = degree;
-    while (i>0)
+    return a + t * (b - a);
+}
+
+template <int... I>
+struct BezierIndices
+{
+};
+
+template <int N, int... I>
+struct MakeBezierIndices : MakeBezierIndices<N - 1, N - 1, I...>
+{
+};
+
+template <int... I>
+struct MakeBezierIndices<0, I...>
+{
+    typedef BezierIndices<I...> type;
+};
+
+// one row of the de Casteljau triangle
+template <typename T, int N>
+struct BezierLevel
+{
+    T p[N];
+};
+
+// de Casteljau on a fixed degree, one row of the triangle per recursion so it
+// is constexpr for scalar control points. Every step is the one Bezier()
+// does, so the result is the same, without copying the points to the heap
+template <int Degree>
+struct DeCasteljau
+{
+    template <typename T>
+    static constexpr T point(const BezierLevel<T, Degree + 1> &level, float t)
+    {
+        return reduce(level, t, typename MakeBezierIndices<Degree>::type());
+    }
+
+    template <typename T, int... I>
+    static constexpr T reduce(const BezierLevel<T, Degree + 1> &level, float t, BezierIndices<I...>)
+    {
+        return DeCasteljau<Degree - 1>::point(BezierLevel<T, Degree>{{bezierLerp(level.p[I], level.p[I + 1], t)...}}, t);
+    }
+};
+
+template <>
+struct DeCasteljau<0>
+{
+    template <typename T>
+    static constexpr T point(const BezierLevel<T, 1> &level, float)
+    {
+        return level.p[0];
+    }
+};
+
+template <int Degree, typename T, int... I>
+constexpr T bezierPoint(const T *points, float t, BezierIndices<I...>)
+{
+    return DeCasteljau<Degree>::point(BezierLevel<T, Degree + 1>{{points[I]...}}, t);
+}
+
+// point at t of the bezier of degree Degree with control points points[0..Degree]
+template <int Degree, typename T>
+constexpr T bezierPoint(const T *points, float t)
+{
+    return bezierPoint<Degree>(points, t, typename MakeBezierIndices<Degree + 1>::type());
+}
+
+constexpr float bezierBinomial(int n, int k)
+{
+    return k == 0 ? 1.0f : bezierBinomial(n, k - 1) * (n - k + 1) / k;
+}
+
+// the same curve in power basis, c[0] + c[1] t + ... + c[Degree] t^Degree, for
+// evaluating one curve at many parameters: Degree multiply-adds per point.
+// The coefficients are computed once, at compile time for constant scalar
+// points. Rounds a little differently from de Casteljau
+template <int Degree, typename T = glm::vec4>
+struct BezierPolynomial
+{
+    constexpr explicit BezierPolynomial(const T *points)
+        : BezierPolynomial(points, typename MakeBezierIndices<Degree + 1>::type())
+    {
+    }
+
+    constexpr T operator()(float t) const { return horner(t, 0); }
+
+    // derivative in t, c[1] + 2 c[2] t + ... + Degree c[Degree] t^(Degree - 1)
+    constexpr T tangent(float t) const { return hornerTangent(t, 1); }
+
+    T c[Degree + 1];
+
+private:
+    template <int... I>
+    constexpr BezierPolynomial(const T *points, BezierIndices<I...>)
+        : c{bezierBinomial(Degree, I) * difference(points, I, I)...}
+    {
+    }
+
+    // k-th forward difference of the control points, sum of
+    // (-1)^(k - i) C(k, i) points[i] for i = 0..k
+    static constexpr T difference(const T *points, int k, int i)
+    {
+        return i == 0 ? ((k % 2) ? -1.0f : 1.0f) * points[0]
+                      : ((k - i) % 2 ? -1.0f : 1.0f) * bezierBinomial(k, i) * points[i] + difference(points, k, i - 1);
+    }
+
+    constexpr T horner(float t, int i) const
+    {
+        return i == Degree ? c[i] : c[i] + t * horner(t, i + 1);
+    }
+
+    constexpr T hornerTangent(float t, int i) const
+    {
+        return i == Degree ? (float)i * c[i] : (float)i * c[i] + t * hornerTangent(t, i + 1);
+    }
+};
+
+// point at t of the bezier curve of any degree, controlPoints[0..degree]
+inline glm::vec4 Bezier(const std::vector<glm::vec4> &controlPoints, int degree, float point)
+{
+    if (degree == 3)
+    {
+        return bezierPoint<3>(&controlPoints[0], point);
+    }
+    // de Casteljau in place, on the stack unless the degree is very high
+    glm::vec4 stack[8];
+    std::vector<glm::vec4> heap;
+    glm::vec4 *points = stack;
+    if (degree >= 8)
+    {
+        heap.assign(controlPoints.begin(), controlPoints.begin() + degree + 1);
+        points = &heap[0];
+    }
+    else
+    {
+        for (int j = 0; j <= degree; j++)
+        {
+            points[j] = controlPoints[j];
+        }
+    }
+    for (int i = degree; i > 0; i--)
     {
         for (int j = 0; j < i; j++)
         {
-            points.at(j)=(points[j] + point * (points[j + 1] - points[j]));
+            points[j] = bezierLerp(points[j], points[j + 1], point);
         }
-        i--;
     }
     return points[0];
-}
\ No newline at end of file
+}
+
+#endif // _BEZIER_H
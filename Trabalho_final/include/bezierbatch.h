@@ -0,0 +1,30 @@
+#ifndef _BEZIERBATCH_H
+#define _BEZIERBATCH_H
+
+#include "bezier.h"
+#include "simdisa.h"
+
+// output of a batch, one array per coordinate, count floats each
+struct BezierSamples
+{
+    float *x, *y, *z;    // points
+    float *dx, *dy, *dz; // tangents (derivative in t), NULL to skip them
+};
+
+// a cubic laid out for the batch: power basis coefficients per coordinate
+// and those of the tangent, computed once per curve
+struct BezierBatchCurve
+{
+    explicit BezierBatchCurve(const BezierPolynomial<3> &curve);
+
+    float p[3][4]; // c[0..3]
+    float d[3][3]; // c[1], 2 c[2], 3 c[3]
+};
+
+// points and tangents of one cubic at t[0..count-1], 4 (SSE2) or 8 (AVX2)
+// parameters per instruction with the instruction set picked by simdIsa(),
+// the rest one at a time. Same Horner steps as BezierPolynomial, so every
+// instruction set gives the values curve(t) and curve.tangent(t) give
+void bezierSamples(const BezierBatchCurve &curve, const float *t, int count, const BezierSamples &out);
+
+#endif // _BEZIERBATCH_H
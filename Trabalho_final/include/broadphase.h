@@ -0,0 +1,45 @@
+#ifndef _BROADPHASE_H
+#define _BROADPHASE_H
+
+#include <vector>
+
+// pair of car indices, a < b
+struct CarPair
+{
+    int a;
+    int b;
+};
+
+// uniform grid over the XZ plane for car versus car collisions, rebuilt every
+// tick. Cells are hashed into a table sized from the car count, so the track
+// size doesn't matter and building is a counting sort. Queries only look at
+// the cells around a car, so finding every pair is close to linear instead
+// of testing all N * N pairs. Results are candidates whose squares overlap,
+// the caller still does the exact sphere test.
+class SpatialHash
+{
+public:
+    explicit SpatialHash(float cellSize); // cellSize >= the largest query radius
+
+    void build(const float *x, const float *z, int count);
+    int size() const { return m_count; }
+
+    // cars within radius of (x, z) on both axes, in index order
+    void query(float x, float z, float radius, std::vector<int> &hits) const;
+    // every pair of cars within radius of each other on both axes
+    void pairs(float radius, std::vector<CarPair> &out) const;
+
+private:
+    unsigned int bucket(int cellX, int cellZ) const;
+    int neighbourBuckets(float x, float z, unsigned int *buckets) const; // up to 9, without repeats
+
+    float m_cellSize;
+    int m_count;
+    unsigned int m_mask;
+    std::vector<unsigned int> m_bucketStart; // first entry of each bucket in m_items, one extra at the end
+    std::vector<unsigned int> m_itemBucket;
+    std::vector<int> m_items;                // car indices sorted by bucket
+    std::vector<float> m_x, m_z;             // positions in m_items order
+};
+
+#endif // _BROADPHASE_H
@@ -0,0 +1,23 @@
+#ifndef _COLLISIONS_H
+#define _COLLISIONS_H
+
+#include <vector>
+#include <glm/vec4.hpp>
+
+// axis aligned box used for the track walls, checkpoints and the player hitbox,
+// normal is the direction the car is pushed to when hitting it
+typedef struct bbox
+{
+    glm::vec4 minPoint;
+    glm::vec4 maxPoint;
+    glm::vec4 normal;
+} bbox;
+
+bool bbcollision(const bbox &bbox1, const bbox &bbox2);
+glm::vec4 checkAllbbox(const bbox &player, const std::vector<bbox> &list);
+bool spheres_collision(glm::vec4 hitbox1Center, float hitbox1Radius, glm::vec4 hitbox2Center, float hitbox2Radius);
+bool sphere_point(glm::vec4 hitbox1Center, float hitbox1Radius, glm::vec4 point);
+glm::vec4 checkBezier(glm::vec4 hitbox1Center, float hitbox1Radius, const std::vector<glm::vec4> &controlPoints, float step);
+glm::vec4 checkAllBezier(glm::vec4 hitbox1Center, float hitbox1Radius, const std::vector<std::vector<glm::vec4>> &bezierList, float step);
+
+#endif // _COLLISIONS_H
@@ -0,0 +1,174 @@
+#ifndef _COLLISIONWORLD_H
+#define _COLLISIONWORLD_H
+
+#include <vector>
+#include <glm/vec4.hpp>
+
+#include "aabbkernel.h"
+#include "broadphase.h"
+#include "collisions.h"
+#include "curvecollider.h"
+#include "wallfield.h"
+
+class WorkStealingPool;
+
+// per-car memory of the colliders around the car, owned by whoever owns the
+// car (RaceSim, one per race in RaceBatch). A car moves a few centimeters per
+// tick, so a query that can't be answered from the hint gathers every box and
+// curve segment within margin of the car, and the next queries only test
+// those until the car leaves that margin. Results are the same as without a
+// hint; the counters tell how often the hint answered and how much work the
+// queries took
+struct CollisionHint
+{
+    enum { maxBoxes = 16, maxSegments = 32 };
+
+    explicit CollisionHint(float margin = 1.0f);
+    void invalidate(); // keeps the counters
+
+    float margin;
+
+    // walls and checkpoints overlapping [boxMin, boxMax], in list order
+    float boxMin[3], boxMax[3];
+    int boxCount; // -1: nothing gathered or too many boxes
+    int boxes[maxBoxes];
+
+    // curve segments near (curveX, curveZ), for queries of curveRadius
+    float curveX, curveZ, curveRadius;
+    int segmentCount; // -1: nothing gathered or too many segments
+    int segments[maxSegments];
+
+    long long queries; // hinted queries
+    long long hits;    // answered from what the hint had gathered
+    long long tests;   // tree nodes, boxes and segments looked at
+};
+
+// a car for CollisionWorld::collideAll, cars drive at y = 0
+struct CarState
+{
+    float x, z;
+};
+
+// other cars as spheres for collideAll (the opponents), positions of the
+// current tick. grid, if given, must be built from x and z
+struct CarSpheres
+{
+    const float *x, *y, *z;
+    int count;
+    const SpatialHash *grid;
+};
+
+// everything one car touches, from collideAll
+struct Contact
+{
+    enum { maxCars = 8 };
+
+    glm::vec4 wallNormal;       // first wall in list order, or from the wall field; zero if none
+    glm::vec4 checkpointNormal; // first checkpoint in list order, zero if none
+    bool curve;                 // curveHit holds the closest curved wall
+    CurveHit curveHit;
+    int carCount;               // spheres touching the car, the first maxCars are in cars, in index order
+    int cars[maxCars];
+};
+
+struct CollideOptions
+{
+    CollideOptions();
+
+    float halfExtent;          // car box against walls and checkpoints
+    float radius;              // car sphere against the curves
+    const CarSpheres *spheres; // tested when closer than sphereReach, if given
+    float sphereReach;
+    CollisionHint *hints;      // one per car, if given
+    WorkStealingPool *pool;    // splits large batches across its threads, if given
+    // candidate lists, one per pool thread (one without a pool), kept by the
+    // caller between calls so collideAll doesn't allocate. Optional
+    std::vector<std::vector<int>> *scratch;
+};
+
+// static colliders of a track, built once when the track is loaded and then
+// only read, so it can be shared by every simulated race. Wall boxes and
+// checkpoints go into one AABB tree built with the surface area heuristic;
+// queries walk it with a fixed stack and never allocate. Curved walls are
+// kept apart in a CurveCollider. Once a wall field is open it replaces the
+// wall boxes and the curves in the wall queries below, so the walls come from
+// the track model instead of the hand-typed lists.
+class CollisionWorld
+{
+public:
+    CollisionWorld();
+
+    void build(const std::vector<bbox> &walls, const std::vector<bbox> &checkpoints,
+               const std::vector<std::vector<glm::vec4>> &curves = std::vector<std::vector<glm::vec4>>());
+
+    // every wall or checkpoint overlapping box, as indices in list order:
+    // walls are [0, wallCount()), checkpoints come after them. Returns how
+    // many overlap, only the first maxHits are written to hits
+    int overlaps(const bbox &box, int *hits, int maxHits) const;
+
+    // normal of the first wall / checkpoint overlapping box, in list order,
+    // or a zero vector. Same result as checkAllbbox() on the original lists.
+    // With a wall field: its normal if the box center is closer to a wall
+    // than half the box width
+    glm::vec4 wallNormal(const bbox &box) const;
+    glm::vec4 checkpointNormal(const bbox &box) const;
+    glm::vec4 wallNormal(const bbox &box, CollisionHint &hint) const;
+    glm::vec4 checkpointNormal(const bbox &box, CollisionHint &hint) const;
+
+    // time of impact in [0, 1] of box moving by motion against the walls it
+    // doesn't already overlap, and the wall hit first (lowest index on ties).
+    // False if the box reaches the end of the motion freely
+    bool sweepWalls(const bbox &box, const glm::vec4 &motion, float &toi, int &wall) const;
+
+    // part of motion, in [0, 1], the car can move without passing through a
+    // wall box or a curve. A hit moves the car just past the contact so the
+    // overlap tests see it on the next step. Moves shorter than the car are
+    // not swept, they can't skip over anything
+    float sweepFraction(const glm::vec4 &center, float halfExtent, float radius, const glm::vec4 &motion) const;
+
+    // every contact of n cars in one pass: walls and checkpoints through the
+    // box kernel, curves, and the spheres of options. out[i] only depends on
+    // cars[i], so the output is the same however the cars are split across
+    // threads
+    void collideAll(const CarState *cars, size_t n, Contact *out, const CollideOptions &options) const;
+
+    // closest point of a curved wall within radius of center
+    bool curveContact(const glm::vec4 &center, float radius, CurveHit &hit) const { return !m_field.isOpen() && m_curves.closest(center, radius, hit); }
+    bool curveContact(const glm::vec4 &center, float radius, CurveHit &hit, CollisionHint &hint) const;
+    const CurveCollider &curves() const { return m_curves; }
+
+    WallField &wallField() { return m_field; }
+    const WallField &wallField() const { return m_field; }
+
+    int wallCount() const { return m_wallCount; }
+    int boxCount() const { return (int)m_boxes.size(); }
+    int depth() const { return m_depth; }
+    const bbox &box(int index) const { return m_boxes[index]; }
+
+private:
+    struct Node
+    {
+        float min[3];
+        float max[3];
+        int first; // leaf: first entry in m_order, inner: index of the right child (left is the next node)
+        int count; // boxes in the leaf, 0 for inner nodes
+    };
+
+    int buildNode(int first, int count, int depth, std::vector<float> &centers, std::vector<float> &leftArea);
+    int overlaps(const bbox &box, int *hits, int maxHits, long long &tests) const;
+    void collideRange(const CarState *cars, size_t begin, size_t end, Contact *out, const CollideOptions &options, std::vector<int> &candidates) const;
+    glm::vec4 firstNormal(const bbox &box, int begin, int end) const;
+    glm::vec4 firstNormal(const bbox &box, int begin, int end, CollisionHint &hint) const;
+
+    std::vector<bbox> m_boxes;
+    std::vector<Node> m_nodes;
+    std::vector<int> m_order; // box indices, grouped by leaf
+    AabbSoA m_wallArrays;     // the same boxes for collideAll
+    AabbSoA m_checkArrays;
+    CurveCollider m_curves;
+    WallField m_field;
+    int m_wallCount;
+    int m_depth;
+};
+
+#endif // _COLLISIONWORLD_H
@@ -0,0 +1,81 @@
+#ifndef _CURVECOLLIDER_H
+#define _CURVECOLLIDER_H
+
+#include <vector>
+#include <glm/vec4.hpp>
+
+// closest point of a curved wall to a query center
+struct CurveHit
+{
+    glm::vec4 point;  // on the curve
+    glm::vec4 normal; // unit, from the curve towards the center, in the XZ plane
+    float distance;
+    int curve;        // index in the list given to build()
+    float t;          // curve parameter of point
+};
+
+// curved walls (cubic beziers in the XZ plane) flattened once into a polyline
+// that stays within a tolerance of the curve, with the segments in a uniform
+// grid. A query only looks at the segments of the cells around the center and
+// then refines the closest one on the real curve with Newton's method, so the
+// point returned is exact and nothing is allocated
+class CurveCollider
+{
+public:
+    CurveCollider();
+
+    void build(const std::vector<std::vector<glm::vec4>> &curves, float tolerance = 0.01f);
+
+    // closest curve point strictly within radius of center, false if none.
+    // Ties between segments go to the lowest segment index
+    bool closest(const glm::vec4 &center, float radius, CurveHit &hit) const;
+
+    // the same, looking only at the given segments, which must include every
+    // segment within radius + tolerance() of center (see segmentsNear)
+    bool closest(const glm::vec4 &center, float radius, CurveHit &hit, const int *segments, int count) const;
+
+    // segments whose polyline passes within reach of center, in index order.
+    // Returns how many, only the first maxSegments are written; scanned is
+    // the number of grid entries looked at
+    int segmentsNear(const glm::vec4 &center, float reach, int *segments, int maxSegments, int &scanned) const;
+
+    // first contact of a sphere moving from center by motion; a sphere
+    // already touching a curve is not swept. The sphere is tested at most
+    // radius apart along the motion, a hit is then refined by bisection;
+    // toi is the fraction of motion at the contact
+    bool sweep(const glm::vec4 &center, float radius, const glm::vec4 &motion, float &toi, CurveHit &hit) const;
+
+    float tolerance() const { return m_tolerance; }
+    int curveCount() const { return (int)m_cubics.size(); }
+    int segmentCount() const { return (int)m_segments.size(); }
+    glm::vec4 point(int curve, float t) const;
+
+private:
+    struct Cubic
+    {
+        float x[4]; // power basis: x[0] + x[1] t + x[2] t^2 + x[3] t^3
+        float z[4];
+    };
+    struct Segment
+    {
+        float ax, az, bx, bz; // ends, on the curve
+        float t0, t1;         // curve parameters of the ends
+        int curve;
+    };
+
+    void flatten(int curve, float t0, float t1, int depth);
+    bool refine(int segment, float along, const glm::vec4 &center, float radius, CurveHit &hit) const;
+    void cellRange(float min, float max, int cells, float origin, int &first, int &last) const;
+
+    std::vector<Cubic> m_cubics;
+    std::vector<Segment> m_segments;
+    float m_tolerance;
+
+    // cell c holds m_cellItems[m_cellStart[c], m_cellStart[c + 1])
+    float m_originX, m_originZ, m_cellSize;
+    int m_cellsX, m_cellsZ;
+    std::vector<int> m_cellStart;
+    std::vector<int> m_cellItems;
+};
+
+#endif // _CURVECOLLIDER_H
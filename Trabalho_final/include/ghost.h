@@ -0,0 +1,71 @@
+#ifndef _GHOST_H
+#define _GHOST_H
+
+#include <cstdio>
+#include <glm/mat4x4.hpp>
+
+#include "mappedfile.h"
+
+// Ghosts are recorded races drawn next to the player without collisions.
+// A ghost file keeps the player transform of every tick, so playing a ghost
+// back only reads two frames and interpolates, no simulation needed. Files
+// are memory mapped and never copied to RAM as a whole.
+//
+// File format (native byte order, files from a machine with the other byte
+// order are rejected):
+//   "FZGH"               magic
+//   uint16 version       GHOST_VERSION
+//   uint16 unused
+//   float  tickRate      ticks per second used when recording
+//   uint32 frameCount
+//   frameCount * 12 floats, the first three rows of the model matrix,
+//   column by column. Frame 0 is the race at the start, frame i the race
+//   after i ticks
+#define GHOST_VERSION 1
+#define MAX_GHOSTS 64
+
+class GhostWriter
+{
+public:
+    GhostWriter();
+    ~GhostWriter();
+
+    bool open(const char *filename, float tickRate);
+    void record(const glm::mat4 &model); // transform of the next frame
+    void close();
+    bool isOpen() const { return m_file != NULL; }
+    int frames() const { return (int)m_frames; }
+
+private:
+    FILE *m_file;
+    unsigned int m_frames;
+};
+
+class GhostSet
+{
+public:
+    GhostSet();
+
+    bool add(const char *filename); // false if the file is invalid or MAX_GHOSTS is reached
+    int size() const { return m_count; }
+
+    // moves every ghost to the given race time, interpolating between ticks.
+    // Doesn't allocate, the cost is two frame reads per ghost
+    void update(float time);
+    const glm::mat4 &model(int ghost) const { return m_models[ghost]; }
+
+private:
+    struct Ghost
+    {
+        MappedFile file;
+        const float *frames;
+        unsigned int frameCount;
+        float tickRate;
+    };
+
+    Ghost m_ghosts[MAX_GHOSTS];
+    glm::mat4 m_models[MAX_GHOSTS];
+    int m_count;
+};
+
+#endif // _GHOST_H
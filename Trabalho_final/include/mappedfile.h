@@ -0,0 +1,42 @@
+#ifndef _MAPPEDFILE_H
+#define _MAPPEDFILE_H
+
+#include <cstddef>
+
+// read-only view of a whole file mapped into memory. Pages are loaded by the
+// operating system on first access, so opening a big file is cheap and only
+// the parts actually read end up in RAM.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool open(const char *filename);
+    void close();
+    bool isOpen() const { return m_data != NULL; }
+    const unsigned char *data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+    const unsigned char *m_data;
+    size_t m_size;
+#ifdef _WIN32
+    void *m_file;
+    void *m_mapping;
+#endif
+};
+
+// The game's binary files (replays, ghosts, wall fields) are written in the
+// byte order of the machine that wrote them and read in place. A file from a
+// machine with the other byte order shows its uint16 version with the two
+// bytes swapped, which is how the readers recognize and reject it
+inline unsigned short byteSwap16(unsigned short v)
+{
+    return (unsigned short)((v >> 8) | (v << 8));
+}
+
+#endif // _MAPPEDFILE_H
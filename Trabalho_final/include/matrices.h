@@ -1,6 +1,7 @@
 #ifndef _MATRICES_H
 #define _MATRICES_H
 
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 
@@ -9,6 +10,27 @@
 #include <glm/vec4.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+// Os produtos de matrizes e vetores abaixo (Matrix_Multiply(), crossproduct(),
+// dotproduct(), norm() e unitvector()) têm uma versão escalar e, em CPUs x86
+// (SSE faz parte de todo x86-64), uma versão SIMD que opera nos 4 floats de
+// uma coluna por instrução. As duas fazem as mesmas operações na mesma ordem
+// que os operadores da GLM e que glm::normalize() (para vetores com w = 0),
+// então os resultados são idênticos bit a bit e a simulação (e os replays)
+// não mudam com a chave.
+//
+// A versão escalar é a padrão: com -O2 o compilador vetoriza o código
+// escalar e a GLM tão bem quanto a versão SSE ("make bench_matrices"). A
+// versão SSE só ganha em builds sem otimização (-g), onde é de 3 a 10 vezes
+// mais rápida; é ligada com -DMATRICES_SSE, como na linha do "main" dos
+// Makefiles.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATRICES_HAS_SSE 1
+#include <emmintrin.h>
+#endif
+#if defined(MATRICES_HAS_SSE) && defined(MATRICES_SSE)
+#define MATRICES_SIMD 1
+#endif
+
 // Esta função Matrix() auxilia na criação de matrizes usando a biblioteca GLM.
 // Note que em OpenGL (e GLM) as matrizes são definidas como "column-major",
 // onde os elementos da matriz são armazenadas percorrendo as COLUNAS da mesma.
@@ -146,15 +168,184 @@ inline glm::mat4 Matrix_Rotate_Z(float angle)
     );
 }
 
-// Função que calcula a norma Euclidiana de um vetor cujos coeficientes são
-// definidos em uma base ortonormal qualquer.
-inline float norm(glm::vec4 v)
+// Produto de matrizes A*B, igual ao operador * da GLM: cada coluna de A*B é
+// a combinação das colunas de A pelos coeficientes da coluna de B, somados
+// da primeira à última coluna de A.
+inline glm::mat4 Matrix_MultiplyScalar(const glm::mat4 &a, const glm::mat4 &b)
+{
+    glm::mat4 r;
+    for (int j = 0; j < 4; j++)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            r[j][i] = a[0][i]*b[j][0] + a[1][i]*b[j][1] + a[2][i]*b[j][2] + a[3][i]*b[j][3];
+        }
+    }
+    return r;
+}
+
+// Produto de matriz por vetor M*v, igual ao operador * da GLM, que soma as
+// colunas duas a duas.
+inline glm::vec4 Matrix_MultiplyScalar(const glm::mat4 &m, const glm::vec4 &v)
+{
+    glm::vec4 r;
+    for (int i = 0; i < 4; i++)
+    {
+        r[i] = (m[0][i]*v.x + m[1][i]*v.y) + (m[2][i]*v.z + m[3][i]*v.w);
+    }
+    return r;
+}
+
+inline glm::vec4 crossproductScalar(const glm::vec4 &u, const glm::vec4 &v)
+{
+    float u1 = u.x;
+    float u2 = u.y;
+    float u3 = u.z;
+    float v1 = v.x;
+    float v2 = v.y;
+    float v3 = v.z;
+
+    return glm::vec4(
+        u2*v3 - u3*v2, // Primeiro coeficiente
+        u3*v1 - u1*v3, // Segundo coeficiente
+        u1*v2 - u2*v1, // Terceiro coeficiente
+        0.0f // w = 0 para vetores.
+    );
+}
+
+inline float dotproductScalar(const glm::vec4 &u, const glm::vec4 &v)
+{
+    return u.x*v.x + u.y*v.y + u.z*v.z;
+}
+
+inline float normScalar(const glm::vec4 &v)
 {
     float vx = v.x;
     float vy = v.y;
     float vz = v.z;
 
-    return sqrt( vx*vx + vy*vy + vz*vz );
+    return std::sqrt( vx*vx + vy*vy + vz*vz );
+}
+
+// Como glm::normalize(): v vezes o inverso da norma, não v dividido por ela
+inline glm::vec4 unitvectorScalar(const glm::vec4 &v)
+{
+    return v * (1.0f / normScalar(v));
+}
+
+#ifdef MATRICES_HAS_SSE
+// As mesmas funções com SSE. As colunas das matrizes da GLM não são
+// alinhadas em 16 bytes, por isso as leituras e escritas "u" (unaligned).
+inline glm::mat4 Matrix_MultiplySimd(const glm::mat4 &a, const glm::mat4 &b)
+{
+    __m128 a0 = _mm_loadu_ps(&a[0][0]);
+    __m128 a1 = _mm_loadu_ps(&a[1][0]);
+    __m128 a2 = _mm_loadu_ps(&a[2][0]);
+    __m128 a3 = _mm_loadu_ps(&a[3][0]);
+    glm::mat4 r;
+    for (int j = 0; j < 4; j++)
+    {
+        __m128 bj = _mm_loadu_ps(&b[j][0]);
+        __m128 c = _mm_mul_ps(a0, _mm_shuffle_ps(bj, bj, _MM_SHUFFLE(0, 0, 0, 0)));
+        c = _mm_add_ps(c, _mm_mul_ps(a1, _mm_shuffle_ps(bj, bj, _MM_SHUFFLE(1, 1, 1, 1))));
+        c = _mm_add_ps(c, _mm_mul_ps(a2, _mm_shuffle_ps(bj, bj, _MM_SHUFFLE(2, 2, 2, 2))));
+        c = _mm_add_ps(c, _mm_mul_ps(a3, _mm_shuffle_ps(bj, bj, _MM_SHUFFLE(3, 3, 3, 3))));
+        _mm_storeu_ps(&r[j][0], c);
+    }
+    return r;
+}
+
+inline glm::vec4 Matrix_MultiplySimd(const glm::mat4 &m, const glm::vec4 &v)
+{
+    __m128 c01 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&m[0][0]), _mm_set1_ps(v.x)), _mm_mul_ps(_mm_loadu_ps(&m[1][0]), _mm_set1_ps(v.y)));
+    __m128 c23 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&m[2][0]), _mm_set1_ps(v.z)), _mm_mul_ps(_mm_loadu_ps(&m[3][0]), _mm_set1_ps(v.w)));
+    glm::vec4 r;
+    _mm_storeu_ps(&r.x, _mm_add_ps(c01, c23));
+    return r;
+}
+
+// (u.yzx * v.zxy - u.zxy * v.yzx), com w zerado
+inline glm::vec4 crossproductSimd(const glm::vec4 &u, const glm::vec4 &v)
+{
+    __m128 a = _mm_loadu_ps(&u.x);
+    __m128 b = _mm_loadu_ps(&v.x);
+    __m128 ayzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 azxy = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2));
+    __m128 byzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 bzxy = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2));
+    __m128 c = _mm_sub_ps(_mm_mul_ps(ayzx, bzxy), _mm_mul_ps(azxy, byzx));
+    __m128 xyz = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    glm::vec4 r;
+    _mm_storeu_ps(&r.x, _mm_and_ps(c, xyz));
+    return r;
+}
+
+// x*x' + y*y' + z*z' somados nessa ordem, em um registro
+inline __m128 dotproductSimdSS(const glm::vec4 &u, const glm::vec4 &v)
+{
+    __m128 p = _mm_mul_ps(_mm_loadu_ps(&u.x), _mm_loadu_ps(&v.x));
+    __m128 s = _mm_add_ss(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_add_ss(s, _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2)));
+}
+
+inline float dotproductSimd(const glm::vec4 &u, const glm::vec4 &v)
+{
+    return _mm_cvtss_f32(dotproductSimdSS(u, v));
+}
+
+inline float normSimd(const glm::vec4 &v)
+{
+    return _mm_cvtss_f32(_mm_sqrt_ss(dotproductSimdSS(v, v)));
+}
+
+inline glm::vec4 unitvectorSimd(const glm::vec4 &v)
+{
+    __m128 inverse = _mm_div_ss(_mm_set_ss(1.0f), _mm_sqrt_ss(dotproductSimdSS(v, v)));
+    glm::vec4 r;
+    _mm_storeu_ps(&r.x, _mm_mul_ps(_mm_loadu_ps(&v.x), _mm_shuffle_ps(inverse, inverse, 0)));
+    return r;
+}
+#endif // MATRICES_HAS_SSE
+
+// Produto de matrizes A*B e de matriz por vetor M*v. Dão o mesmo resultado
+// que os operadores da GLM, sem depender de como o compilador os vetoriza.
+inline glm::mat4 Matrix_Multiply(const glm::mat4 &a, const glm::mat4 &b)
+{
+#ifdef MATRICES_SIMD
+    return Matrix_MultiplySimd(a, b);
+#else
+    return Matrix_MultiplyScalar(a, b);
+#endif
+}
+
+inline glm::vec4 Matrix_Multiply(const glm::mat4 &m, const glm::vec4 &v)
+{
+#ifdef MATRICES_SIMD
+    return Matrix_MultiplySimd(m, v);
+#else
+    return Matrix_MultiplyScalar(m, v);
+#endif
+}
+
+// Função que calcula a norma Euclidiana de um vetor cujos coeficientes são
+// definidos em uma base ortonormal qualquer.
+inline float norm(const glm::vec4 &v)
+{
+#ifdef MATRICES_SIMD
+    return normSimd(v);
+#else
+    return normScalar(v);
+#endif
+}
+
+// Vetor v multiplicado pelo inverso da sua norma (x, y e z, como norm()).
+inline glm::vec4 unitvector(const glm::vec4 &v)
+{
+#ifdef MATRICES_SIMD
+    return unitvectorSimd(v);
+#else
+    return unitvectorScalar(v);
+#endif
 }
 
 
@@ -163,7 +354,7 @@ inline float norm(glm::vec4 v)
 // coordenadas e em torno do eixo definido pelo vetor 'axis'. Esta matriz pode
 // ser definida pela fórmula de Rodrigues. Lembre-se que o vetor que define o
 // eixo de rotação deve ser normalizado!
-inline glm::mat4 Matrix_Rotate(float angle, glm::vec4 axis)
+inline glm::mat4 Matrix_Rotate(float angle, const glm::vec4 &axis)
 {
     float c = cos(angle);
     float s = sin(angle);
@@ -184,42 +375,30 @@ inline glm::mat4 Matrix_Rotate(float angle, glm::vec4 axis)
 
 // Produto vetorial entre dois vetores u e v definidos em um sistema de
 // coordenadas ortonormal.
-inline glm::vec4 crossproduct(glm::vec4 u, glm::vec4 v)
+inline glm::vec4 crossproduct(const glm::vec4 &u, const glm::vec4 &v)
 {
-    float u1 = u.x;
-    float u2 = u.y;
-    float u3 = u.z;
-    float v1 = v.x;
-    float v2 = v.y;
-    float v3 = v.z;
-
-    return glm::vec4(
-        u2*v3 - u3*v2, // Primeiro coeficiente
-        u3*v1 - u1*v3, // Segundo coeficiente
-        u1*v2 - u2*v1, // Terceiro coeficiente
-        0.0f // w = 0 para vetores.
-    );
+#ifdef MATRICES_SIMD
+    return crossproductSimd(u, v);
+#else
+    return crossproductScalar(u, v);
+#endif
 }
 
 // Produto escalar entre dois vetores u e v definidos em um sistema de
 // coordenadas ortonormal.
-inline float dotproduct(glm::vec4 u, glm::vec4 v)
+inline float dotproduct(const glm::vec4 &u, const glm::vec4 &v)
 {
-    float u1 = u.x;
-    float u2 = u.y;
-    float u3 = u.z;
-    float u4 = u.w;
-    float v1 = v.x;
-    float v2 = v.y;
-    float v3 = v.z;
-    float v4 = v.w;
-    if ( u4 != 0.0f || v4 != 0.0f )
+    if ( u.w != 0.0f || v.w != 0.0f )
     {
         fprintf(stderr, "ERROR: Produto escalar não definido para pontos.\n");
         std::exit(EXIT_FAILURE);
     }
 
-    return u1*v1 + u2*v2 + u3*v3;
+#ifdef MATRICES_SIMD
+    return dotproductSimd(u, v);
+#else
+    return dotproductScalar(u, v);
+#endif
 }
 
 // Matriz de mudança de coordenadas para o sistema de coordenadas da Câmera.
@@ -1,61 +1,46 @@
+#ifndef _OPPONENT_H
+#define _OPPONENT_H
+
+#include <cmath>
 #include <glm/mat4x4.hpp>
 #include <glm/vec4.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-// returns the opponent model matrix, also updates oldposition, forward and position
-glm::mat4 opponentMovement(glm::mat4 model, float bezierTime, std::vector<glm::vec4> controlPoints1, std::vector<glm::vec4> controlPoints2,std::vector<glm::vec4> controlPoints3,std::vector<glm::vec4> controlPoints4,std::vector<glm::vec4> controlPoints5,std::vector<glm::vec4> controlPoints6, int degree, glm::vec4 &forward, glm::vec4 &pos, glm::vec4 &oldpos)
-{
-    glm::mat4 returnModel = model;
-    glm::vec4 BezierPoint;
-    if (bezierTime <= 1)
-    {
-        BezierPoint = Bezier(controlPoints1, degree, bezierTime);
-    }
-    else if(bezierTime<=2)
-    {
-        BezierPoint = Bezier(controlPoints2, degree, bezierTime-1);
-    }
-    else if(bezierTime<=3)
-    {
-        BezierPoint = Bezier(controlPoints3, degree, bezierTime-2);
-    }
-    else if(bezierTime<=4)
-    {
-        BezierPoint = Bezier(controlPoints4, degree, bezierTime-3);
-    }else if(bezierTime<=5)
-    {
-        BezierPoint = Bezier(controlPoints5, degree, bezierTime-4);
-    }else if(bezierTime<=6)
-    {
-        BezierPoint = Bezier(controlPoints6, degree, bezierTime-5);
-    }
-    else{
-        return returnModel;
-    }
- 
-    glm::vec4 newPoint = BezierPoint - oldpos;
+#include "spline.h"
 
+// the opponent mesh is modelled in other units, see the old resetOpponent()
+static const float opponentScale = 0.0012f;
+// radius of the opponent hitbox sphere
+static const float opponentHitboxRadius = 0.8f;
 
-    float dotprod = dotproduct(normalize(newPoint), forward);
-    if (dotprod > 1)
-    {
-        dotprod = 1;
-    }
-    if (dotprod < -1)
-    {
-        dotprod = -1;
-    }
-    float angle = acos(dotprod);
-    glm::vec4 cross = crossproduct(newPoint, forward);
-    if (cross.y < 0)
+// Translate(x, y, z) * Rotate_Y(PI/2 - heading) * Scale, the matrix the old
+// opponentMovement() accumulated tick by tick, built directly from the unit
+// forward direction (fx, fz). With the heading measured from +x,
+// cos(PI/2 - heading) = fz and sin(PI/2 - heading) = fx
+inline glm::mat4 opponentModel(float x, float y, float z, float fx, float fz)
+{
+    glm::mat4 model;
+    model[0] = glm::vec4(opponentScale * fz, 0.0f, -opponentScale * fx, 0.0f);
+    model[1] = glm::vec4(0.0f, opponentScale, 0.0f, 0.0f);
+    model[2] = glm::vec4(opponentScale * fx, 0.0f, opponentScale * fz, 0.0f);
+    model[3] = glm::vec4(x, y, z, 1.0f);
+    return model;
+}
+
+// returns the opponent model matrix at bezierTime on path, rebuilt from the
+// point and the tangent of the curve there, nothing carried from the last
+// call. Also updates forward (unit, in the XZ plane, kept where the tangent
+// vanishes) and pos. An open path stops at its end, a closed one wraps around
+inline glm::mat4 opponentMovement(float bezierTime, const BezierSpline &path, glm::vec4 &forward, glm::vec4 &pos)
+{
+    float t;
+    int segment = path.segment(bezierTime, t);
+    pos = path.curve(segment)(t);
+    glm::vec4 tangent = path.curve(segment).tangent(t);
+    float length = std::sqrt(tangent.x * tangent.x + tangent.z * tangent.z);
+    if (length > 0.0f)
     {
-        angle = -1 * angle;
+        forward = glm::vec4(tangent.x / length, 0.0f, tangent.z / length, 0.0f);
     }
-
-    forward = normalize(newPoint);
-    returnModel = Matrix_Translate(pos.x, pos.y, pos.z) * Matrix_Rotate_Y(-angle) * Matrix_Translate(-pos.x, -pos.y, -pos.z) * returnModel;
-    returnModel = Matrix_Translate(newPoint.x, newPoint.y, newPoint.z) * returnModel;
-    pos = Matrix_Translate(newPoint.x, newPoint.y, newPoint.z) * pos;
-
-    oldpos = BezierPoint;
-    return returnModel;
+    return opponentModel(pos.x, pos.y, pos.z, forward.x, forward.z);
 }
+
+#endif // _OPPONENT_H
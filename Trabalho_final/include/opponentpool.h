@@ -0,0 +1,74 @@
+#ifndef _OPPONENTPOOL_H
+#define _OPPONENTPOOL_H
+
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include "arclength.h"
+#include "broadphase.h"
+#include "opponent.h"
+#include "track.h"
+
+// every AI car of a race, stored as structure of arrays (one array per
+// field, one entry per opponent) so hundreds of them update and collide in
+// tight loops. Opponents follow the bezier paths of the track at a constant
+// speed, through an arc-length table of each path, and their pose is
+// computed from the race time alone: distance along the path, heading from
+// the tangent of the curve there, no matrix kept from one tick to the next.
+// Updating is then the same at any time, and restoring a race only needs
+// its clock.
+class OpponentPool
+{
+public:
+    explicit OpponentPool(const RaceTrack &track); // the NUM_OPPONENTS opponents of the track
+
+    int size() const { return (int)path.size(); }
+
+    // adds an opponent following path of the track at speed meters per
+    // second, timeOffset seconds ahead of the race clock and lane units to
+    // the side of the path. Returns its index
+    int add(int path, float speed, float timeOffset = 0.0f, float lane = 0.0f);
+    // crowded grid for stress tests: count more opponents on the track paths,
+    // in rows of lanes rowGap meters ahead of each other
+    void addCrowd(int count, int lanes = 4, float laneWidth = 1.2f, float rowGap = 3.0f);
+
+    float pathLength(int path) const { return m_paths[path].length(); }
+
+    void update(float time);                        // moves every opponent to the race time
+    glm::mat4 modelAt(int opponent, float time) const; // model matrix at any time, for drawing between ticks
+
+    // indices of the opponents whose hitbox overlaps a sphere, in index order.
+    // Big pools only test the opponents in the grid cells around the sphere
+    void collide(const glm::vec4 &center, float radius, std::vector<int> &hits) const;
+    // the opponents for CollisionWorld::collideAll, valid until the next update
+    CarSpheres spheres() const;
+    // pairs of opponents closer than radius to each other at the last update,
+    // radius at most the grid cell (two hitboxes). Not part of update(), only
+    // callers that respond to opponent contacts pay for it
+    void touching(float radius, std::vector<CarPair> &pairs) const;
+
+    glm::vec4 position(int opponent) const { return glm::vec4(posX[opponent], posY[opponent], posZ[opponent], 1.0f); }
+    const glm::mat4 &model(int opponent) const { return models[opponent]; }
+
+    // configuration, indexed by opponent
+    std::vector<int> path;
+    std::vector<float> speed; // meters per second along the path
+    std::vector<float> timeOffset;
+    std::vector<float> lane;
+
+    // pose at the last update, indexed by opponent
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> forwardX, forwardZ;
+    std::vector<glm::mat4> models;
+
+private:
+    void pose(int opponent, float time, float &x, float &y, float &z, float &fx, float &fz) const;
+
+    const RaceTrack *m_track;
+    SpatialHash m_grid; // rebuilt by update()
+    mutable std::vector<int> m_candidates;
+    std::vector<ArcLengthTable> m_paths;
+};
+
+#endif // _OPPONENTPOOL_H
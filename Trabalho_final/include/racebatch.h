@@ -0,0 +1,66 @@
+#ifndef _RACEBATCH_H
+#define _RACEBATCH_H
+
+#include <vector>
+
+#include "racesim.h"
+#include "track.h"
+
+// many independent races stepped together. Same rules and the same float
+// operations as RaceSim, so each race of the batch ends exactly where a
+// RaceSim given the same inputs does (bench_batch_match checks it), but the
+// cars are kept as structure of arrays (one array per field, one entry per
+// race) so each step runs as tight loops over all races. The loops branch on
+// the inputs and call sin/cos and the swept move per car, so the compiler
+// doesn't vectorize them: the gain is the memory layout and the collision
+// queries of all cars in one collideAll call. All races start at the same
+// time, so the opponents (which only depend on time) and the track colliders
+// are shared read-only by every race of the batch.
+class RaceBatch
+{
+public:
+    // pool, if given, splits the collision queries of large batches across its threads
+    RaceBatch(const RaceTrack &track, int count, WorkStealingPool *pool = NULL);
+
+    int size() const { return m_count; }
+    void startAll();                                   // resets and starts every race
+    void step(const RaceInputs *inputs, float dt);     // inputs[size()], one per race
+    int running() const;                               // races still going
+    const CollisionHint &collisionHint(int race) const { return m_hints[race]; }
+
+    unsigned int tick; // steps since the start, shared by every race
+    float time;        // shared race clock, raceClock(tick, dt)
+
+    // per race state, indexed by race
+    std::vector<float> posX, posZ;
+    std::vector<float> forwardX, forwardZ;
+    std::vector<float> velocityX, velocityZ;
+    std::vector<float> accelerationX, accelerationZ;
+    std::vector<float> lateralX, lateralZ;
+    std::vector<float> boostpower;
+    std::vector<float> boostTime;
+    std::vector<float> stunTime;
+    std::vector<float> endTime; // time the race stopped
+    std::vector<unsigned char> raceStart, lost, checkpoint, finished;
+
+    // opponents are the same for every race
+    OpponentPool opponents;
+
+private:
+    void collideOpponents(int race, const Contact &contact);
+    void collideWalls(int race, const Contact &contact);
+    void collideCurves(int race, const Contact &contact);
+
+    const RaceTrack *m_track;
+    int m_count;
+    WorkStealingPool *m_pool;
+    std::vector<int> m_opponentHits;
+    std::vector<CollisionHint> m_hints; // one per race, for the curve queries
+
+    // input and output of CollisionWorld::collideAll, one per race
+    std::vector<CarState> m_cars;
+    std::vector<Contact> m_contacts;
+    std::vector<std::vector<int>> m_candidates; // collideAll scratch
+};
+
+#endif // _RACEBATCH_H
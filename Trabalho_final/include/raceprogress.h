@@ -0,0 +1,101 @@
+#ifndef _RACEPROGRESS_H
+#define _RACEPROGRESS_H
+
+#include <vector>
+
+#include "arclength.h"
+#include "spline.h"
+
+// seconds a car must face and move backwards to be going the wrong way
+static const float wrongWayDelay = 0.5f;
+
+// how far along the track a point is: the distance along the centerline of
+// the closest point on it. The centerline is turned into a polyline of evenly
+// spaced points (its arc-length table), and a uniform grid over the XZ plane
+// lists the polyline segments near each cell, so a query only measures a few
+// segments. Cars move little from one tick to the next, follow() only looks
+// at the segments around the last answer
+class TrackProgress
+{
+public:
+    TrackProgress();
+
+    // polyline points spacing meters apart at most, grid cells of cellSize
+    // meters listing the segments up to reach meters away
+    void build(const BezierSpline &centerline, float spacing = 1.0f, float cellSize = 8.0f, float reach = 12.0f);
+
+    float length() const { return m_length; }
+    bool closed() const { return m_closed; }
+
+    // distance along the centerline of the point closest to (x, z), in
+    // [0, length()]. Points farther than reach from it test every segment
+    float locate(float x, float z) const;
+    // the same for a point close to the one last found at distance hint,
+    // falls back to locate() when it moved beyond the segments around it
+    float follow(float x, float z, float hint) const;
+    // unit direction of the centerline at distance, in the XZ plane
+    void direction(float distance, float &fx, float &fz) const;
+
+private:
+    int segmentAt(float distance) const;
+    // closest point on the segments [first, last] (wrapped on a closed
+    // centerline), returns its squared distance and sets segment and along
+    float closest(float x, float z, int first, int last, int &segment, float &along) const;
+    // distance along the centerline of the point closest to (x, z) on segment
+    float distanceOn(int segment, float x, float z, float along) const;
+
+    std::vector<float> m_x, m_z;       // polyline points, one more than segments
+    std::vector<float> m_dirX, m_dirZ; // unit direction of each segment
+    std::vector<float> m_tangentX, m_tangentZ; // unit tangent of the curve at each point
+    std::vector<float> m_segmentLength;
+    float m_spacing, m_inverseSpacing;
+    float m_length;
+    bool m_closed;
+
+    // grid of the segments within reach of each cell
+    float m_originX, m_originZ, m_inverseCellSize;
+    int m_cellsX, m_cellsZ;
+    float m_reach;
+    std::vector<int> m_cellStart; // first entry of each cell in m_cellSegments, one extra at the end
+    std::vector<int> m_cellSegments;
+};
+
+// place of every car of a race, player and opponents alike, kept from one
+// tick to the next. Each car is followed along the track, counting laps when
+// it crosses the start of a closed centerline, and the order of the last tick
+// is repaired with an insertion sort, which only moves the cars that passed
+// someone. A car facing and moving backwards for wrongWayDelay is going the
+// wrong way
+class RaceRanking
+{
+public:
+    explicit RaceRanking(const TrackProgress &track);
+
+    void reset(int cars);
+    int size() const { return (int)m_order.size(); }
+
+    // puts a car on the track without history, e.g. on the starting grid.
+    // Cars just behind the start are on lap -1
+    void place(int car, float x, float z);
+    // moves a car to (x, z) facing (fx, fz) after dt seconds
+    void update(int car, float x, float z, float fx, float fz, float dt);
+    // sorts the cars after they were placed or updated
+    void rank();
+
+    float progress(int car) const { return m_progress[car]; } // laps plus fraction of the lap
+    int lap(int car) const { return m_lap[car]; }
+    bool wrongWay(int car) const { return m_wrongWayTime[car] >= wrongWayDelay; }
+    int position(int car) const { return m_position[car]; } // 0 for the leader
+    const std::vector<int> &order() const { return m_order; } // cars from the leader back
+
+private:
+    const TrackProgress *m_track;
+    std::vector<float> m_distance; // along the centerline, at the last update
+    std::vector<int> m_lap;
+    std::vector<float> m_progress;
+    std::vector<float> m_wrongWayTime;
+    std::vector<int> m_order;
+    std::vector<int> m_position;
+};
+
+#endif // _RACEPROGRESS_H
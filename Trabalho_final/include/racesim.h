@@ -0,0 +1,133 @@
+#ifndef _RACESIM_H
+#define _RACESIM_H
+
+#include <type_traits>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include "collisions.h"
+#include "opponentpool.h"
+#include "track.h"
+
+// default simulation rate, in ticks per second
+#define SIM_TICK_RATE 120.0f
+
+// physics constants of the player car
+static const float max_velocity = 20.0f;
+static const float friction = 0.7f;
+static const float playerHitboxRadius = 0.8f;
+static const float playerHalfExtent = 0.46f;
+static const float raceTimeLimit = 30.0f;
+
+// race time after tick steps of dt seconds. Derived from the step count, not
+// summed step by step: a float sum of 1/120 s falls seconds behind per hour
+inline float raceClock(unsigned int tick, float dt)
+{
+    return (float)(tick * (double)dt);
+}
+
+// state of the player controls for one simulation step
+struct RaceInputs
+{
+    bool forward;     // W
+    bool left;        // A
+    bool back;        // S
+    bool right;       // D
+    bool boost;       // space
+    bool strafeLeft;  // left mouse button
+    bool strafeRight; // right mouse button
+};
+
+// everything that changes during a race, plain data so it can be copied around
+struct RaceState
+{
+    unsigned int tick; // steps since the race started
+    float time;        // seconds since the race started, raceClock(tick, dt)
+
+    // player
+    glm::mat4 modelPlayer;
+    glm::vec4 carPos;
+    glm::vec4 carForward;
+    glm::vec4 current_velocity;
+    glm::vec4 acceleration;
+    glm::vec4 lateral_velocity;
+    bbox pBox;
+    float boostpower;
+    float boostTime;
+    float stunTime;
+    bool hasRotatedL;
+    bool hasRotatedR;
+
+    // race outcome
+    bool raceStart;
+    bool lost;
+    bool checkpoint;
+    bool finished;
+
+    // opponents only depend on time, RaceSim::opponents holds them
+};
+
+static_assert(std::is_trivially_copyable<RaceState>::value, "RaceState must stay plain data so snapshots are plain copies");
+
+// fixed size copy of a whole race, for rollback, search and "retry from
+// checkpoint". Saving and restoring are plain copies and never allocate
+struct RaceSnapshot
+{
+    unsigned int version; // RACE_SNAPSHOT_VERSION of the code that saved it
+    unsigned int size;    // sizeof(RaceState) of the code that saved it
+    RaceState state;
+};
+
+#define RACE_SNAPSHOT_VERSION 3
+
+// race physics, collisions, boost/stun, checkpoints and opponents without any
+// rendering, so it can run with or without a window
+class RaceSim
+{
+public:
+    explicit RaceSim(const RaceTrack &track);
+
+    void reset();                                    // back to the starting grid, race stopped
+    void start();                                    // reset and start the race
+    void step(const RaceInputs &inputs, float dt);   // advance the race by dt seconds
+
+    void save(RaceSnapshot &snapshot) const;
+    bool restore(const RaceSnapshot &snapshot);      // false if the snapshot came from an incompatible build
+    void syncOpponents();                            // moves the opponents to state.time if a restore left them behind
+
+    const RaceTrack &track() const { return *m_track; }
+    const CollisionHint &collisionHint() const { return m_hint; }
+
+    RaceState state;
+    OpponentPool opponents; // moved to state.time by every step, after restore() only by the next step() or syncOpponents()
+
+private:
+    const RaceTrack *m_track;
+    std::vector<int> m_opponentHits;
+    CollisionHint m_hint; // only speeds up the wall queries, not part of the state
+    bool m_opponentsStale; // opponents not moved to state.time since the last restore()
+};
+
+// fixed timestep: accumulates the real frame time and tells how many
+// simulation ticks of tickDt seconds must run this frame, so the race outcome
+// does not depend on the frame rate
+struct FixedTimestep
+{
+    explicit FixedTimestep(float tickRate = SIM_TICK_RATE, int maxTicksPerFrame = 16);
+
+    int advance(float frameDt); // number of ticks to run for this frame
+    float alpha() const;        // how far between the last two ticks the frame is, in [0, 1)
+    void reset();
+
+    float tickDt;
+    float accumulator;
+    int maxTicksPerFrame; // avoids spiraling when the simulation can't keep up
+};
+
+// model matrix between two ticks, alpha = 0 gives previous and 1 gives current.
+// Ticks are short, so blending the matrices element by element is enough
+glm::mat4 interpolateModel(const glm::mat4 &previous, const glm::mat4 &current, float alpha);
+
+#endif // _RACESIM_H
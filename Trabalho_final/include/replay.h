@@ -0,0 +1,127 @@
+#ifndef _REPLAY_H
+#define _REPLAY_H
+
+#include <cstdio>
+#include <vector>
+
+#include "racesim.h"
+
+// Replays store only the player inputs of each simulation tick. The race is
+// deterministic for a given tick rate, so playing the inputs back with the
+// same tick rate reproduces it bit by bit. To seek without simulating from
+// the start, a full RaceSnapshot keyframe is stored every keyframeInterval
+// ticks and indexed in a footer.
+//
+// File format (native byte order, RaceSnapshot stored as the struct; files
+// from a machine with the other byte order are rejected):
+//   "FZRP"               magic
+//   uint16 version       REPLAY_VERSION
+//   float  tickRate      ticks per second used when recording
+//   uint32 keyframeInterval   (version 2 and up, 0 = no keyframes)
+//   uint32 extraOpponents     (version 4 and up) ReplaySetup
+//   uint8  flags              (version 4 and up) 1: wall field
+//   version 3 has the layout of version 2, older replays were recorded with
+//   opponents moving on the bezier parameter and don't play back the same.
+//   Version 5 has the layout of version 4, older replays were recorded with
+//   the race clock summed tick by tick and the opponent paths measured by
+//   chords only, and may not play back the same
+//   records...
+//     varint n > 0, byte bits        n ticks with the same inputs
+//     varint 0, 'K', uint32 tick, RaceSnapshot
+//                                    race state before the given tick
+//     varint 0, 'E'                  end of the replay (version 1: only varint 0)
+//   index (version 2 and up)
+//     { uint32 tick, uint32 offset of the keyframe record } per keyframe
+//     uint32 keyframe count, uint32 index offset, "FZRI"
+#define REPLAY_VERSION 5
+#define REPLAY_KEYFRAME_INTERVAL 600
+
+// race options that change the simulation, stored in the header so the
+// replay is played back with the options it was recorded with
+struct ReplaySetup
+{
+    ReplaySetup();
+
+    unsigned int extraOpponents; // crowd added with OpponentPool::addCrowd
+    bool wallField;              // walls from the wall field of the track model
+};
+
+bool operator==(const ReplaySetup &a, const ReplaySetup &b);
+bool operator!=(const ReplaySetup &a, const ReplaySetup &b);
+
+// inputs as one byte, bit i is set when the i-th field of RaceInputs is
+unsigned char packInputs(const RaceInputs &inputs);
+RaceInputs unpackInputs(unsigned char bits);
+
+class ReplayWriter
+{
+public:
+    ReplayWriter();
+    ~ReplayWriter();
+
+    bool open(const char *filename, float tickRate, const ReplaySetup &setup = ReplaySetup(),
+              unsigned int keyframeInterval = REPLAY_KEYFRAME_INTERVAL);
+    void record(const RaceInputs &inputs);                     // inputs of the next tick, no keyframes
+    void record(const RaceInputs &inputs, const RaceSim &sim); // same, sim is the race before this tick
+    void close();
+    bool isOpen() const { return m_file != NULL; }
+    int ticks() const { return m_ticks; }
+
+private:
+    struct IndexEntry
+    {
+        unsigned int tick;
+        unsigned int offset;
+    };
+
+    void flushRun();
+
+    FILE *m_file;
+    int m_ticks;
+    unsigned char m_runBits;
+    unsigned int m_runLength;
+    unsigned int m_keyframeInterval;
+    std::vector<IndexEntry> m_index;
+};
+
+class ReplayReader
+{
+public:
+    ReplayReader();
+
+    bool open(const char *filename);
+    bool next(RaceInputs &inputs); // inputs of the next tick, false at the end
+    void rewind();
+    // puts sim in the state before the given tick, so the following next()
+    // returns the inputs of that tick. Restores the closest keyframe and
+    // simulates at most keyframeInterval ticks from it
+    bool seek(int tick, RaceSim &sim);
+
+    float tickRate() const { return m_tickRate; }
+    const ReplaySetup &setup() const { return m_setup; } // defaults for replays before version 4
+    int tick() const { return m_tick; } // ticks read so far
+    int keyframes() const { return (int)m_index.size(); }
+
+private:
+    struct IndexEntry
+    {
+        unsigned int tick;
+        unsigned int offset;
+    };
+
+    bool readIndex();
+
+    std::vector<unsigned char> m_data;
+    std::vector<IndexEntry> m_index;
+    unsigned short m_version;
+    size_t m_runsBegin;
+    size_t m_cursor;
+    float m_tickRate;
+    ReplaySetup m_setup;
+    int m_tick;
+    unsigned char m_runBits;
+    unsigned int m_runLeft;
+    bool m_ended;
+};
+
+#endif // _REPLAY_H
@@ -0,0 +1,39 @@
+#ifndef _ROLLOUT_H
+#define _ROLLOUT_H
+
+#include <random>
+#include <vector>
+
+#include "racesim.h"
+#include "threadpool.h"
+#include "track.h"
+
+// one race to simulate: either a recorded input script (one RaceInputs per
+// tick, the last one is held if the script ends before the race) or, when
+// script is NULL, the seeded pilot of seededInputs()
+struct RolloutSpec
+{
+    unsigned int seed;
+    const std::vector<RaceInputs> *script;
+};
+
+struct RolloutResult
+{
+    float finishTime; // race time when it stopped, or maxRaceTime
+    bool finished;
+    bool lost;
+    float boostpower;
+    int ticks;
+};
+
+// simple pilot: always accelerates, boosts when it can and steers/strafes at random
+RaceInputs seededInputs(std::mt19937 &rng, const RaceState &state);
+
+// simulates a single race until it stops or maxRaceTime seconds have passed
+RolloutResult runRollout(const RaceTrack &track, const RolloutSpec &spec, float dt, float maxRaceTime);
+
+// simulates every race in specs on the pool threads, results[i] is the result of specs[i]
+void runRollouts(const RaceTrack &track, const std::vector<RolloutSpec> &specs, std::vector<RolloutResult> &results,
+                 WorkStealingPool &pool, float dt = 1.0f / SIM_TICK_RATE, float maxRaceTime = 120.0f);
+
+#endif // _ROLLOUT_H
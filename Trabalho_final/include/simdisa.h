@@ -0,0 +1,31 @@
+#ifndef _SIMDISA_H
+#define _SIMDISA_H
+
+// x86 builds have SSE2 kernels; with GCC and Clang the AVX2 ones are compiled
+// for those functions only (SIMD_TARGET_AVX2), the rest of the program keeps
+// the default instruction set and runs on any x86 CPU
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define SIMD_X86 1
+#endif
+#if defined(SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_HAS_AVX2 1
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// instruction set used by the SIMD kernels (aabbkernel.h, bezierbatch.h), the
+// best one the CPU supports is picked before main runs. setSimdIsa may be
+// called while kernels run on other threads, they use either the old or the
+// new one
+enum SimdIsa
+{
+    SIMD_SCALAR,
+    SIMD_SSE2, // 4 floats per instruction
+    SIMD_AVX2  // 8 floats per instruction
+};
+
+SimdIsa simdIsa();
+bool simdIsaSupported(SimdIsa isa); // by the CPU and the build
+bool setSimdIsa(SimdIsa isa);        // false if not supported
+const char *simdIsaName(SimdIsa isa);
+
+#endif // _SIMDISA_H
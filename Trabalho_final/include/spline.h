@@ -0,0 +1,73 @@
+#ifndef _SPLINE_H
+#define _SPLINE_H
+
+#include <cmath>
+#include <vector>
+#include <glm/vec4.hpp>
+
+#include "bezier.h"
+
+// any number of cubic bezier segments, their control points stored one after
+// the other (4 per segment). A bezier time u runs over the whole spline: its
+// integer part is the segment, found by indexing, and the fraction is t in
+// it. A closed spline wraps u around so it can be run forever, an open one
+// is clamped to its ends
+class BezierSpline
+{
+public:
+    BezierSpline();
+
+    void clear();
+    void add(const glm::vec4 *points); // appends a segment, points[0..3]
+    void add(const std::vector<glm::vec4> &points) { add(&points[0]); }
+    // makes u wrap around, first joining the last point to the first with a
+    // straight segment when they differ
+    void close();
+
+    bool closed() const { return m_closed; }
+    int segments() const { return (int)m_curves.size(); }
+    const glm::vec4 *controlPoints(int segment) const { return &m_points[segment * 4]; }
+    const BezierPolynomial<3> &curve(int segment) const { return m_curves[segment]; }
+
+    // segment of bezier time u and t in it, the spline must have segments.
+    // u = 1 is the end of segment 0 like in opponentMovement(), an open
+    // spline clamps u to [0, segments()]
+    int segment(float u, float &t) const
+    {
+        int n = segments();
+        if (m_closed)
+        {
+            u -= std::floor(u / n) * n;
+        }
+        else
+        {
+            u = u < 0.0f ? 0.0f : (u > n ? (float)n : u);
+        }
+        int s = (int)std::ceil(u) - 1;
+        s = s < 0 ? 0 : (s >= n ? n - 1 : s);
+        t = u - s;
+        return s;
+    }
+
+    glm::vec4 point(float u) const
+    {
+        float t;
+        int s = segment(u, t);
+        return m_curves[s](t);
+    }
+
+    // derivative in u
+    glm::vec4 tangent(float u) const
+    {
+        float t;
+        int s = segment(u, t);
+        return m_curves[s].tangent(t);
+    }
+
+private:
+    std::vector<glm::vec4> m_points;
+    std::vector<BezierPolynomial<3>> m_curves;
+    bool m_closed;
+};
+
+#endif // _SPLINE_H
@@ -0,0 +1,57 @@
+#ifndef _THREADPOOL_H
+#define _THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// pool of worker threads with one task queue per worker. Each worker takes
+// tasks from the front of its own queue and, when it runs out, steals from
+// the back of the other queues, so tasks of uneven length don't leave
+// threads idle.
+class WorkStealingPool
+{
+public:
+    explicit WorkStealingPool(int threads = 0); // 0 = one per hardware thread
+    ~WorkStealingPool();
+
+    int threads() const { return (int)m_workers.size(); }
+
+    // runs task(index, worker) for every index in [0, count) and waits for all.
+    // Only one thread may hand work to the pool at a time (asserted). A run()
+    // from inside a task, on one of this pool's workers, runs the whole range
+    // inline on that worker, with the same worker index as the outer task.
+    void run(int count, const std::function<void(int, int)> &task);
+
+    long long steals() const { return m_steals; } // tasks taken from another worker, total
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<int> items;
+    };
+
+    void workerLoop(int worker);
+    bool popOrSteal(int worker, int &item);
+
+    std::vector<std::thread> m_workers;
+    std::vector<Queue *> m_queues;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const std::function<void(int, int)> *m_task;
+    unsigned int m_generation;
+    int m_busy;
+    bool m_stop;
+    std::atomic<int> m_remaining;
+    std::atomic<bool> m_running; // a run() from outside the pool is in progress
+    std::atomic<long long> m_steals;
+};
+
+#endif // _THREADPOOL_H
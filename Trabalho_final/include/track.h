@@ -0,0 +1,52 @@
+#ifndef _TRACK_H
+#define _TRACK_H
+
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include "collisions.h"
+#include "collisionworld.h"
+#include "raceprogress.h"
+#include "spline.h"
+#include "trackmesh.h"
+
+#define NUM_OPPONENTS 2
+
+// static description of the race track, built once and shared read-only by
+// every simulated race
+struct RaceTrack
+{
+    std::vector<bbox> straightsBBoxes;            // straight walls
+    std::vector<bbox> checkpoints;                // checkpoint (normal.x == 1) and finish line (normal.y == 1)
+    std::vector<std::vector<glm::vec4>> curveList; // curved walls, cubic bezier control points
+    CollisionWorld world;                          // walls, checkpoints and curves, rebuild after changing them
+    TrackMesh mesh;                                // wall triangles of the track model, empty until LoadTrackMesh()
+
+    // opponent paths: laps of six cubic bezier segments, ending on the
+    // starting grid, run at a constant speed
+    glm::vec4 opponentStart[NUM_OPPONENTS];
+    BezierSpline opponentPaths[NUM_OPPONENTS];
+    float opponentSpeed[NUM_OPPONENTS]; // meters per second
+
+    // middle of the road, between the two opponent paths, and the lap
+    // distance along it, for race progress and ranking
+    BezierSpline centerline;
+    TrackProgress progress; // rebuild after changing centerline
+};
+
+// fills the track with the walls, checkpoints and opponent paths of the race
+void BuildDefaultTrack(RaceTrack &track);
+
+// placement of data/Track.obj in the race, used to draw it and to collide with it
+glm::mat4 TrackModelMatrix();
+
+// fills track.mesh with the wall triangles of the track model
+bool LoadTrackMesh(RaceTrack &track, const char *filename);
+
+// makes the race collide with the walls of the track model through a wall
+// field, mapped from cacheFile or baked from meshFile (and cached) when the
+// cache is missing or out of date
+bool LoadWallField(RaceTrack &track, const char *meshFile, const char *cacheFile);
+
+#endif // _TRACK_H
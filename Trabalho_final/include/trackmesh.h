@@ -0,0 +1,68 @@
+#ifndef _TRACKMESH_H
+#define _TRACKMESH_H
+
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+// contact with the wall mesh
+struct MeshHit
+{
+    glm::vec4 point;  // on the triangle
+    glm::vec4 normal; // unit; sphere: from the point towards the center, ray: facing the ray origin
+    float distance;   // sphere: center to point, ray: along the direction
+    int triangle;
+};
+
+// wall triangles of the track model, generated when the model is loaded
+// instead of typed by hand. The triangles are stored in the leaf order of a
+// BVH built with the binned surface area heuristic, so a leaf is a run of
+// consecutive triangles and the tree needs no index array. Queries use a
+// fixed stack and never allocate
+class TrackMesh
+{
+public:
+    TrackMesh();
+
+    // reads an .obj, moves it by transform and keeps the triangles steeper
+    // than the floor, |normal.y| < maxNormalY, that rise above minTop; lower
+    // ones are steps between road pieces and curbs
+    bool load(const char *filename, const glm::mat4 &transform, float maxNormalY = 0.5f, float minTop = -1e30f);
+
+    // three vertices per triangle
+    void build(const std::vector<glm::vec4> &vertices);
+
+    // closest triangle point strictly within radius of center
+    bool sphere(const glm::vec4 &center, float radius, MeshHit &hit) const;
+
+    // first triangle hit by origin + direction * d, 0 <= d <= maxDistance;
+    // direction must be unit for distance to be in world units
+    bool ray(const glm::vec4 &origin, const glm::vec4 &direction, float maxDistance, MeshHit &hit) const;
+
+    int triangleCount() const { return (int)m_triangles.size(); }
+    int nodeCount() const { return (int)m_nodes.size(); }
+    int depth() const { return m_depth; }
+    void triangle(int index, glm::vec4 &a, glm::vec4 &b, glm::vec4 &c) const;
+    void bounds(glm::vec4 &min, glm::vec4 &max) const;
+
+private:
+    struct Node
+    {
+        float min[3];
+        float max[3];
+        int first; // leaf: first triangle, inner: index of the right child (left is the next node)
+        int count; // triangles in the leaf, 0 for inner nodes
+    };
+    struct Triangle
+    {
+        float a[3], b[3], c[3];
+    };
+
+    int buildNode(int first, int count, int depth, std::vector<float> &centers);
+
+    std::vector<Triangle> m_triangles;
+    std::vector<Node> m_nodes;
+    int m_depth;
+};
+
+#endif // _TRACKMESH_H
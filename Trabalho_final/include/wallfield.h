@@ -0,0 +1,66 @@
+#ifndef _WALLFIELD_H
+#define _WALLFIELD_H
+
+#include <vector>
+#include <glm/vec4.hpp>
+
+#include "mappedfile.h"
+#include "trackmesh.h"
+
+// Distance to the nearest wall over the XZ plane of the track, baked once
+// from the wall triangles into a grid and then read with one bilinear lookup
+// per car, whatever the number of walls. Negative inside a wall, clamped to
+// maxDistance far from them. The bake is cached in a file next to the mesh
+// and memory mapped, so only the first start pays for it.
+//
+// File format (native byte order, a cache from a machine with the other
+// byte order is baked again):
+//   "FZSD"               magic
+//   uint16 version       WALLFIELD_VERSION
+//   uint16 unused
+//   uint64 meshHash      FNV-1a of the .obj the field was baked from
+//   float  originX, originZ, cellSize, maxDistance
+//   int32  cellsX, cellsZ
+//   cellsX * cellsZ floats, row by row along X, sample (x, z) at
+//   (originX + x * cellSize, originZ + z * cellSize)
+#define WALLFIELD_VERSION 1
+
+class WallField
+{
+public:
+    WallField();
+
+    // bakes the walls of mesh, meshFile identifies the cache
+    bool bake(const TrackMesh &mesh, const char *meshFile, float cellSize = 0.125f, float maxDistance = 4.0f);
+    bool save(const char *filename) const;
+    // maps a cache saved by save(), false if missing or baked from another mesh
+    bool open(const char *filename, const char *meshFile);
+    void close();
+    bool isOpen() const { return m_samples != NULL; }
+
+    // wall distance at (point.x, point.z) and the unit direction away from the
+    // wall, zero far from the walls
+    float distance(const glm::vec4 &point, glm::vec4 &normal) const;
+
+    // first contact of a circle of radius moving from center by motion, by
+    // stepping the free distance along it; toi is the fraction of motion.
+    // A circle already touching a wall is not swept
+    bool sweep(const glm::vec4 &center, float radius, const glm::vec4 &motion, float &toi) const;
+
+    int cellsX() const { return m_cellsX; }
+    int cellsZ() const { return m_cellsZ; }
+    float cellSize() const { return m_cellSize; }
+
+private:
+    WallField(const WallField &);
+    WallField &operator=(const WallField &);
+
+    unsigned long long m_meshHash;
+    float m_originX, m_originZ, m_cellSize, m_maxDistance;
+    int m_cellsX, m_cellsZ;
+    const float *m_samples; // into m_file or m_baked
+    std::vector<float> m_baked;
+    MappedFile m_file;
+};
+
+#endif // _WALLFIELD_H
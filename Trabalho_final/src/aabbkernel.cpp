@@ -0,0 +1,242 @@
+#include <limits>
+
+#include "aabbkernel.h"
+
+#ifdef SIMD_X86
+#include <immintrin.h>
+#endif
+
+void AabbSoA::assign(const std::vector<bbox> &boxes)
+{
+    count = (int)boxes.size();
+    padded = (count + 7) / 8 * 8;
+    // padding boxes start after they end, nothing overlaps them
+    const float inf = std::numeric_limits<float>::infinity();
+    minX.assign(padded, inf);
+    minY.assign(padded, inf);
+    minZ.assign(padded, inf);
+    maxX.assign(padded, -inf);
+    maxY.assign(padded, -inf);
+    maxZ.assign(padded, -inf);
+    for (int i = 0; i < count; i++)
+    {
+        minX[i] = boxes[i].minPoint.x;
+        minY[i] = boxes[i].minPoint.y;
+        minZ[i] = boxes[i].minPoint.z;
+        maxX[i] = boxes[i].maxPoint.x;
+        maxY[i] = boxes[i].maxPoint.y;
+        maxZ[i] = boxes[i].maxPoint.z;
+    }
+}
+
+static int firstOverlapScalar(const AabbSoA &boxes, const float *carMin, const float *carMax)
+{
+    for (int i = 0; i < boxes.count; i++)
+    {
+        if (carMin[0] <= boxes.maxX[i] && carMax[0] >= boxes.minX[i] &&
+            carMin[1] <= boxes.maxY[i] && carMax[1] >= boxes.minY[i] &&
+            carMin[2] <= boxes.maxZ[i] && carMax[2] >= boxes.minZ[i])
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// car boxes given as arrays, one per coordinate
+struct CarBoxes
+{
+    const float *minX, *minY, *minZ;
+    const float *maxX, *maxY, *maxZ;
+};
+
+static void firstOverlapsScalar(const AabbSoA &boxes, const CarBoxes &cars, int first, int count, int *out)
+{
+    for (int i = first; i < first + count; i++)
+    {
+        float carMin[3] = {cars.minX[i], cars.minY[i], cars.minZ[i]};
+        float carMax[3] = {cars.maxX[i], cars.maxY[i], cars.maxZ[i]};
+        out[i] = firstOverlapScalar(boxes, carMin, carMax);
+    }
+}
+
+#ifdef SIMD_X86
+static int lowestBit(unsigned int mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(mask);
+#else
+    int bit = 0;
+    while (!(mask & 1))
+    {
+        mask >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+// records box for the lanes of mask that had no hit yet, returns the lanes
+// that have one now
+static int recordHits(int mask, int found, int box, int *out)
+{
+    int fresh = mask & ~found;
+    while (fresh)
+    {
+        out[lowestBit((unsigned int)fresh)] = box;
+        fresh &= fresh - 1;
+    }
+    return found | mask;
+}
+
+static int firstOverlapSse2(const AabbSoA &boxes, const float *carMin, const float *carMax)
+{
+    const __m128 cminX = _mm_set1_ps(carMin[0]), cmaxX = _mm_set1_ps(carMax[0]);
+    const __m128 cminY = _mm_set1_ps(carMin[1]), cmaxY = _mm_set1_ps(carMax[1]);
+    const __m128 cminZ = _mm_set1_ps(carMin[2]), cmaxZ = _mm_set1_ps(carMax[2]);
+    for (int i = 0; i < boxes.padded; i += 4)
+    {
+        __m128 hit = _mm_and_ps(_mm_cmple_ps(cminX, _mm_loadu_ps(&boxes.maxX[i])), _mm_cmpge_ps(cmaxX, _mm_loadu_ps(&boxes.minX[i])));
+        hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmple_ps(cminY, _mm_loadu_ps(&boxes.maxY[i])), _mm_cmpge_ps(cmaxY, _mm_loadu_ps(&boxes.minY[i]))));
+        hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmple_ps(cminZ, _mm_loadu_ps(&boxes.maxZ[i])), _mm_cmpge_ps(cmaxZ, _mm_loadu_ps(&boxes.minZ[i]))));
+        int mask = _mm_movemask_ps(hit);
+        if (mask)
+        {
+            return i + lowestBit((unsigned int)mask);
+        }
+    }
+    return -1;
+}
+
+// 4 cars per instruction: each box is compared with the boxes of 4 cars at
+// once, until all 4 found their first box
+static void firstOverlapsSse2(const AabbSoA &boxes, const CarBoxes &cars, int first, int count, int *out)
+{
+    int c = first;
+    for (; c + 4 <= first + count; c += 4)
+    {
+        const __m128 cminX = _mm_loadu_ps(cars.minX + c), cmaxX = _mm_loadu_ps(cars.maxX + c);
+        const __m128 cminY = _mm_loadu_ps(cars.minY + c), cmaxY = _mm_loadu_ps(cars.maxY + c);
+        const __m128 cminZ = _mm_loadu_ps(cars.minZ + c), cmaxZ = _mm_loadu_ps(cars.maxZ + c);
+        out[c] = out[c + 1] = out[c + 2] = out[c + 3] = -1;
+        int found = 0;
+        for (int i = 0; i < boxes.count && found != 0xf; i++)
+        {
+            __m128 hit = _mm_and_ps(_mm_cmple_ps(cminX, _mm_set1_ps(boxes.maxX[i])), _mm_cmpge_ps(cmaxX, _mm_set1_ps(boxes.minX[i])));
+            hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmple_ps(cminY, _mm_set1_ps(boxes.maxY[i])), _mm_cmpge_ps(cmaxY, _mm_set1_ps(boxes.minY[i]))));
+            hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmple_ps(cminZ, _mm_set1_ps(boxes.maxZ[i])), _mm_cmpge_ps(cmaxZ, _mm_set1_ps(boxes.minZ[i]))));
+            int mask = _mm_movemask_ps(hit);
+            if (mask)
+            {
+                found = recordHits(mask, found, i, out + c);
+            }
+        }
+    }
+    firstOverlapsScalar(boxes, cars, c, first + count - c, out);
+}
+#endif
+
+#ifdef SIMD_HAS_AVX2
+SIMD_TARGET_AVX2 static int firstOverlapAvx2(const AabbSoA &boxes, const float *carMin, const float *carMax)
+{
+    const __m256 cminX = _mm256_set1_ps(carMin[0]), cmaxX = _mm256_set1_ps(carMax[0]);
+    const __m256 cminY = _mm256_set1_ps(carMin[1]), cmaxY = _mm256_set1_ps(carMax[1]);
+    const __m256 cminZ = _mm256_set1_ps(carMin[2]), cmaxZ = _mm256_set1_ps(carMax[2]);
+    for (int i = 0; i < boxes.padded; i += 8)
+    {
+        __m256 hit = _mm256_and_ps(_mm256_cmp_ps(cminX, _mm256_loadu_ps(&boxes.maxX[i]), _CMP_LE_OQ),
+                                   _mm256_cmp_ps(cmaxX, _mm256_loadu_ps(&boxes.minX[i]), _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(cminY, _mm256_loadu_ps(&boxes.maxY[i]), _CMP_LE_OQ),
+                                               _mm256_cmp_ps(cmaxY, _mm256_loadu_ps(&boxes.minY[i]), _CMP_GE_OQ)));
+        hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(cminZ, _mm256_loadu_ps(&boxes.maxZ[i]), _CMP_LE_OQ),
+                                               _mm256_cmp_ps(cmaxZ, _mm256_loadu_ps(&boxes.minZ[i]), _CMP_GE_OQ)));
+        int mask = _mm256_movemask_ps(hit);
+        if (mask)
+        {
+            return i + lowestBit((unsigned int)mask);
+        }
+    }
+    return -1;
+}
+
+// the same as firstOverlapsSse2 with 8 cars per instruction
+SIMD_TARGET_AVX2 static void firstOverlapsAvx2(const AabbSoA &boxes, const CarBoxes &cars, int first, int count, int *out)
+{
+    int c = first;
+    for (; c + 8 <= first + count; c += 8)
+    {
+        const __m256 cminX = _mm256_loadu_ps(cars.minX + c), cmaxX = _mm256_loadu_ps(cars.maxX + c);
+        const __m256 cminY = _mm256_loadu_ps(cars.minY + c), cmaxY = _mm256_loadu_ps(cars.maxY + c);
+        const __m256 cminZ = _mm256_loadu_ps(cars.minZ + c), cmaxZ = _mm256_loadu_ps(cars.maxZ + c);
+        for (int k = 0; k < 8; k++)
+        {
+            out[c + k] = -1;
+        }
+        int found = 0;
+        for (int i = 0; i < boxes.count && found != 0xff; i++)
+        {
+            __m256 hit = _mm256_and_ps(_mm256_cmp_ps(cminX, _mm256_set1_ps(boxes.maxX[i]), _CMP_LE_OQ),
+                                       _mm256_cmp_ps(cmaxX, _mm256_set1_ps(boxes.minX[i]), _CMP_GE_OQ));
+            hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(cminY, _mm256_set1_ps(boxes.maxY[i]), _CMP_LE_OQ),
+                                                   _mm256_cmp_ps(cmaxY, _mm256_set1_ps(boxes.minY[i]), _CMP_GE_OQ)));
+            hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(cminZ, _mm256_set1_ps(boxes.maxZ[i]), _CMP_LE_OQ),
+                                                   _mm256_cmp_ps(cmaxZ, _mm256_set1_ps(boxes.minZ[i]), _CMP_GE_OQ)));
+            int mask = _mm256_movemask_ps(hit);
+            if (mask)
+            {
+                found = recordHits(mask, found, i, out + c);
+            }
+        }
+    }
+    // the last cars one by one with the AVX2 kernel: jumping to the SSE2 one
+    // from here skips the vzeroupper and slows every SSE instruction after it
+    for (; c < first + count; c++)
+    {
+        float carMin[3] = {cars.minX[c], cars.minY[c], cars.minZ[c]};
+        float carMax[3] = {cars.maxX[c], cars.maxY[c], cars.maxZ[c]};
+        out[c] = firstOverlapAvx2(boxes, carMin, carMax);
+    }
+}
+#endif
+
+typedef int (*FirstOverlapFn)(const AabbSoA &, const float *, const float *);
+typedef void (*FirstOverlapsFn)(const AabbSoA &, const CarBoxes &, int, int, int *);
+
+// the kernels of each instruction set, indexed by SimdIsa
+struct AabbKernels
+{
+    FirstOverlapFn one;
+    FirstOverlapsFn many;
+};
+
+static const AabbKernels kernels[] = {
+    {firstOverlapScalar, firstOverlapsScalar},
+#ifdef SIMD_X86
+    {firstOverlapSse2, firstOverlapsSse2},
+#else
+    {firstOverlapScalar, firstOverlapsScalar},
+#endif
+#ifdef SIMD_HAS_AVX2
+    {firstOverlapAvx2, firstOverlapsAvx2},
+#else
+    {firstOverlapScalar, firstOverlapsScalar},
+#endif
+};
+
+int firstOverlap(const AabbSoA &boxes, const float carMin[3], const float carMax[3])
+{
+    return kernels[simdIsa()].one(boxes, carMin, carMax);
+}
+
+void firstOverlaps(const AabbSoA &boxes, const float *carMinX, const float *carMinY, const float *carMinZ,
+                   const float *carMaxX, const float *carMaxY, const float *carMaxZ, int cars, int *out)
+{
+    CarBoxes carBoxes;
+    carBoxes.minX = carMinX;
+    carBoxes.minY = carMinY;
+    carBoxes.minZ = carMinZ;
+    carBoxes.maxX = carMaxX;
+    carBoxes.maxY = carMaxY;
+    carBoxes.maxZ = carMaxZ;
+    kernels[simdIsa()].many(boxes, carBoxes, 0, cars, out);
+}
@@ -0,0 +1,135 @@
+#include <cmath>
+#include <algorithm>
+
+#include "arclength.h"
+#include "bezierbatch.h"
+
+ArcLengthTable::ArcLengthTable()
+    : m_spacing(1.0f), m_inverseSpacing(1.0f), m_length(0.0f), m_inverseLength(0.0f)
+{
+}
+
+void ArcLengthTable::build(const BezierSpline &spline, float spacing, int samplesPerSegment)
+{
+    m_spline = spline;
+    m_parameter.clear();
+    m_segmentStart.assign(1, 0.0f);
+    m_spacing = spacing;
+    m_inverseSpacing = 1.0f / spacing;
+    m_length = 0.0f;
+    m_inverseLength = 0.0f;
+    const int segments = spline.segments();
+    if (segments <= 0)
+    {
+        m_parameter.assign(2, 0.0f);
+        return;
+    }
+
+    // length at every sample, summed in double so rounding does not add up
+    std::vector<float> t(samplesPerSegment + 1);
+    for (int i = 0; i <= samplesPerSegment; i++)
+    {
+        t[i] = (float)i / samplesPerSegment;
+    }
+    std::vector<float> x(t.size()), y(t.size()), z(t.size());
+    BezierSamples samples = {x.data(), y.data(), z.data(), NULL, NULL, NULL};
+    std::vector<double> lengths(1, 0.0);
+    std::vector<float> times(1, 0.0f);
+    for (int s = 0; s < segments; s++)
+    {
+        bezierSamples(BezierBatchCurve(spline.curve(s)), t.data(), (int)t.size(), samples);
+        // the chords are a little shorter than the curve, and the shortfall
+        // adds up lap after lap. It shrinks with the square of the chord, so
+        // comparing with every other sample (Richardson) removes most of it
+        double start = lengths.back(), chords = 0.0, doubleChords = 0.0;
+        for (int i = 1; i <= samplesPerSegment; i++)
+        {
+            double dx = x[i] - x[i - 1], dy = y[i] - y[i - 1], dz = z[i] - z[i - 1];
+            chords += std::sqrt(dx * dx + dy * dy + dz * dz);
+            lengths.push_back(start + chords);
+            times.push_back(s + t[i]);
+            if (i % 2 == 0)
+            {
+                double ex = x[i] - x[i - 2], ey = y[i] - y[i - 2], ez = z[i] - z[i - 2];
+                doubleChords += std::sqrt(ex * ex + ey * ey + ez * ez);
+            }
+        }
+        if (samplesPerSegment % 2 == 0 && chords > 0.0)
+        {
+            double scale = (chords + (chords - doubleChords) / 3.0) / chords;
+            for (int i = 1; i <= samplesPerSegment; i++)
+            {
+                double &length = lengths[lengths.size() - 1 - samplesPerSegment + i];
+                length = start + (length - start) * scale;
+            }
+        }
+        m_segmentStart.push_back((float)lengths.back());
+    }
+    m_length = (float)lengths.back();
+
+    // inverse of the samples, linear between them, at evenly spaced
+    // distances from the start to the end, spacing or a little less apart
+    int intervals = std::max((int)std::ceil(m_length / spacing), 1);
+    m_spacing = m_length > 0.0f ? m_length / intervals : spacing;
+    m_inverseSpacing = 1.0f / m_spacing;
+    m_inverseLength = m_length > 0.0f ? 1.0f / m_length : 0.0f;
+    m_parameter.resize(intervals + 1);
+    size_t k = 1;
+    for (int e = 0; e <= intervals; e++)
+    {
+        double d = lengths.back() * e / intervals;
+        while (k + 1 < lengths.size() && lengths[k] < d)
+        {
+            k++;
+        }
+        double span = lengths[k] - lengths[k - 1];
+        double a = span > 0.0 ? (d - lengths[k - 1]) / span : 0.0;
+        m_parameter[e] = (float)(times[k - 1] + a * (times[k] - times[k - 1]));
+    }
+}
+
+float ArcLengthTable::parameter(float distance) const
+{
+    float d = distance;
+    if (m_spline.closed())
+    {
+        // floor without the libm call, d is rarely negative
+        float laps = (float)(int)(d * m_inverseLength);
+        laps -= laps > d * m_inverseLength ? 1.0f : 0.0f;
+        d -= laps * m_length;
+    }
+    d = std::min(std::max(d, 0.0f), m_length);
+    float f = d * m_inverseSpacing;
+    int i = std::min((int)f, (int)m_parameter.size() - 2);
+    float a = f - i;
+    float u0 = m_parameter[i];
+    float u1 = m_parameter[i + 1];
+    // the speed of the bezier time jumps where segments meet, two entries
+    // around a join are interpolated on each side of it
+    int join = (int)u1;
+    if (join > u0 && join < u1)
+    {
+        float aj = m_segmentStart[join] * m_inverseSpacing - i;
+        if (a < aj)
+        {
+            return u0 + a / aj * (join - u0);
+        }
+        return join + (a - aj) / (1.0f - aj) * (u1 - join);
+    }
+    return u0 + a * (u1 - u0);
+}
+void ArcLengthTable::sample(float distance, glm::vec4 &point, glm::vec4 &tangent) const
+{
+    if (m_spline.segments() == 0)
+    {
+        point = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        tangent = glm::vec4(0.0f);
+        return;
+    }
+    // the segment is the integer part of the table, t = 1 only at the very end
+    float u = parameter(distance);
+    int segment = std::min((int)u, m_spline.segments() - 1);
+    float t = u - segment;
+    point = m_spline.curve(segment)(t);
+    tangent = m_spline.curve(segment).tangent(t);
+}
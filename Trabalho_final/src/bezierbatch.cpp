@@ -0,0 +1,139 @@
+#include "bezierbatch.h"
+
+#ifdef SIMD_X86
+#include <immintrin.h>
+#endif
+
+BezierBatchCurve::BezierBatchCurve(const BezierPolynomial<3> &curve)
+{
+    for (int axis = 0; axis < 3; axis++)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            p[axis][i] = curve.c[i][axis];
+        }
+        for (int i = 1; i < 4; i++)
+        {
+            d[axis][i - 1] = (float)i * curve.c[i][axis];
+        }
+    }
+}
+
+static void samplesScalar(const BezierBatchCurve &k, const float *t, int begin, int end, const BezierSamples &out)
+{
+    float *point[3] = {out.x, out.y, out.z};
+    float *tangent[3] = {out.dx, out.dy, out.dz};
+    for (int i = begin; i < end; i++)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const float *c = k.p[axis];
+            point[axis][i] = c[0] + t[i] * (c[1] + t[i] * (c[2] + t[i] * c[3]));
+            if (tangent[axis])
+            {
+                const float *d = k.d[axis];
+                tangent[axis][i] = d[0] + t[i] * (d[1] + t[i] * d[2]);
+            }
+        }
+    }
+}
+
+#ifdef SIMD_X86
+static int samplesSse2(const BezierBatchCurve &k, const float *t, int count, const BezierSamples &out)
+{
+    float *point[3] = {out.x, out.y, out.z};
+    float *tangent[3] = {out.dx, out.dy, out.dz};
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 s = _mm_loadu_ps(&t[i]);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const float *c = k.p[axis];
+            __m128 v = _mm_add_ps(_mm_set1_ps(c[2]), _mm_mul_ps(s, _mm_set1_ps(c[3])));
+            v = _mm_add_ps(_mm_set1_ps(c[1]), _mm_mul_ps(s, v));
+            v = _mm_add_ps(_mm_set1_ps(c[0]), _mm_mul_ps(s, v));
+            _mm_storeu_ps(&point[axis][i], v);
+            if (tangent[axis])
+            {
+                const float *d = k.d[axis];
+                __m128 w = _mm_add_ps(_mm_set1_ps(d[1]), _mm_mul_ps(s, _mm_set1_ps(d[2])));
+                w = _mm_add_ps(_mm_set1_ps(d[0]), _mm_mul_ps(s, w));
+                _mm_storeu_ps(&tangent[axis][i], w);
+            }
+        }
+    }
+    return i;
+}
+#endif
+
+#ifdef SIMD_HAS_AVX2
+SIMD_TARGET_AVX2 static int samplesAvx2(const BezierBatchCurve &k, const float *t, int count, const BezierSamples &out)
+{
+    float *point[3] = {out.x, out.y, out.z};
+    float *tangent[3] = {out.dx, out.dy, out.dz};
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 s = _mm256_loadu_ps(&t[i]);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const float *c = k.p[axis];
+            __m256 v = _mm256_add_ps(_mm256_set1_ps(c[2]), _mm256_mul_ps(s, _mm256_set1_ps(c[3])));
+            v = _mm256_add_ps(_mm256_set1_ps(c[1]), _mm256_mul_ps(s, v));
+            v = _mm256_add_ps(_mm256_set1_ps(c[0]), _mm256_mul_ps(s, v));
+            _mm256_storeu_ps(&point[axis][i], v);
+            if (tangent[axis])
+            {
+                const float *d = k.d[axis];
+                __m256 w = _mm256_add_ps(_mm256_set1_ps(d[1]), _mm256_mul_ps(s, _mm256_set1_ps(d[2])));
+                w = _mm256_add_ps(_mm256_set1_ps(d[0]), _mm256_mul_ps(s, w));
+                _mm256_storeu_ps(&tangent[axis][i], w);
+            }
+        }
+    }
+    // a last block of 4, in this function so it gets the VEX encoding and
+    // there is no switch between AVX and SSE instructions
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 s = _mm_loadu_ps(&t[i]);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const float *c = k.p[axis];
+            __m128 v = _mm_add_ps(_mm_set1_ps(c[2]), _mm_mul_ps(s, _mm_set1_ps(c[3])));
+            v = _mm_add_ps(_mm_set1_ps(c[1]), _mm_mul_ps(s, v));
+            v = _mm_add_ps(_mm_set1_ps(c[0]), _mm_mul_ps(s, v));
+            _mm_storeu_ps(&point[axis][i], v);
+            if (tangent[axis])
+            {
+                const float *d = k.d[axis];
+                __m128 w = _mm_add_ps(_mm_set1_ps(d[1]), _mm_mul_ps(s, _mm_set1_ps(d[2])));
+                w = _mm_add_ps(_mm_set1_ps(d[0]), _mm_mul_ps(s, w));
+                _mm_storeu_ps(&tangent[axis][i], w);
+            }
+        }
+    }
+    return i;
+}
+#endif
+
+void bezierSamples(const BezierBatchCurve &curve, const float *t, int count, const BezierSamples &out)
+{
+    int done = 0;
+    switch (simdIsa())
+    {
+#ifdef SIMD_HAS_AVX2
+    case SIMD_AVX2:
+        done = samplesAvx2(curve, t, count, out);
+        break;
+#endif
+#ifdef SIMD_X86
+    case SIMD_SSE2:
+        done = samplesSse2(curve, t, count, out);
+        break;
+#endif
+    default:
+        break;
+    }
+    samplesScalar(curve, t, done, count, out);
+}
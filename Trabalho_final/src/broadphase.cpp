@@ -0,0 +1,131 @@
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#include "broadphase.h"
+
+SpatialHash::SpatialHash(float cellSize)
+    : m_cellSize(cellSize), m_count(0), m_mask(0)
+{
+}
+
+unsigned int SpatialHash::bucket(int cellX, int cellZ) const
+{
+    return ((unsigned int)cellX * 73856093u ^ (unsigned int)cellZ * 19349663u) & m_mask;
+}
+
+void SpatialHash::build(const float *x, const float *z, int count)
+{
+    // about two buckets per car keeps most buckets with zero or one car
+    unsigned int tableSize = 64;
+    while (tableSize < (unsigned int)count * 2)
+    {
+        tableSize *= 2;
+    }
+    m_mask = tableSize - 1;
+    m_count = count;
+    m_bucketStart.assign(tableSize + 1, 0);
+    m_itemBucket.resize(count);
+    m_items.resize(count);
+    m_x.resize(count);
+    m_z.resize(count);
+
+    float inverse = 1.0f / m_cellSize;
+    for (int i = 0; i < count; i++)
+    {
+        unsigned int b = bucket((int)std::floor(x[i] * inverse), (int)std::floor(z[i] * inverse));
+        m_itemBucket[i] = b;
+        m_bucketStart[b + 1]++;
+    }
+    for (unsigned int b = 0; b < tableSize; b++)
+    {
+        m_bucketStart[b + 1] += m_bucketStart[b];
+    }
+    // m_bucketStart[b] is used as the insertion point of bucket b and ends at
+    // the start of bucket b + 1, so it is shifted back afterwards
+    for (int i = 0; i < count; i++)
+    {
+        unsigned int slot = m_bucketStart[m_itemBucket[i]]++;
+        m_items[slot] = i;
+        m_x[slot] = x[i];
+        m_z[slot] = z[i];
+    }
+    for (unsigned int b = tableSize; b > 0; b--)
+    {
+        m_bucketStart[b] = m_bucketStart[b - 1];
+    }
+    m_bucketStart[0] = 0;
+}
+
+int SpatialHash::neighbourBuckets(float x, float z, unsigned int *buckets) const
+{
+    float inverse = 1.0f / m_cellSize;
+    int cellX = (int)std::floor(x * inverse);
+    int cellZ = (int)std::floor(z * inverse);
+    int count = 0;
+    for (int dx = -1; dx <= 1; dx++)
+    {
+        for (int dz = -1; dz <= 1; dz++)
+        {
+            // different cells can share a bucket, it must be visited once
+            unsigned int b = bucket(cellX + dx, cellZ + dz);
+            if (std::find(buckets, buckets + count, b) == buckets + count)
+            {
+                buckets[count++] = b;
+            }
+        }
+    }
+    return count;
+}
+
+void SpatialHash::query(float x, float z, float radius, std::vector<int> &hits) const
+{
+    // only the 3 x 3 cells around (x, z) are looked at
+    assert(radius <= m_cellSize);
+    hits.clear();
+    if (m_count == 0)
+    {
+        return;
+    }
+    unsigned int buckets[9];
+    int bucketCount = neighbourBuckets(x, z, buckets);
+    for (int k = 0; k < bucketCount; k++)
+    {
+        for (unsigned int slot = m_bucketStart[buckets[k]]; slot < m_bucketStart[buckets[k] + 1]; slot++)
+        {
+            if (std::fabs(m_x[slot] - x) < radius && std::fabs(m_z[slot] - z) < radius)
+            {
+                hits.push_back(m_items[slot]);
+            }
+        }
+    }
+    std::sort(hits.begin(), hits.end());
+}
+
+void SpatialHash::pairs(float radius, std::vector<CarPair> &out) const
+{
+    assert(radius <= m_cellSize);
+    out.clear();
+    unsigned int buckets[9];
+    for (int slot = 0; slot < m_count; slot++)
+    {
+        int a = m_items[slot];
+        float x = m_x[slot];
+        float z = m_z[slot];
+        int bucketCount = neighbourBuckets(x, z, buckets);
+        for (int k = 0; k < bucketCount; k++)
+        {
+            for (unsigned int other = m_bucketStart[buckets[k]]; other < m_bucketStart[buckets[k] + 1]; other++)
+            {
+                int b = m_items[other];
+                if (b > a && std::fabs(m_x[other] - x) < radius && std::fabs(m_z[other] - z) < radius)
+                {
+                    CarPair pair;
+                    pair.a = a;
+                    pair.b = b;
+                    out.push_back(pair);
+                }
+            }
+        }
+    }
+}
@@ -1,17 +1,11 @@
 #include <glm/vec4.hpp>
 #include <vector>
 #include "matrices.h"
-#include "bezier.h"
+#include "bezierbatch.h"
+#include "collisions.h"
 glm::vec4 nullvector = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
 
-typedef struct bbox
-{
-    glm::vec4 minPoint;
-    glm::vec4 maxPoint;
-    glm::vec4 normal;
-} bbox;
-
-bool bbcollision(bbox bbox1, bbox bbox2)
+bool bbcollision(const bbox &bbox1, const bbox &bbox2)
 {
     return (
         bbox1.minPoint.x <= bbox2.maxPoint.x &&
@@ -22,13 +16,13 @@ bool bbcollision(bbox bbox1, bbox bbox2)
         bbox1.maxPoint.z >= bbox2.minPoint.z);
 }
 
-glm::vec4 checkAllbbox(bbox player, std::vector<bbox> list)
+glm::vec4 checkAllbbox(const bbox &player, const std::vector<bbox> &list)
 {
-    for (int i = 0; i < list.size(); i++)
+    for (size_t i = 0; i < list.size(); i++)
     {
-        if (bbcollision(player, list.at(i)))
+        if (bbcollision(player, list[i]))
         {
-            return list.at(i).normal;
+            return list[i].normal;
         }
     }
     return nullvector;
@@ -43,22 +37,36 @@ bool sphere_point(glm::vec4 hitbox1Center, float hitbox1Radius,glm::vec4 point){
     return norm(hitbox1Center-point)<hitbox1Radius;
 }
 
-glm::vec4 checkBezier(glm::vec4 hitbox1Center, float hitbox1Radius, std::vector<glm::vec4> controlPoints,float step)
+glm::vec4 checkBezier(glm::vec4 hitbox1Center, float hitbox1Radius, const std::vector<glm::vec4> &controlPoints,float step)
 {
-    for(float i = 0;i<=1;i+=step){
-        glm::vec4 point=Bezier(controlPoints,3,i);
-        if(sphere_point(hitbox1Center,hitbox1Radius,point)){
-            return point;
+    // the same parameters as before (0, step, 2 step... summed), evaluated 16 at a time
+    BezierBatchCurve curve((BezierPolynomial<3>(&controlPoints[0])));
+    float t[16], x[16], y[16], z[16];
+    BezierSamples samples = {x, y, z, NULL, NULL, NULL};
+    float i = 0;
+    while (i <= 1)
+    {
+        int count = 0;
+        for (; count < 16 && i <= 1; count++, i += step)
+        {
+            t[count] = i;
+        }
+        bezierSamples(curve, t, count, samples);
+        for (int j = 0; j < count; j++)
+        {
+            glm::vec4 point(x[j], y[j], z[j], 1.0f);
+            if(sphere_point(hitbox1Center,hitbox1Radius,point)){
+                return point;
+            }
         }
     }
     return nullvector;
 }
-glm::vec4 checkAllBezier(glm::vec4 hitbox1Center, float hitbox1Radius, std::vector<std::vector<glm::vec4>> bezierList,float step)
+glm::vec4 checkAllBezier(glm::vec4 hitbox1Center, float hitbox1Radius, const std::vector<std::vector<glm::vec4>> &bezierList,float step)
 {
-    for (int i = 0; i < bezierList.size(); i++)
-    {   
-       std::vector<glm::vec4> current=bezierList.at(i);
-       glm::vec4 point = checkBezier(hitbox1Center,hitbox1Radius,current,step);
+    for (size_t i = 0; i < bezierList.size(); i++)
+    {
+       glm::vec4 point = checkBezier(hitbox1Center,hitbox1Radius,bezierList[i],step);
        if(point!=nullvector){
         return point;
        }
@@ -0,0 +1,614 @@
+#include <algorithm>
+#include <cmath>
+
+#include "collisionworld.h"
+#include "threadpool.h"
+
+// leaves hold a few boxes, testing them is cheaper than going deeper
+static const int maxLeafSize = 4;
+// the query stack is fixed: below this depth nodes are split by the median,
+// which adds at most 32 more levels
+static const int maxSahDepth = 64;
+static const int stackSize = maxSahDepth + 40;
+
+static float surfaceArea(const float *min, const float *max)
+{
+    float dx = max[0] - min[0];
+    float dy = max[1] - min[1];
+    float dz = max[2] - min[2];
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+static bool boxOverlaps(const bbox &box, const float *min, const float *max)
+{
+    return box.minPoint.x <= max[0] && box.maxPoint.x >= min[0] &&
+           box.minPoint.y <= max[1] && box.maxPoint.y >= min[1] &&
+           box.minPoint.z <= max[2] && box.maxPoint.z >= min[2];
+}
+
+// cars per collideAll task, and the fewest cars worth splitting
+static const int collideChunk = 256;
+static const int collideParallelMin = 4 * collideChunk;
+
+// how far past the contact a swept car is left, so the next overlap test
+// finds it; far thinner than any wall
+static const float sweepSkin = 0.001f;
+
+// ray from origin along motion against the box [min - half, max + half]:
+// the motion fractions where it enters and leaves, false if it misses
+static bool slab(const float *origin, const float *motion, const float *half, const float *min, const float *max, float &enter, float &exit)
+{
+    enter = -1e30f;
+    exit = 1e30f;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        float low = min[axis] - half[axis];
+        float high = max[axis] + half[axis];
+        if (motion[axis] == 0)
+        {
+            if (origin[axis] < low || origin[axis] > high)
+            {
+                return false;
+            }
+            continue;
+        }
+        float t0 = (low - origin[axis]) / motion[axis];
+        float t1 = (high - origin[axis]) / motion[axis];
+        if (t0 > t1)
+        {
+            std::swap(t0, t1);
+        }
+        enter = std::max(enter, t0);
+        exit = std::min(exit, t1);
+    }
+    return enter <= exit;
+}
+
+CollisionHint::CollisionHint(float margin)
+    : margin(margin), queries(0), hits(0), tests(0)
+{
+    invalidate();
+}
+
+void CollisionHint::invalidate()
+{
+    boxMin[0] = boxMin[1] = boxMin[2] = 0;
+    boxMax[0] = boxMax[1] = boxMax[2] = 0;
+    boxCount = -1;
+    curveX = curveZ = curveRadius = 0;
+    segmentCount = -1;
+}
+
+CollideOptions::CollideOptions()
+    : halfExtent(0), radius(0), spheres(NULL), sphereReach(0), hints(NULL), pool(NULL), scratch(NULL)
+{
+}
+
+CollisionWorld::CollisionWorld()
+    : m_wallCount(0), m_depth(0)
+{
+}
+
+void CollisionWorld::build(const std::vector<bbox> &walls, const std::vector<bbox> &checkpoints,
+                           const std::vector<std::vector<glm::vec4>> &curves)
+{
+    m_curves.build(curves);
+    m_wallArrays.assign(walls);
+    m_checkArrays.assign(checkpoints);
+    m_boxes = walls;
+    m_boxes.insert(m_boxes.end(), checkpoints.begin(), checkpoints.end());
+    m_wallCount = (int)walls.size();
+    m_nodes.clear();
+    m_depth = 0;
+
+    const int count = (int)m_boxes.size();
+    m_order.resize(count);
+    std::vector<float> centers(count * 3);
+    for (int i = 0; i < count; i++)
+    {
+        m_order[i] = i;
+        centers[i * 3 + 0] = (m_boxes[i].minPoint.x + m_boxes[i].maxPoint.x) * 0.5f;
+        centers[i * 3 + 1] = (m_boxes[i].minPoint.y + m_boxes[i].maxPoint.y) * 0.5f;
+        centers[i * 3 + 2] = (m_boxes[i].minPoint.z + m_boxes[i].maxPoint.z) * 0.5f;
+    }
+    if (count > 0)
+    {
+        std::vector<float> leftArea(count);
+        m_nodes.reserve(count * 2);
+        buildNode(0, count, 0, centers, leftArea);
+    }
+}
+
+// builds the subtree of m_order[first, first + count) and returns its node
+int CollisionWorld::buildNode(int first, int count, int depth, std::vector<float> &centers, std::vector<float> &leftArea)
+{
+    int index = (int)m_nodes.size();
+    m_nodes.push_back(Node());
+    Node node;
+    node.min[0] = node.min[1] = node.min[2] = 1e30f;
+    node.max[0] = node.max[1] = node.max[2] = -1e30f;
+    for (int i = first; i < first + count; i++)
+    {
+        const bbox &b = m_boxes[m_order[i]];
+        node.min[0] = std::min(node.min[0], b.minPoint.x);
+        node.min[1] = std::min(node.min[1], b.minPoint.y);
+        node.min[2] = std::min(node.min[2], b.minPoint.z);
+        node.max[0] = std::max(node.max[0], b.maxPoint.x);
+        node.max[1] = std::max(node.max[1], b.maxPoint.y);
+        node.max[2] = std::max(node.max[2], b.maxPoint.z);
+    }
+    node.first = first;
+    node.count = count;
+
+    m_depth = std::max(m_depth, depth);
+
+    if (count <= 1)
+    {
+        m_nodes[index] = node;
+        return index;
+    }
+
+    // surface area heuristic: try every split between boxes sorted along
+    // each axis, cost = area(left) * boxes(left) + area(right) * boxes(right)
+    int bestAxis = -1;
+    int bestSplit = count / 2;
+    float bestCost = 1e30f;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        std::sort(m_order.begin() + first, m_order.begin() + first + count, [&](int a, int b)
+                  { return centers[a * 3 + axis] < centers[b * 3 + axis]; });
+        float min[3] = {1e30f, 1e30f, 1e30f};
+        float max[3] = {-1e30f, -1e30f, -1e30f};
+        for (int i = 0; i < count - 1; i++)
+        {
+            const bbox &b = m_boxes[m_order[first + i]];
+            min[0] = std::min(min[0], b.minPoint.x);
+            min[1] = std::min(min[1], b.minPoint.y);
+            min[2] = std::min(min[2], b.minPoint.z);
+            max[0] = std::max(max[0], b.maxPoint.x);
+            max[1] = std::max(max[1], b.maxPoint.y);
+            max[2] = std::max(max[2], b.maxPoint.z);
+            leftArea[i] = surfaceArea(min, max) * (i + 1);
+        }
+        min[0] = min[1] = min[2] = 1e30f;
+        max[0] = max[1] = max[2] = -1e30f;
+        for (int i = count - 1; i > 0; i--)
+        {
+            const bbox &b = m_boxes[m_order[first + i]];
+            min[0] = std::min(min[0], b.minPoint.x);
+            min[1] = std::min(min[1], b.minPoint.y);
+            min[2] = std::min(min[2], b.minPoint.z);
+            max[0] = std::max(max[0], b.maxPoint.x);
+            max[1] = std::max(max[1], b.maxPoint.y);
+            max[2] = std::max(max[2], b.maxPoint.z);
+            float cost = leftArea[i - 1] + surfaceArea(min, max) * (count - i);
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = i;
+            }
+        }
+    }
+
+    // a leaf costs testing all its boxes, a split one traversal step more
+    float leafCost = surfaceArea(node.min, node.max) * count;
+    if (count <= maxLeafSize && leafCost <= bestCost + surfaceArea(node.min, node.max))
+    {
+        m_nodes[index] = node;
+        return index;
+    }
+    if (depth >= maxSahDepth)
+    {
+        bestSplit = count / 2;
+    }
+    std::sort(m_order.begin() + first, m_order.begin() + first + count, [&](int a, int b)
+              { return centers[a * 3 + bestAxis] < centers[b * 3 + bestAxis]; });
+
+    buildNode(first, bestSplit, depth + 1, centers, leftArea);
+    node.first = buildNode(first + bestSplit, count - bestSplit, depth + 1, centers, leftArea);
+    node.count = 0;
+    m_nodes[index] = node;
+    return index;
+}
+
+int CollisionWorld::overlaps(const bbox &box, int *hits, int maxHits) const
+{
+    long long tests = 0;
+    return overlaps(box, hits, maxHits, tests);
+}
+
+int CollisionWorld::overlaps(const bbox &box, int *hits, int maxHits, long long &tests) const
+{
+    int found = 0;
+    if (m_nodes.empty())
+    {
+        return 0;
+    }
+    int stack[stackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Node &node = m_nodes[stack[--top]];
+        tests++;
+        if (!boxOverlaps(box, node.min, node.max))
+        {
+            continue;
+        }
+        if (node.count == 0)
+        {
+            stack[top++] = node.first;
+            stack[top++] = (int)(&node - &m_nodes[0]) + 1;
+            continue;
+        }
+        tests += node.count;
+        for (int i = node.first; i < node.first + node.count; i++)
+        {
+            if (bbcollision(box, m_boxes[m_order[i]]))
+            {
+                if (found < maxHits)
+                {
+                    hits[found] = m_order[i];
+                }
+                found++;
+            }
+        }
+    }
+    // list order, so callers see the same order as a linear scan
+    int written = std::min(found, maxHits);
+    for (int i = 1; i < written; i++)
+    {
+        int value = hits[i];
+        int j = i;
+        for (; j > 0 && hits[j - 1] > value; j--)
+        {
+            hits[j] = hits[j - 1];
+        }
+        hits[j] = value;
+    }
+    return found;
+}
+
+glm::vec4 CollisionWorld::firstNormal(const bbox &box, int begin, int end) const
+{
+    int first = end;
+    if (!m_nodes.empty())
+    {
+        int stack[stackSize];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            const Node &node = m_nodes[stack[--top]];
+            if (!boxOverlaps(box, node.min, node.max))
+            {
+                continue;
+            }
+            if (node.count == 0)
+            {
+                stack[top++] = node.first;
+                stack[top++] = (int)(&node - &m_nodes[0]) + 1;
+                continue;
+            }
+            for (int i = node.first; i < node.first + node.count; i++)
+            {
+                int b = m_order[i];
+                if (b >= begin && b < first && bbcollision(box, m_boxes[b]))
+                {
+                    first = b;
+                }
+            }
+        }
+    }
+    return first < end ? m_boxes[first].normal : glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+// walls and checkpoints gathered by the hint hold every box overlapping
+// [boxMin, boxMax]; while the query box stays inside it, the first of them
+// overlapping the query is the first in the whole list
+glm::vec4 CollisionWorld::firstNormal(const bbox &box, int begin, int end, CollisionHint &hint) const
+{
+    hint.queries++;
+    bool inside = hint.boxCount >= 0 &&
+                  box.minPoint.x >= hint.boxMin[0] && box.minPoint.y >= hint.boxMin[1] && box.minPoint.z >= hint.boxMin[2] &&
+                  box.maxPoint.x <= hint.boxMax[0] && box.maxPoint.y <= hint.boxMax[1] && box.maxPoint.z <= hint.boxMax[2];
+    if (inside)
+    {
+        hint.hits++;
+    }
+    else
+    {
+        bbox grown = box;
+        grown.minPoint -= glm::vec4(hint.margin, hint.margin, hint.margin, 0.0f);
+        grown.maxPoint += glm::vec4(hint.margin, hint.margin, hint.margin, 0.0f);
+        int found = overlaps(grown, hint.boxes, CollisionHint::maxBoxes, hint.tests);
+        if (found > CollisionHint::maxBoxes)
+        {
+            // too crowded to remember, search the whole tree
+            hint.boxCount = -1;
+            return firstNormal(box, begin, end);
+        }
+        hint.boxCount = found;
+        hint.boxMin[0] = grown.minPoint.x;
+        hint.boxMin[1] = grown.minPoint.y;
+        hint.boxMin[2] = grown.minPoint.z;
+        hint.boxMax[0] = grown.maxPoint.x;
+        hint.boxMax[1] = grown.maxPoint.y;
+        hint.boxMax[2] = grown.maxPoint.z;
+    }
+    for (int i = 0; i < hint.boxCount; i++)
+    {
+        int b = hint.boxes[i];
+        if (b < begin || b >= end)
+        {
+            continue;
+        }
+        hint.tests++;
+        if (bbcollision(box, m_boxes[b]))
+        {
+            return m_boxes[b].normal;
+        }
+    }
+    return glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+glm::vec4 CollisionWorld::wallNormal(const bbox &box) const
+{
+    if (m_field.isOpen())
+    {
+        glm::vec4 center = (box.minPoint + box.maxPoint) * 0.5f;
+        glm::vec4 normal;
+        float distance = m_field.distance(center, normal);
+        return distance < (box.maxPoint.x - box.minPoint.x) * 0.5f ? normal : glm::vec4(0.0f);
+    }
+    return firstNormal(box, 0, m_wallCount);
+}
+
+glm::vec4 CollisionWorld::checkpointNormal(const bbox &box) const
+{
+    return firstNormal(box, m_wallCount, (int)m_boxes.size());
+}
+
+glm::vec4 CollisionWorld::wallNormal(const bbox &box, CollisionHint &hint) const
+{
+    if (m_field.isOpen())
+    {
+        return wallNormal(box);
+    }
+    return firstNormal(box, 0, m_wallCount, hint);
+}
+
+glm::vec4 CollisionWorld::checkpointNormal(const bbox &box, CollisionHint &hint) const
+{
+    return firstNormal(box, m_wallCount, (int)m_boxes.size(), hint);
+}
+
+// a segment within radius + tolerance of center is within radius + tolerance
+// + margin of any point the car was at less than margin away; the slack
+// covers the rounding of the distances
+bool CollisionWorld::curveContact(const glm::vec4 &center, float radius, CurveHit &hit, CollisionHint &hint) const
+{
+    if (m_field.isOpen())
+    {
+        return false;
+    }
+    hint.queries++;
+    float dx = center.x - hint.curveX;
+    float dz = center.z - hint.curveZ;
+    if (hint.segmentCount >= 0 && radius == hint.curveRadius && dx * dx + dz * dz <= hint.margin * hint.margin)
+    {
+        hint.hits++;
+    }
+    else
+    {
+        int scanned;
+        float reach = radius + m_curves.tolerance() + hint.margin + 0.001f;
+        int found = m_curves.segmentsNear(center, reach, hint.segments, CollisionHint::maxSegments, scanned);
+        hint.tests += scanned;
+        if (found > CollisionHint::maxSegments)
+        {
+            hint.segmentCount = -1;
+            return m_curves.closest(center, radius, hit);
+        }
+        hint.segmentCount = found;
+        hint.curveX = center.x;
+        hint.curveZ = center.z;
+        hint.curveRadius = radius;
+    }
+    hint.tests += hint.segmentCount;
+    return m_curves.closest(center, radius, hit, hint.segments, hint.segmentCount);
+}
+
+bool CollisionWorld::sweepWalls(const bbox &box, const glm::vec4 &motion, float &toi, int &wall) const
+{
+    float origin[3] = {(box.minPoint.x + box.maxPoint.x) * 0.5f, (box.minPoint.y + box.maxPoint.y) * 0.5f, (box.minPoint.z + box.maxPoint.z) * 0.5f};
+    float half[3] = {(box.maxPoint.x - box.minPoint.x) * 0.5f, (box.maxPoint.y - box.minPoint.y) * 0.5f, (box.maxPoint.z - box.minPoint.z) * 0.5f};
+    float move[3] = {motion.x, motion.y, motion.z};
+    float best = 1.0f;
+    int first = -1;
+    if (!m_nodes.empty())
+    {
+        int stack[stackSize];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            const Node &node = m_nodes[stack[--top]];
+            float enter, exit;
+            if (!slab(origin, move, half, node.min, node.max, enter, exit) || enter > best || exit < 0)
+            {
+                continue;
+            }
+            if (node.count == 0)
+            {
+                stack[top++] = node.first;
+                stack[top++] = (int)(&node - &m_nodes[0]) + 1;
+                continue;
+            }
+            for (int i = node.first; i < node.first + node.count; i++)
+            {
+                int b = m_order[i];
+                if (b >= m_wallCount)
+                {
+                    continue;
+                }
+                float min[3] = {m_boxes[b].minPoint.x, m_boxes[b].minPoint.y, m_boxes[b].minPoint.z};
+                float max[3] = {m_boxes[b].maxPoint.x, m_boxes[b].maxPoint.y, m_boxes[b].maxPoint.z};
+                // enter < 0 is a wall the car already overlaps, the overlap
+                // test has dealt with it
+                if (slab(origin, move, half, min, max, enter, exit) && enter >= 0 &&
+                    (enter < best || (enter == best && (first < 0 || b < first))))
+                {
+                    best = enter;
+                    first = b;
+                }
+            }
+        }
+    }
+    if (first < 0)
+    {
+        return false;
+    }
+    toi = best;
+    wall = first;
+    return true;
+}
+
+float CollisionWorld::sweepFraction(const glm::vec4 &center, float halfExtent, float radius, const glm::vec4 &motion) const
+{
+    float length = std::sqrt(motion.x * motion.x + motion.y * motion.y + motion.z * motion.z);
+    if (length <= std::min(halfExtent, radius))
+    {
+        return 1.0f;
+    }
+    float fraction = 1.0f;
+    float toi;
+    if (m_field.isOpen())
+    {
+        if (m_field.sweep(center, halfExtent, motion, toi))
+        {
+            fraction = toi;
+        }
+        return std::min(fraction + sweepSkin / length, 1.0f);
+    }
+    bbox box;
+    box.minPoint = glm::vec4(center.x - halfExtent, center.y - halfExtent, center.z - halfExtent, center.w);
+    box.maxPoint = glm::vec4(center.x + halfExtent, center.y + halfExtent, center.z + halfExtent, center.w);
+    box.normal = glm::vec4(0.0f);
+    int wall;
+    if (sweepWalls(box, motion, toi, wall))
+    {
+        fraction = toi;
+    }
+    CurveHit hit;
+    if (m_curves.sweep(center, radius, motion * fraction, toi, hit))
+    {
+        fraction *= toi;
+    }
+    return std::min(fraction + sweepSkin / length, 1.0f);
+}
+
+void CollisionWorld::collideAll(const CarState *cars, size_t n, Contact *out, const CollideOptions &options) const
+{
+    std::vector<std::vector<int>> local;
+    std::vector<std::vector<int>> &candidates = options.scratch ? *options.scratch : local;
+    if (!options.pool || n < (size_t)collideParallelMin)
+    {
+        if (candidates.empty())
+        {
+            candidates.resize(1);
+        }
+        collideRange(cars, 0, n, out, options, candidates[0]);
+        return;
+    }
+    int chunks = (int)((n + collideChunk - 1) / collideChunk);
+    if (candidates.size() < (size_t)options.pool->threads())
+    {
+        candidates.resize(options.pool->threads());
+    }
+    options.pool->run(chunks, [&](int chunk, int worker) {
+        size_t begin = (size_t)chunk * collideChunk;
+        collideRange(cars, begin, std::min(begin + collideChunk, n), out, options, candidates[worker]);
+    });
+}
+
+void CollisionWorld::collideRange(const CarState *cars, size_t begin, size_t end, Contact *out, const CollideOptions &options, std::vector<int> &candidates) const
+{
+    const float h = options.halfExtent;
+    for (size_t first = begin; first < end; first += collideChunk)
+    {
+        int count = (int)std::min(end - first, (size_t)collideChunk);
+
+        // walls and checkpoints: the car boxes of the chunk through the box kernel
+        float minX[collideChunk], minY[collideChunk], minZ[collideChunk];
+        float maxX[collideChunk], maxY[collideChunk], maxZ[collideChunk];
+        int walls[collideChunk], checks[collideChunk];
+        for (int i = 0; i < count; i++)
+        {
+            const CarState &car = cars[first + i];
+            minX[i] = car.x - h;
+            minY[i] = -h;
+            minZ[i] = car.z - h;
+            maxX[i] = car.x + h;
+            maxY[i] = h;
+            maxZ[i] = car.z + h;
+        }
+        if (!m_field.isOpen())
+        {
+            firstOverlaps(m_wallArrays, minX, minY, minZ, maxX, maxY, maxZ, count, walls);
+        }
+        firstOverlaps(m_checkArrays, minX, minY, minZ, maxX, maxY, maxZ, count, checks);
+
+        for (int i = 0; i < count; i++)
+        {
+            size_t c = first + i;
+            Contact &contact = out[c];
+            glm::vec4 center(cars[c].x, 0.0f, cars[c].z, 1.0f);
+            if (m_field.isOpen())
+            {
+                bbox box;
+                box.minPoint = glm::vec4(minX[i], minY[i], minZ[i], 1.0f);
+                box.maxPoint = glm::vec4(maxX[i], maxY[i], maxZ[i], 1.0f);
+                contact.wallNormal = wallNormal(box);
+            }
+            else
+            {
+                contact.wallNormal = walls[i] >= 0 ? m_boxes[walls[i]].normal : glm::vec4(0.0f);
+            }
+            contact.checkpointNormal = checks[i] >= 0 ? m_boxes[m_wallCount + checks[i]].normal : glm::vec4(0.0f);
+            contact.curve = options.hints ? curveContact(center, options.radius, contact.curveHit, options.hints[c])
+                                          : curveContact(center, options.radius, contact.curveHit);
+
+            // spheres: same test as OpponentPool::collide
+            contact.carCount = 0;
+            const CarSpheres *spheres = options.spheres;
+            if (!spheres)
+            {
+                continue;
+            }
+            const float r2 = options.sphereReach * options.sphereReach;
+            int tested = spheres->count;
+            if (spheres->grid)
+            {
+                spheres->grid->query(center.x, center.z, options.sphereReach, candidates);
+                tested = (int)candidates.size();
+            }
+            for (int k = 0; k < tested; k++)
+            {
+                int o = spheres->grid ? candidates[k] : k;
+                float dx = center.x - spheres->x[o];
+                float dy = center.y - spheres->y[o];
+                float dz = center.z - spheres->z[o];
+                if (dx * dx + dy * dy + dz * dz < r2)
+                {
+                    if (contact.carCount < Contact::maxCars)
+                    {
+                        contact.cars[contact.carCount] = o;
+                    }
+                    contact.carCount++;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,382 @@
+#include <algorithm>
+#include <cmath>
+
+#include "curvecollider.h"
+
+// polyline segments are split at most this many times, 2^16 per curve
+static const int maxFlattenDepth = 16;
+// grid cells, the cell grows on very large tracks to keep the grid small
+static const float defaultCellSize = 4.0f;
+static const int maxCellsPerAxis = 512;
+static const int newtonIterations = 4;
+static const int sweepBisections = 10;
+
+static float segmentDistance2(float px, float pz, float ax, float az, float bx, float bz, float &s)
+{
+    float dx = bx - ax;
+    float dz = bz - az;
+    float length2 = dx * dx + dz * dz;
+    s = length2 > 0 ? ((px - ax) * dx + (pz - az) * dz) / length2 : 0.0f;
+    s = std::min(std::max(s, 0.0f), 1.0f);
+    float ex = ax + s * dx - px;
+    float ez = az + s * dz - pz;
+    return ex * ex + ez * ez;
+}
+
+CurveCollider::CurveCollider()
+    : m_tolerance(0.01f), m_originX(0), m_originZ(0), m_cellSize(defaultCellSize), m_cellsX(0), m_cellsZ(0)
+{
+}
+
+glm::vec4 CurveCollider::point(int curve, float t) const
+{
+    const Cubic &c = m_cubics[curve];
+    return glm::vec4(((c.x[3] * t + c.x[2]) * t + c.x[1]) * t + c.x[0], 0.0f,
+                     ((c.z[3] * t + c.z[2]) * t + c.z[1]) * t + c.z[0], 1.0f);
+}
+
+void CurveCollider::flatten(int curve, float t0, float t1, int depth)
+{
+    glm::vec4 a = point(curve, t0);
+    glm::vec4 b = point(curve, t1);
+    bool flat = depth >= maxFlattenDepth;
+    if (!flat && depth >= 2)
+    {
+        float s;
+        float worst = 0;
+        for (int i = 1; i < 4; i++)
+        {
+            glm::vec4 p = point(curve, t0 + (t1 - t0) * i * 0.25f);
+            worst = std::max(worst, segmentDistance2(p.x, p.z, a.x, a.z, b.x, b.z, s));
+        }
+        flat = worst <= m_tolerance * m_tolerance;
+    }
+    if (!flat)
+    {
+        float middle = (t0 + t1) * 0.5f;
+        flatten(curve, t0, middle, depth + 1);
+        flatten(curve, middle, t1, depth + 1);
+        return;
+    }
+    Segment segment;
+    segment.ax = a.x;
+    segment.az = a.z;
+    segment.bx = b.x;
+    segment.bz = b.z;
+    segment.t0 = t0;
+    segment.t1 = t1;
+    segment.curve = curve;
+    m_segments.push_back(segment);
+}
+
+void CurveCollider::cellRange(float min, float max, int cells, float origin, int &first, int &last) const
+{
+    first = std::max((int)std::floor((min - origin) / m_cellSize), 0);
+    last = std::min((int)std::floor((max - origin) / m_cellSize), cells - 1);
+}
+
+void CurveCollider::build(const std::vector<std::vector<glm::vec4>> &curves, float tolerance)
+{
+    m_tolerance = tolerance;
+    m_cubics.resize(curves.size());
+    m_segments.clear();
+    for (size_t i = 0; i < curves.size(); i++)
+    {
+        // degree 3, like Bezier(controlPoints, 3, t); a short list repeats its last point
+        glm::vec4 p[4];
+        for (int j = 0; j < 4; j++)
+        {
+            p[j] = curves[i].empty() ? glm::vec4(0.0f) : curves[i][std::min((size_t)j, curves[i].size() - 1)];
+        }
+        Cubic &c = m_cubics[i];
+        c.x[0] = p[0].x;
+        c.x[1] = 3 * (p[1].x - p[0].x);
+        c.x[2] = 3 * (p[0].x - 2 * p[1].x + p[2].x);
+        c.x[3] = -p[0].x + 3 * p[1].x - 3 * p[2].x + p[3].x;
+        c.z[0] = p[0].z;
+        c.z[1] = 3 * (p[1].z - p[0].z);
+        c.z[2] = 3 * (p[0].z - 2 * p[1].z + p[2].z);
+        c.z[3] = -p[0].z + 3 * p[1].z - 3 * p[2].z + p[3].z;
+        flatten((int)i, 0.0f, 1.0f, 0);
+    }
+
+    m_cellsX = m_cellsZ = 0;
+    m_cellStart.assign(1, 0);
+    m_cellItems.clear();
+    if (m_segments.empty())
+    {
+        return;
+    }
+    float minX = 1e30f, minZ = 1e30f, maxX = -1e30f, maxZ = -1e30f;
+    for (size_t i = 0; i < m_segments.size(); i++)
+    {
+        const Segment &s = m_segments[i];
+        minX = std::min(minX, std::min(s.ax, s.bx));
+        minZ = std::min(minZ, std::min(s.az, s.bz));
+        maxX = std::max(maxX, std::max(s.ax, s.bx));
+        maxZ = std::max(maxZ, std::max(s.az, s.bz));
+    }
+    m_cellSize = std::max(defaultCellSize, std::max(maxX - minX, maxZ - minZ) / maxCellsPerAxis);
+    m_originX = minX;
+    m_originZ = minZ;
+    m_cellsX = (int)((maxX - minX) / m_cellSize) + 1;
+    m_cellsZ = (int)((maxZ - minZ) / m_cellSize) + 1;
+
+    // counting sort of the segments into every cell their bounds touch
+    m_cellStart.assign(m_cellsX * m_cellsZ + 1, 0);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (size_t i = 0; i < m_segments.size(); i++)
+        {
+            const Segment &s = m_segments[i];
+            int x0, x1, z0, z1;
+            cellRange(std::min(s.ax, s.bx), std::max(s.ax, s.bx), m_cellsX, m_originX, x0, x1);
+            cellRange(std::min(s.az, s.bz), std::max(s.az, s.bz), m_cellsZ, m_originZ, z0, z1);
+            for (int z = z0; z <= z1; z++)
+            {
+                for (int x = x0; x <= x1; x++)
+                {
+                    int cell = z * m_cellsX + x;
+                    if (pass == 0)
+                    {
+                        m_cellStart[cell + 1]++;
+                    }
+                    else
+                    {
+                        m_cellItems[m_cellStart[cell]++] = (int)i;
+                    }
+                }
+            }
+        }
+        if (pass == 0)
+        {
+            for (int c = 0; c < m_cellsX * m_cellsZ; c++)
+            {
+                m_cellStart[c + 1] += m_cellStart[c];
+            }
+            m_cellItems.resize(m_cellStart.back());
+        }
+        else
+        {
+            // filling moved every start to the end of its cell
+            for (int c = m_cellsX * m_cellsZ; c > 0; c--)
+            {
+                m_cellStart[c] = m_cellStart[c - 1];
+            }
+            m_cellStart[0] = 0;
+        }
+    }
+}
+
+bool CurveCollider::closest(const glm::vec4 &center, float radius, CurveHit &hit) const
+{
+    if (m_segments.empty())
+    {
+        return false;
+    }
+    // the polyline is at most m_tolerance away from the curve
+    float reach = radius + m_tolerance;
+    int x0, x1, z0, z1;
+    cellRange(center.x - reach, center.x + reach, m_cellsX, m_originX, x0, x1);
+    cellRange(center.z - reach, center.z + reach, m_cellsZ, m_originZ, z0, z1);
+
+    int best = -1;
+    float bestDistance2 = reach * reach;
+    float bestS = 0;
+    for (int z = z0; z <= z1; z++)
+    {
+        for (int x = x0; x <= x1; x++)
+        {
+            int cell = z * m_cellsX + x;
+            for (int i = m_cellStart[cell]; i < m_cellStart[cell + 1]; i++)
+            {
+                const Segment &s = m_segments[m_cellItems[i]];
+                float along;
+                float distance2 = segmentDistance2(center.x, center.z, s.ax, s.az, s.bx, s.bz, along);
+                // a segment in several cells is met more than once, ties
+                // go to the lowest index so the order of the cells doesn't matter
+                if (distance2 < bestDistance2 || (distance2 == bestDistance2 && m_cellItems[i] < best))
+                {
+                    best = m_cellItems[i];
+                    bestDistance2 = distance2;
+                    bestS = along;
+                }
+            }
+        }
+    }
+    return best >= 0 && refine(best, bestS, center, radius, hit);
+}
+
+bool CurveCollider::closest(const glm::vec4 &center, float radius, CurveHit &hit, const int *segments, int count) const
+{
+    float reach = radius + m_tolerance;
+    int best = -1;
+    float bestDistance2 = reach * reach;
+    float bestS = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const Segment &s = m_segments[segments[i]];
+        float along;
+        float distance2 = segmentDistance2(center.x, center.z, s.ax, s.az, s.bx, s.bz, along);
+        if (distance2 < bestDistance2 || (distance2 == bestDistance2 && segments[i] < best))
+        {
+            best = segments[i];
+            bestDistance2 = distance2;
+            bestS = along;
+        }
+    }
+    return best >= 0 && refine(best, bestS, center, radius, hit);
+}
+
+int CurveCollider::segmentsNear(const glm::vec4 &center, float reach, int *segments, int maxSegments, int &scanned) const
+{
+    scanned = 0;
+    if (m_segments.empty())
+    {
+        return 0;
+    }
+    int x0, x1, z0, z1;
+    cellRange(center.x - reach, center.x + reach, m_cellsX, m_originX, x0, x1);
+    cellRange(center.z - reach, center.z + reach, m_cellsZ, m_originZ, z0, z1);
+
+    int found = 0;
+    for (int z = z0; z <= z1; z++)
+    {
+        for (int x = x0; x <= x1; x++)
+        {
+            int cell = z * m_cellsX + x;
+            for (int i = m_cellStart[cell]; i < m_cellStart[cell + 1]; i++)
+            {
+                scanned++;
+                int item = m_cellItems[i];
+                const Segment &s = m_segments[item];
+                float along;
+                if (!(segmentDistance2(center.x, center.z, s.ax, s.az, s.bx, s.bz, along) < reach * reach))
+                {
+                    continue;
+                }
+                // insertion in index order, skipping segments already found
+                // in another cell
+                int written = std::min(found, maxSegments);
+                int j = written;
+                while (j > 0 && segments[j - 1] > item)
+                {
+                    j--;
+                }
+                if (j > 0 && segments[j - 1] == item)
+                {
+                    continue;
+                }
+                found++;
+                if (j >= maxSegments)
+                {
+                    continue;
+                }
+                for (int k = std::min(written, maxSegments - 1); k > j; k--)
+                {
+                    segments[k] = segments[k - 1];
+                }
+                segments[j] = item;
+            }
+        }
+    }
+    return found;
+}
+
+// Newton on d/dt |B(t) - center|^2 = 0, starting from the polyline point
+bool CurveCollider::refine(int segment, float along, const glm::vec4 &center, float radius, CurveHit &hit) const
+{
+    const Segment &s = m_segments[segment];
+    const Cubic &c = m_cubics[s.curve];
+    float t = s.t0 + (s.t1 - s.t0) * along;
+    for (int i = 0; i < newtonIterations; i++)
+    {
+        float ex = ((c.x[3] * t + c.x[2]) * t + c.x[1]) * t + c.x[0] - center.x;
+        float ez = ((c.z[3] * t + c.z[2]) * t + c.z[1]) * t + c.z[0] - center.z;
+        float dx = (3 * c.x[3] * t + 2 * c.x[2]) * t + c.x[1];
+        float dz = (3 * c.z[3] * t + 2 * c.z[2]) * t + c.z[1];
+        float ddx = 6 * c.x[3] * t + 2 * c.x[2];
+        float ddz = 6 * c.z[3] * t + 2 * c.z[2];
+        float slope = ex * dx + ez * dz;
+        float curvature = dx * dx + dz * dz + ex * ddx + ez * ddz;
+        if (curvature <= 0)
+        {
+            break;
+        }
+        float next = std::min(std::max(t - slope / curvature, 0.0f), 1.0f);
+        bool done = std::fabs(next - t) < 1e-6f;
+        t = next;
+        if (done)
+        {
+            break;
+        }
+    }
+
+    glm::vec4 p = point(s.curve, t);
+    float nx = center.x - p.x;
+    float nz = center.z - p.z;
+    float distance = std::sqrt(nx * nx + nz * nz);
+    if (!(distance < radius))
+    {
+        return false;
+    }
+    if (distance > 0)
+    {
+        nx /= distance;
+        nz /= distance;
+    }
+    else
+    {
+        // center on the curve: any side will do, use the left of the tangent
+        float dx = (3 * c.x[3] * t + 2 * c.x[2]) * t + c.x[1];
+        float dz = (3 * c.z[3] * t + 2 * c.z[2]) * t + c.z[1];
+        float length = std::sqrt(dx * dx + dz * dz);
+        nx = length > 0 ? dz / length : 1.0f;
+        nz = length > 0 ? -dx / length : 0.0f;
+    }
+    hit.point = p;
+    hit.normal = glm::vec4(nx, 0.0f, nz, 0.0f);
+    hit.distance = distance;
+    hit.curve = s.curve;
+    hit.t = t;
+    return true;
+}
+
+bool CurveCollider::sweep(const glm::vec4 &center, float radius, const glm::vec4 &motion, float &toi, CurveHit &hit) const
+{
+    if (m_segments.empty() || radius <= 0 || closest(center, radius, hit))
+    {
+        return false;
+    }
+    float length = std::sqrt(motion.x * motion.x + motion.z * motion.z);
+    int steps = std::max((int)std::ceil(length / radius), 1);
+    float free = 0;
+    for (int i = 1; i <= steps; i++)
+    {
+        float t = (float)i / steps;
+        if (!closest(center + motion * t, radius, hit))
+        {
+            free = t;
+            continue;
+        }
+        // contact between the last free sample and this one
+        float touching = t;
+        CurveHit probe;
+        for (int j = 0; j < sweepBisections; j++)
+        {
+            float middle = (free + touching) * 0.5f;
+            if (closest(center + motion * middle, radius, probe))
+            {
+                touching = middle;
+                hit = probe;
+            }
+            else
+            {
+                free = middle;
+            }
+        }
+        toi = touching;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,146 @@
+#include <cstring>
+
+#include "ghost.h"
+
+static const char ghostMagic[4] = {'F', 'Z', 'G', 'H'};
+static const size_t ghostHeaderSize = 16;
+static const int ghostFrameFloats = 12;
+
+GhostWriter::GhostWriter()
+    : m_file(NULL), m_frames(0)
+{
+}
+
+GhostWriter::~GhostWriter()
+{
+    close();
+}
+
+bool GhostWriter::open(const char *filename, float tickRate)
+{
+    close();
+    m_file = fopen(filename, "wb");
+    if (!m_file)
+    {
+        fprintf(stderr, "ERROR: Cannot open ghost file \"%s\" for writing.\n", filename);
+        return false;
+    }
+    unsigned short version = GHOST_VERSION;
+    unsigned short unused = 0;
+    m_frames = 0;
+    fwrite(ghostMagic, 1, sizeof(ghostMagic), m_file);
+    fwrite(&version, sizeof(version), 1, m_file);
+    fwrite(&unused, sizeof(unused), 1, m_file);
+    fwrite(&tickRate, sizeof(tickRate), 1, m_file);
+    fwrite(&m_frames, sizeof(m_frames), 1, m_file); // written again by close()
+    return true;
+}
+
+void GhostWriter::record(const glm::mat4 &model)
+{
+    if (!m_file)
+    {
+        return;
+    }
+    float frame[ghostFrameFloats];
+    for (int column = 0; column < 4; column++)
+    {
+        frame[column * 3 + 0] = model[column][0];
+        frame[column * 3 + 1] = model[column][1];
+        frame[column * 3 + 2] = model[column][2];
+    }
+    fwrite(frame, sizeof(float), ghostFrameFloats, m_file);
+    m_frames++;
+}
+
+void GhostWriter::close()
+{
+    if (!m_file)
+    {
+        return;
+    }
+    fseek(m_file, ghostHeaderSize - sizeof(m_frames), SEEK_SET);
+    fwrite(&m_frames, sizeof(m_frames), 1, m_file);
+    fclose(m_file);
+    m_file = NULL;
+}
+
+GhostSet::GhostSet()
+    : m_count(0)
+{
+}
+
+bool GhostSet::add(const char *filename)
+{
+    if (m_count >= MAX_GHOSTS)
+    {
+        fprintf(stderr, "ERROR: Too many ghosts, at most %d are supported.\n", MAX_GHOSTS);
+        return false;
+    }
+    Ghost &ghost = m_ghosts[m_count];
+    if (!ghost.file.open(filename))
+    {
+        return false;
+    }
+    const unsigned char *data = ghost.file.data();
+    unsigned short version = 0;
+    if (ghost.file.size() >= ghostHeaderSize && memcmp(data, ghostMagic, sizeof(ghostMagic)) == 0)
+    {
+        memcpy(&version, data + 4, sizeof(version));
+    }
+    if (byteSwap16(version) == GHOST_VERSION)
+    {
+        fprintf(stderr, "ERROR: Ghost \"%s\" was recorded on a machine with the other byte order.\n", filename);
+        ghost.file.close();
+        return false;
+    }
+    if (version != GHOST_VERSION)
+    {
+        fprintf(stderr, "ERROR: \"%s\" is not a ghost file of version %d.\n", filename, GHOST_VERSION);
+        ghost.file.close();
+        return false;
+    }
+    memcpy(&ghost.tickRate, data + 8, sizeof(ghost.tickRate));
+    memcpy(&ghost.frameCount, data + 12, sizeof(ghost.frameCount));
+    if (ghost.frameCount == 0 || ghost.tickRate <= 0.0f ||
+        ghost.file.size() < ghostHeaderSize + (size_t)ghost.frameCount * ghostFrameFloats * sizeof(float))
+    {
+        fprintf(stderr, "ERROR: Ghost file \"%s\" is truncated.\n", filename);
+        ghost.file.close();
+        return false;
+    }
+    // the mapping is page aligned and the header is 16 bytes, so the frames
+    // can be read as floats in place
+    ghost.frames = (const float *)(data + ghostHeaderSize);
+    m_models[m_count] = glm::mat4(1.0f);
+    m_count++;
+    return true;
+}
+
+void GhostSet::update(float time)
+{
+    for (int i = 0; i < m_count; i++)
+    {
+        const Ghost &ghost = m_ghosts[i];
+        float frame = time > 0.0f ? time * ghost.tickRate : 0.0f;
+        unsigned int first = (unsigned int)frame;
+        float alpha = frame - (float)first;
+        if (first >= ghost.frameCount - 1)
+        {
+            // the ghost finished its race and stays at its last position
+            first = ghost.frameCount - 1;
+            alpha = 0.0f;
+        }
+        const float *a = ghost.frames + (size_t)first * ghostFrameFloats;
+        const float *b = alpha > 0.0f ? a + ghostFrameFloats : a;
+
+        glm::mat4 &model = m_models[i];
+        for (int column = 0; column < 4; column++)
+        {
+            model[column][0] = a[column * 3 + 0] + (b[column * 3 + 0] - a[column * 3 + 0]) * alpha;
+            model[column][1] = a[column * 3 + 1] + (b[column * 3 + 1] - a[column * 3 + 1]) * alpha;
+            model[column][2] = a[column * 3 + 2] + (b[column * 3 + 2] - a[column * 3 + 2]) * alpha;
+            model[column][3] = column == 3 ? 1.0f : 0.0f;
+        }
+    }
+}
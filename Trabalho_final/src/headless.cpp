@@ -0,0 +1,197 @@
+// Simulador de corridas sem janela nem contexto OpenGL. Roda corridas com
+// controles gerados a partir de uma semente, em todos os nucleos da CPU, e
+// imprime o resultado de cada corrida e a vazao total.
+//
+//   ./headless [corridas] [semente] [threads]
+//   ./headless --record arquivo [semente]   grava o replay de uma corrida
+//   ./headless --replay arquivo             reproduz um replay
+//   ./headless --seek arquivo tick          estado da corrida no tick dado
+//   ./headless --ghost replay fantasma      converte um replay em fantasma
+//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+
+#include "ghost.h"
+#include "replay.h"
+#include "rollout.h"
+
+// estado final em hexadecimal, para comparar corridas bit a bit
+static void printFinalState(const RaceState &state, int ticks)
+{
+    printf("ticks %d time %a pos (%a, %a) velocity (%a, %a) boostpower %a finished %d lost %d\n",
+           ticks, state.time, state.carPos.x, state.carPos.z, state.current_velocity.x, state.current_velocity.z,
+           state.boostpower, state.finished, state.lost);
+}
+
+// prepara a pista e a corrida com as opcoes com que o replay foi gravado
+static bool setupReplay(RaceTrack &track, RaceSim &sim, const ReplaySetup &setup)
+{
+    if (setup.wallField && !LoadWallField(track, "data/Track.obj", "data/Track.sdf"))
+    {
+        return false;
+    }
+    sim.opponents.addCrowd((int)setup.extraOpponents);
+    return true;
+}
+
+static int recordRace(const RaceTrack &track, const char *filename, unsigned int seed)
+{
+    ReplayWriter writer;
+    if (!writer.open(filename, SIM_TICK_RATE))
+    {
+        return EXIT_FAILURE;
+    }
+    RaceSim sim(track);
+    sim.start();
+    std::mt19937 rng(seed);
+    while (sim.state.raceStart && sim.state.time < 120.0f)
+    {
+        RaceInputs inputs = seededInputs(rng, sim.state);
+        writer.record(inputs, sim);
+        sim.step(inputs, 1.0f / SIM_TICK_RATE);
+    }
+    int ticks = writer.ticks();
+    writer.close();
+    printFinalState(sim.state, ticks);
+    return EXIT_SUCCESS;
+}
+
+static int playReplay(RaceTrack &track, const char *filename)
+{
+    ReplayReader reader;
+    if (!reader.open(filename))
+    {
+        return EXIT_FAILURE;
+    }
+    RaceSim sim(track);
+    if (!setupReplay(track, sim, reader.setup()))
+    {
+        return EXIT_FAILURE;
+    }
+    sim.start();
+    float dt = 1.0f / reader.tickRate();
+    RaceInputs inputs;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    while (reader.next(inputs))
+    {
+        sim.step(inputs, dt);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    printFinalState(sim.state, reader.tick());
+    printf("played %.1f s of race in %.3f s\n", sim.state.time, seconds);
+    return EXIT_SUCCESS;
+}
+
+static int seekReplay(RaceTrack &track, const char *filename, int tick)
+{
+    ReplayReader reader;
+    if (!reader.open(filename))
+    {
+        return EXIT_FAILURE;
+    }
+    RaceSim sim(track);
+    if (!setupReplay(track, sim, reader.setup()))
+    {
+        return EXIT_FAILURE;
+    }
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    if (!reader.seek(tick, sim))
+    {
+        fprintf(stderr, "ERROR: Replay \"%s\" ends before tick %d.\n", filename, tick);
+        return EXIT_FAILURE;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    printFinalState(sim.state, reader.tick());
+    printf("seek to tick %d in %.3f ms (%d keyframes)\n", tick, seconds * 1000.0, reader.keyframes());
+    return EXIT_SUCCESS;
+}
+
+static int exportGhost(RaceTrack &track, const char *replayFile, const char *ghostFile)
+{
+    ReplayReader reader;
+    GhostWriter writer;
+    if (!reader.open(replayFile) || !writer.open(ghostFile, reader.tickRate()))
+    {
+        return EXIT_FAILURE;
+    }
+    RaceSim sim(track);
+    if (!setupReplay(track, sim, reader.setup()))
+    {
+        return EXIT_FAILURE;
+    }
+    sim.start();
+    float dt = 1.0f / reader.tickRate();
+    RaceInputs inputs;
+    writer.record(sim.state.modelPlayer);
+    while (reader.next(inputs))
+    {
+        sim.step(inputs, dt);
+        writer.record(sim.state.modelPlayer);
+    }
+    printf("%d ghost frames written to %s\n", writer.frames(), ghostFile);
+    writer.close();
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 2 && (strcmp(argv[1], "--record") == 0 || strcmp(argv[1], "--replay") == 0 || strcmp(argv[1], "--seek") == 0 ||
+                     strcmp(argv[1], "--ghost") == 0))
+    {
+        RaceTrack track;
+        BuildDefaultTrack(track);
+        if (strcmp(argv[1], "--record") == 0)
+        {
+            return recordRace(track, argv[2], argc > 3 ? (unsigned int)atoi(argv[3]) : 1);
+        }
+        if (strcmp(argv[1], "--ghost") == 0)
+        {
+            return argc > 3 ? exportGhost(track, argv[2], argv[3]) : EXIT_FAILURE;
+        }
+        if (strcmp(argv[1], "--seek") == 0)
+        {
+            return seekReplay(track, argv[2], argc > 3 ? atoi(argv[3]) : 0);
+        }
+        return playReplay(track, argv[2]);
+    }
+
+    int races = argc > 1 ? atoi(argv[1]) : 100;
+    unsigned int seed = argc > 2 ? (unsigned int)atoi(argv[2]) : 1;
+    int threads = argc > 3 ? atoi(argv[3]) : 0;
+
+    RaceTrack track;
+    BuildDefaultTrack(track);
+    WorkStealingPool pool(threads);
+
+    std::vector<RolloutSpec> specs(races);
+    for (int race = 0; race < races; race++)
+    {
+        specs[race].seed = seed + race;
+        specs[race].script = NULL;
+    }
+    std::vector<RolloutResult> results;
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    runRollouts(track, specs, results, pool);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    long long totalSteps = 0;
+    int won = 0;
+    for (int race = 0; race < races; race++)
+    {
+        const RolloutResult &r = results[race];
+        totalSteps += r.ticks;
+        if (r.finished && !r.lost)
+        {
+            won++;
+        }
+        printf("race %d: time %.3f finished %d lost %d boostpower %.1f\n", race, r.finishTime, r.finished, r.lost, r.boostpower);
+    }
+
+    printf("%d races (%d won, %d lost), %lld steps in %.3f s on %d threads\n", races, won, races - won, totalSteps, seconds, pool.threads());
+    printf("%.0f steps/s, %.1f races/s\n", totalSteps / seconds, races / seconds);
+    return 0;
+}
@@ -18,6 +18,7 @@
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 // Headers abaixo são específicos de C++
 #include <map>
@@ -47,8 +48,10 @@
 // Headers locais, definidos na pasta "include/"
 #include "utils.h"
 #include "matrices.h"
-#include "bezier.h"
-#include "opponent.h"
+#include "collisions.h"
+#include "racesim.h"
+#include "replay.h"
+#include "ghost.h"
 #define PI 3.14159265358979323846
 // Estrutura que representa um modelo geométrico carregado a partir de um
 // arquivo ".obj". Veja https://en.wikipedia.org/wiki/Wavefront_.obj_file .
@@ -99,16 +102,10 @@ void TextRendering_Init();
 float TextRendering_LineHeight(GLFWwindow *window);
 float TextRendering_CharWidth(GLFWwindow *window);
 void TextRendering_PrintString(GLFWwindow *window, const std::string &str, float x, float y, float scale = 1.0f);
-bool spheres_collision(glm::vec4 hitbox1Center, float hitbox1Radius, glm::vec4 hitbox2Center, float hitbox2Radius);
-glm::vec4 checkAllBezier(glm::vec4 hitbox1Center, float hitbox1Radius, std::vector<std::vector<glm::vec4>> bezierList, float step);
-typedef struct bbox
-{
-    glm::vec4 minPoint;
-    glm::vec4 maxPoint;
-    glm::vec4 normal;
-} bbox;
-glm::vec4 checkAllbbox(bbox player, std::vector<bbox> list);
 void printBoost(float power, float pad, GLFWwindow *window);
+void printPlace(const RaceRanking &ranking, float pad, GLFWwindow *window);
+void PlaceCars(RaceRanking &ranking, const RaceSim &sim);         // Coloca o player e os oponentes na classificação, sem histórico
+void RankCars(RaceRanking &ranking, const RaceSim &sim, float dt); // Atualiza a classificação depois de um tick
 
 // Funções callback para comunicação com o sistema operacional e interação do
 // usuário. Veja mais comentários nas definições das mesmas, abaixo.
@@ -158,8 +155,6 @@ bool dPressed = false;
 bool ctrlPressed = false;
 bool spacePressed = false;
 bool startPressed = false;
-bool hasRotatedL = false;
-bool hasRotatedR = false;
 // Variáveis que definem a câmera em coordenadas esféricas, controladas pelo
 // usuário através do mouse (veja função CursorPosCallback()). A posição
 // efetiva da câmera é calculada dentro da função main(), dentro do loop de
@@ -294,10 +289,65 @@ int main(int argc, char *argv[])
     ComputeNormals(&startmodel);
     BuildTrianglesAndAddToVirtualScene(&startmodel);
 
-    if (argc > 1)
+    // "--tickrate N" muda a frequencia da simulacao, "--record arquivo" grava
+    // os controles de cada corrida e "--replay arquivo" reproduz uma corrida
+    // gravada no lugar do teclado e mouse. "--ghost arquivo" (pode repetir)
+    // adiciona um fantasma e "--record-ghost arquivo" grava a corrida como
+    // fantasma. "--opponents N" coloca N oponentes a mais na pista, para
+    // testes de carga. "--wall-field" colide com as paredes do Track.obj em
+    // vez das caixas e curvas digitadas; as duas opcoes ficam gravadas no
+    // replay. Qualquer outro argumento é um modelo .obj extra a ser carregado
+    float tickRate = SIM_TICK_RATE;
+    ReplaySetup setup;
+    const char *recordFile = NULL;
+    const char *ghostFile = NULL;
+    ReplayWriter recorder;
+    GhostWriter ghostRecorder;
+    GhostSet ghosts;
+    ReplayReader replay;
+    bool replaying = false;
+    for (int i = 1; i < argc; i++)
     {
-        ObjModel model(argv[1]);
-        BuildTrianglesAndAddToVirtualScene(&model);
+        if (strcmp(argv[i], "--tickrate") == 0 && i + 1 < argc)
+        {
+            tickRate = (float)atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            recordFile = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+        {
+            if (!replay.open(argv[++i]))
+            {
+                std::exit(EXIT_FAILURE);
+            }
+            replaying = true;
+        }
+        else if (strcmp(argv[i], "--ghost") == 0 && i + 1 < argc)
+        {
+            if (!ghosts.add(argv[++i]))
+            {
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[i], "--record-ghost") == 0 && i + 1 < argc)
+        {
+            ghostFile = argv[++i];
+        }
+        else if (strcmp(argv[i], "--opponents") == 0 && i + 1 < argc)
+        {
+            setup.extraOpponents = (unsigned int)std::max(atoi(argv[++i]), 0);
+        }
+        else if (strcmp(argv[i], "--wall-field") == 0)
+        {
+            setup.wallField = true;
+        }
+        else
+        {
+            ObjModel model(argv[i]);
+            BuildTrianglesAndAddToVirtualScene(&model);
+        }
     }
 
     TextRendering_Init();
@@ -309,344 +359,43 @@ int main(int argc, char *argv[])
     glCullFace(GL_BACK);
     glFrontFace(GL_CCW);
 
-    glm::vec4 nullvector = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
     // time vars
     float prev_time = (float)glfwGetTime();
     float delta_t = 0.0f;
-    // player vars
-    glm::vec4 carPos = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
-    bbox pBox;
-    glm::vec4 carForward = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
-    glm::mat4 modelPlayer;
-    float max_velocity = 20.0;
-    float friction = 0.7;
-    glm::vec4 current_velocity = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
-    glm::vec4 acceleration = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
-    glm::vec4 frame_movement = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
-    float boostpower = 100.0f;
-    float boostTime = 0;
-    float stunTime = 0;
-    // player hitbox
-    // sphere hitbox
-    float playerHitboxRadius = 0.8f;
-
-    // initial model manipulation
-    modelPlayer = Matrix_Identity();
-    modelPlayer = Matrix_Translate(carPos.x, carPos.y, carPos.z) * modelPlayer;
-    modelPlayer = Matrix_Rotate_Y(3.141592 / 2) * modelPlayer;
-
-    // oponnent vars and model manipulation
-    glm::vec4 oldPos1 = glm::vec4(0.0f, 0.16f, 2.0f, 1.0f);
-    glm::vec4 oldPos2 = glm::vec4(0.0f, 0.16f, -2.0f, 1.0f);
-
-    glm::mat4 modelOponnent1;
-    modelOponnent1 = Matrix_Identity();
-    modelOponnent1 = Matrix_Scale(0.0012, 0.0012, 0.0012) * modelOponnent1;
-    modelOponnent1 = Matrix_Rotate_Y(3.141592 / 2) * modelOponnent1;
-    modelOponnent1 = Matrix_Translate(oldPos1.x, oldPos1.y, oldPos1.z) * modelOponnent1;
-    glm::vec4 opponnent1forward = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
-    glm::vec4 opponnent1pos = glm::vec4(oldPos1.x, oldPos1.y, oldPos1.z, 1.0f);
-
-    // player hitbox
-    // sphere hitbox
-    float opponnent1HitboxRadius = 0.8f;
-    float opponnent2HitboxRadius = 0.8f;
-
-    glm::mat4 modelOponnent2;
-    modelOponnent2 = Matrix_Identity();
-    modelOponnent2 = Matrix_Scale(0.0012, 0.0012, 0.0012) * modelOponnent2;
-    modelOponnent2 = Matrix_Rotate_Y(3.141592 / 2) * modelOponnent2;
-    modelOponnent2 = Matrix_Translate(oldPos2.x, oldPos2.y, oldPos2.z) * modelOponnent2;
-    glm::vec4 opponnent2forward = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
-    glm::vec4 opponnent2pos = glm::vec4(oldPos2.x, oldPos2.y, oldPos2.z, 1.0f);
-
-    // bezier control points1
-    std::vector<glm::vec4> controlPoints1_1;
-    controlPoints1_1.push_back(oldPos1);
-    controlPoints1_1.push_back(glm::vec4(156.483f, 0.16f, -3.52993f, 1.0f));
-    controlPoints1_1.push_back(glm::vec4(134.85f, 0.16f, -6.45085f, 1.0f));
-    controlPoints1_1.push_back(glm::vec4(129.0f, 0.16f, 60.9768f, 1.0f));
-
-    std::vector<glm::vec4> controlPoints1_2;
-    controlPoints1_2.push_back(glm::vec4(129.0f, 0.16f, 60.9768f, 1.0f));
-    controlPoints1_2.push_back(glm::vec4(99.3377f, 0.16f, 71.0411f, 1.0f));
-    controlPoints1_2.push_back(glm::vec4(121.338f, 0.16f, 30.559f, 1.0f));
-    controlPoints1_2.push_back(glm::vec4(69.6432f, 0.16f, 41.1186f, 1.0f));
-
-    std::vector<glm::vec4> controlPoints1_3;
-    controlPoints1_3.push_back(glm::vec4(69.6432f, 0.16f, 41.1186f, 1.0f));
-    controlPoints1_3.push_back(glm::vec4(23.2552f, 0.16f, 32.2232f, 1.0f));
-    controlPoints1_3.push_back(glm::vec4(24.7635f, 0.16f, 47.7012f, 1.0f));
-    controlPoints1_3.push_back(glm::vec4(26.857f, 0.16f, 105.02f, 1.0f));
-
-    std::vector<glm::vec4> controlPoints1_4;
-    controlPoints1_4.push_back(glm::vec4(26.857f, 0.16f, 105.02f, 1.0f));
-    controlPoints1_4.push_back(glm::vec4(10.3733f, 0.16f, 123.0f, 1.0f));
-    controlPoints1_4.push_back(glm::vec4(5.2825f, 0.16f, 124.649f, 1.0f));
-    controlPoints1_4.push_back(glm::vec4(2.76479f, 0.16f, 65.1178f, 1.0f));
-    std::vector<glm::vec4> controlPoints1_5;
-    controlPoints1_5.push_back(glm::vec4(2.76479f, 0.16f, 65.1178f, 1.0f));
-    controlPoints1_5.push_back(glm::vec4(5.32203f, 0.16f, 51.0035f, 1.0f));
-    controlPoints1_5.push_back(glm::vec4(-53.3087f, 0.16f, 59.3961f, 1.0f));
-    controlPoints1_5.push_back(glm::vec4(-49.7859f, 0.16f, 50.4402f, 1.0f));
-    std::vector<glm::vec4> controlPoints1_6;
-    controlPoints1_6.push_back(glm::vec4(-49.7859f, 0.16f, 50.4402f, 1.0f));
-    controlPoints1_6.push_back(glm::vec4(-54.4495f, 0.16f, 20.2291f, 1.0f));
-    controlPoints1_6.push_back(glm::vec4(-66.0504, 0.16f, -13.1143f, 1.0f));
-    controlPoints1_6.push_back(glm::vec4(3.0f, 0.16f, 2.0f, 1.0f));
-    // bezier control points2
-
-    std::vector<glm::vec4> controlPoints2_1;
-    controlPoints2_1.push_back(oldPos2);
-    controlPoints2_1.push_back(glm::vec4(156.483f, 0.16f, -3.52993f, 1.0f));
-    controlPoints2_1.push_back(glm::vec4(134.85f, 0.16f, -6.45085f, 1.0f));
-    controlPoints2_1.push_back(glm::vec4(132.0f, 0.16f, 60.9768f, 1.0f));
-
-    std::vector<glm::vec4> controlPoints2_2;
-    controlPoints2_2.push_back(glm::vec4(132.0f, 0.16f, 60.9768f, 1.0f));
-    controlPoints2_2.push_back(glm::vec4(99.3377f, 0.16f, 71.0411f, 1.0f));
-    controlPoints2_2.push_back(glm::vec4(121.338f, 0.16f, 30.559f, 1.0f));
-    controlPoints2_2.push_back(glm::vec4(69.6432f, 0.16f, 43.1186f, 1.0f));
-
-    std::vector<glm::vec4> controlPoints2_3;
-    controlPoints2_3.push_back(glm::vec4(69.6432f, 0.16f, 43.1186f, 1.0f));
-    controlPoints2_3.push_back(glm::vec4(23.2552f, 0.16f, 32.2232f, 1.0f));
-    controlPoints2_3.push_back(glm::vec4(24.7635f, 0.16f, 47.7012f, 1.0f));
-    controlPoints2_3.push_back(glm::vec4(28.857f, 0.16f, 105.02f, 1.0f));
-
-    std::vector<glm::vec4> controlPoints2_4;
-    controlPoints2_4.push_back(glm::vec4(28.857f, 0.16f, 105.02f, 1.0f));
-    controlPoints2_4.push_back(glm::vec4(10.3733f, 0.16f, 123.0f, 1.0f));
-    controlPoints2_4.push_back(glm::vec4(5.2825f, 0.16f, 124.649f, 1.0f));
-    controlPoints2_4.push_back(glm::vec4(2.76479f, 0.16f, 69.1178f, 1.0f));
-
-    std::vector<glm::vec4> controlPoints2_5;
-    controlPoints2_5.push_back(glm::vec4(2.76479f, 0.16f, 69.1178f, 1.0f));
-    controlPoints2_5.push_back(glm::vec4(5.32203f, 0.16f, 51.0035f, 1.0f));
-    controlPoints2_5.push_back(glm::vec4(-53.3087f, 0.16f, 59.3961f, 1.0f));
-    controlPoints2_5.push_back(glm::vec4(-52.7859f, 0.16f, 50.4402f, 1.0f));
-
-    std::vector<glm::vec4> controlPoints2_6;
-    controlPoints2_6.push_back(glm::vec4(-52.7859f, 0.16f, 50.4402f, 1.0f));
-    controlPoints2_6.push_back(glm::vec4(-54.4495f, 0.16f, 20.2291f, 1.0f));
-    controlPoints2_6.push_back(glm::vec4(-66.0504, 0.16f, -6.89044f, 1.0f));
-    controlPoints2_6.push_back(glm::vec4(3.0f, 0.16f, -2.0f, 1.0f));
-
-    // decor model
-
-    bool raceStart = false;
-    bool lost = false;
-    bool checkpoint = false;
-    bool finished = false;
+
+    // o replay só é reproduzido igual com as opcoes com que foi gravado
+    if (replaying && replay.setup() != setup)
+    {
+        fprintf(stderr, "WARNING: Replay recorded with --opponents %u%s, playing it back with those options.\n",
+                replay.setup().extraOpponents, replay.setup().wallField ? " --wall-field" : "");
+        setup = replay.setup();
+    }
+
+    // pista e estado da corrida, toda a logica do jogo fica em RaceSim
+    RaceTrack track;
+    BuildDefaultTrack(track);
+    if (setup.wallField && !LoadWallField(track, "../../data/Track.obj", "../../data/Track.sdf"))
+    {
+        std::exit(EXIT_FAILURE);
+    }
+    RaceSim sim(track);
+    sim.opponents.addCrowd((int)setup.extraOpponents);
+    const RaceState &race = sim.state;
+    // posição de cada carro na corrida, o player é o carro 0
+    RaceRanking ranking(track.progress);
+    PlaceCars(ranking, sim);
     bool updateCamPos;
 
-    // car lateral movement
-
-    glm::vec4 lateral_velocity = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
-    glm::vec4 up_vector = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
-    glm::vec4 carLeft = crossproduct(up_vector, carForward);
-    glm::vec4 carRight = -carLeft;
-    std::vector<bbox> straightsBBoxes;
-    // straighline bounding boxes
-    bbox sbbox;
-    sbbox.minPoint = glm::vec4(-40.7087f, 0.167617f, -4.80944f, 0.0f);
-    sbbox.maxPoint = glm::vec4(119.674f, 1.14384f, -4.02039f, 0.0f);
-    sbbox.normal = glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
-    straightsBBoxes.push_back(sbbox);
-
-    sbbox.minPoint = glm::vec4(-40.7658f, 0.167617f, 3.9902f, 0.0f);
-    sbbox.maxPoint = glm::vec4(119.617f, 1.14384f, 4.77924f, 0.0f);
-    sbbox.normal = glm::vec4(0.0f, 0.0f, -1.0f, 0.0f);
-    straightsBBoxes.push_back(sbbox);
-
-    sbbox.minPoint = glm::vec4(127.899f, 0.167617f, 10.6331f, 0.0f);
-    sbbox.maxPoint = glm::vec4(128.936f, 1.14384f, 53.4338f, 0.0f);
-    sbbox.normal = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
-    straightsBBoxes.push_back(sbbox);
-
-    sbbox.minPoint = glm::vec4(136.551f, 0.167617f, 9.02853f, 0.0f);
-    sbbox.maxPoint = glm::vec4(137.735f, 1.14384f, 53.4909f, 0.0f);
-    sbbox.normal = glm::vec4(-1.0f, 0.0f, 0.0f, 0.0f);
-    straightsBBoxes.push_back(sbbox);
-
-    sbbox.minPoint = glm::vec4(39.8501f, 0.167617f, 36.1797f, 0.0f);
-    sbbox.maxPoint = glm::vec4(96.9923f, 1.14384f, 36.9671f, 0.0f);
-    sbbox.normal = glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
-    straightsBBoxes.push_back(sbbox);
-
-    sbbox.minPoint = glm::vec4(39.793f, 0.167617f, 44.9793f, 0.0f);
-    sbbox.maxPoint = glm::vec4(96.92f, 1.14384f, 45.7667f, 0.0f);
-    sbbox.normal = glm::vec4(0.0f, 0.0f, -1.0f, 0.0f);
-    straightsBBoxes.push_back(sbbox);
-
-    sbbox.minPoint = glm::vec4(22.7769f, 0.167617f, 52.8528f, 0.0f);
-    sbbox.maxPoint = glm::vec4(23.588f, 1.14384f, 101.884f, 0.0f);
-    sbbox.normal = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
-    straightsBBoxes.push_back(sbbox);
-
-    sbbox.minPoint = glm::vec4(31.5765f, 0.167617f, 52.91f, 0.0f);
-    sbbox.maxPoint = glm::vec4(32.3877f, 1.14384f, 101.941f, 0.0f);
-    sbbox.normal = glm::vec4(-1.0f, 0.0f, 0.0f, 0.0f);
-    straightsBBoxes.push_back(sbbox);
-
-    sbbox.minPoint = glm::vec4(7.47314f, 0.167617f, 68.8696f, 0.0f);
-    sbbox.maxPoint = glm::vec4(8.28739f, 1.14384f, 101.592f, 0.0f);
-    sbbox.normal = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
-    straightsBBoxes.push_back(sbbox);
-
-    sbbox.minPoint = glm::vec4(-1.32648f, 0.167617f, 68.8124f, 0.0f);
-    sbbox.maxPoint = glm::vec4(-0.512249f, 1.14384f, 101.535f, 0.0f);
-    sbbox.normal = glm::vec4(-1.0f, 0.0f, 0.0f, 0.0f);
-    straightsBBoxes.push_back(sbbox);
-
-    sbbox.minPoint = glm::vec4(-41.0521f, 0.167617f, 51.8798f, 0.0f);
-    sbbox.maxPoint = glm::vec4(-8.40433f, 1.14384f, 52.6341f, 0.0f);
-    sbbox.normal = glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
-    straightsBBoxes.push_back(sbbox);
-
-    sbbox.minPoint = glm::vec4(-41.1093f, 0.167617f, 60.6794f, 0.0f);
-    sbbox.maxPoint = glm::vec4(-8.46143f, 1.14384f, 61.4337f, 0.0f);
-    sbbox.normal = glm::vec4(0.0f, 0.0f, -1.0f, 0.0f);
-    straightsBBoxes.push_back(sbbox);
-
-    sbbox.minPoint = glm::vec4(-57.7365f, 0.167617f, 11.8487f, 0.0f);
-    sbbox.maxPoint = glm::vec4(-56.9515f, 1.14384f, 44.5001f, 0.0f);
-    sbbox.normal = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
-    straightsBBoxes.push_back(sbbox);
-
-    sbbox.minPoint = glm::vec4(-48.9368f, 0.167617f, 11.9059f, 0.0f);
-    sbbox.maxPoint = glm::vec4(-48.3918f, 1.14384f, 44.5557f, 0.0f);
-    sbbox.normal = glm::vec4(-1.0f, 0.0f, 0.0f, 0.0f);
-    straightsBBoxes.push_back(sbbox);
-
-    // starting line and check bbox
-    std::vector<bbox> checkpoints;
-    bbox cbbox;
-    cbbox.minPoint = glm::vec4(23.573f, 0.167617f, 61.0342f, 0.0f);
-    cbbox.maxPoint = glm::vec4(31.8161f, 1.14384f, 69.2047f, 0.0f);
-    cbbox.normal = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
-    checkpoints.push_back(cbbox);
-
-    cbbox.minPoint = glm::vec4(1.77523f, 0.167617f, -4.71291f, 0.0f);
-    cbbox.maxPoint = glm::vec4(2.275f, 1.14384f, 4.71291f, 0.0f);
-    cbbox.normal = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
-    checkpoints.push_back(cbbox);
-    // curves
-    std::vector<std::vector<glm::vec4>> curveList;
-    std::vector<glm::vec4> beziercurve1;
-    beziercurve1.push_back(glm::vec4(120.512f, 0.0f, -4.36174f, 1.0f));
-    beziercurve1.push_back(glm::vec4(123.302f, 0.0f, -4.86174f, 1.0f));
-    beziercurve1.push_back(glm::vec4(135.011f, 0.0f, -1.97653f, 1.0f));
-    beziercurve1.push_back(glm::vec4(136.284f, 0.0f, 7.22413f, 1.0f));
-    curveList.push_back(beziercurve1);
-
-    std::vector<glm::vec4> beziercurve2;
-    beziercurve2.push_back(glm::vec4(119.626f, 0.0f, 4.15303f, 1.0f));
-    beziercurve2.push_back(glm::vec4(122.416f, 0.0f, 4.19443f, 1.0f));
-    beziercurve2.push_back(glm::vec4(128.515f, 0.0f, 4.42184f, 1.0f));
-    beziercurve2.push_back(glm::vec4(128.311f, 0.0f, 13.6225f, 1.0f));
-    curveList.push_back(beziercurve2);
-
-    std::vector<glm::vec4> beziercurve3;
-    beziercurve3.push_back(glm::vec4(128.478f, 0.0f, 51.9777f, 1.0f));
-    beziercurve3.push_back(glm::vec4(127.48f, 0.0f, 63.1046f, 1.0f));
-    beziercurve3.push_back(glm::vec4(114.013f, 0.0f, 63.1661f, 1.0f));
-    beziercurve3.push_back(glm::vec4(113.237f, 0.0f, 52.1931f, 1.0f));
-    curveList.push_back(beziercurve3);
-
-    std::vector<glm::vec4> beziercurve4;
-    beziercurve4.push_back(glm::vec4(113.237f, 0.0f, 52.1931f, 1.0f));
-    beziercurve4.push_back(glm::vec4(113.395f, 0.0f, 38.6298f, 1.0f));
-    beziercurve4.push_back(glm::vec4(99.3735f, 0.0f, 35.9511f, 1.0f));
-    beziercurve4.push_back(glm::vec4(96.5414f, 0.0f, 36.5426f, 1.0f));
-    curveList.push_back(beziercurve4);
-
-    std::vector<glm::vec4> beziercurve5;
-    beziercurve5.push_back(glm::vec4(137.254f, 0.0f, 52.1931f, 1.0f));
-    beziercurve5.push_back(glm::vec4(137.412f, 0.0f, 72.4043f, 1.0f));
-    beziercurve5.push_back(glm::vec4(109.267f, 0.0f, 76.808f, 1.0f));
-    beziercurve5.push_back(glm::vec4(105.092f, 0.0f, 55.4622f, 1.0f));
-    curveList.push_back(beziercurve5);
-
-    std::vector<glm::vec4> beziercurve6;
-    beziercurve6.push_back(glm::vec4(105.092f, 0.0f, 55.4622f, 1.0f));
-    beziercurve6.push_back(glm::vec4(104.126f, 0.0f, 48.4478f, 1.0f));
-    beziercurve6.push_back(glm::vec4(103.997f, 0.0f, 44.8816f, 1.0f));
-    beziercurve6.push_back(glm::vec4(94.0448f, 0.0f, 45.1446f, 1.0f));
-    curveList.push_back(beziercurve6);
-
-
-    std::vector<glm::vec4> beziercurve7;
-    beziercurve7.push_back(glm::vec4(39.7007f, 0.0f, 36.3488f, 1.0f));
-    beziercurve7.push_back(glm::vec4(26.3065f, 0.0f, 36.4643f, 1.0f));
-    beziercurve7.push_back(glm::vec4(21.8087f, 0.0f, 49.8102f, 1.0f));
-    beziercurve7.push_back(glm::vec4(23.0853f, 0.0f, 56.8246f, 1.0f));
-    curveList.push_back(beziercurve7);
-
-    std::vector<glm::vec4> beziercurve8;
-    beziercurve8.push_back(glm::vec4(39.7007f, 0.0f, 45.337f, 1.0f));
-    beziercurve8.push_back(glm::vec4(34.6639f, 0.0f, 45.4525f, 1.0f));
-    beziercurve8.push_back(glm::vec4(30.8758f, 0.0f, 49.8102f, 1.0f));
-    beziercurve8.push_back(glm::vec4(31.7581f, 0.0f, 56.8246f, 1.0f));
-    curveList.push_back(beziercurve8);
-
-    std::vector<glm::vec4> beziercurve9;
-    beziercurve9.push_back(glm::vec4(23.3203f, 0.0f, 99.3802f, 1.0f));
-    beziercurve9.push_back(glm::vec4(23.0891f, 0.0f, 114.942f, 1.0f));
-    beziercurve9.push_back(glm::vec4(6.20176f, 0.0f, 110.899f, 1.0f));
-    beziercurve9.push_back(glm::vec4(7.853f, 0.0f, 98.6958f, 1.0f));
-    curveList.push_back(beziercurve9);
-
-    std::vector<glm::vec4> beziercurve10;
-    beziercurve10.push_back(glm::vec4(31.9701f, 0.0f, 99.3802f, 1.0f));
-    beziercurve10.push_back(glm::vec4(33.9709f, 0.0f, 121.277f, 1.0f));
-    beziercurve10.push_back(glm::vec4(-1.25309f, 0.0f, 127.641f, 1.0f));
-    beziercurve10.push_back(glm::vec4(-1.16885f, 0.0f, 98.6958f, 1.0f));
-    curveList.push_back(beziercurve10);
-
-    std::vector<glm::vec4> beziercurve11;
-    beziercurve11.push_back(glm::vec4(7.47649f, 0.0f, 66.7042f, 1.0f));
-    beziercurve11.push_back(glm::vec4(6.74377f, 0.0f, 54.6708f, 1.0f));
-    beziercurve11.push_back(glm::vec4(-4.02467f, 0.0f, 51.278f, 1.0f));
-    beziercurve11.push_back(glm::vec4(-15.0344f, 0.0f, 52.0941f, 1.0f));
-    curveList.push_back(beziercurve11);
-
-    std::vector<glm::vec4> beziercurve12;
-    beziercurve12.push_back(glm::vec4(-0.967499f, 0.0f, 73.5248f, 1.0f));
-    beziercurve12.push_back(glm::vec4(-0.731407f, 0.0f, 61.4914f, 1.0f));
-    beziercurve12.push_back(glm::vec4(-4.02469f, 0.0f, 60.2515f, 1.0f));
-    beziercurve12.push_back(glm::vec4(-15.0344f, 0.0f, 61.0676f, 1.0f));
-    curveList.push_back(beziercurve12);
-
-    std::vector<glm::vec4> beziercurve13;
-    beziercurve13.push_back(glm::vec4(-42.6206f, 0.0f, 60.6673f, 1.0f));
-    beziercurve13.push_back(glm::vec4(-50.2865f, 0.0f, 59.8842f, 1.0f));
-    beziercurve13.push_back(glm::vec4(-57.062f, 0.0f, 55.8317f, 1.0f));
-    beziercurve13.push_back(glm::vec4(-57.3571f, 0.0f, 43.3885f, 1.0f));
-    curveList.push_back(beziercurve13);
-
-    std::vector<glm::vec4> beziercurve14;
-    beziercurve14.push_back(glm::vec4(-38.0477f, 0.0f, 52.1415f, 1.0f));
-    beziercurve14.push_back(glm::vec4(-45.7135f, 0.0f, 52.9085f, 1.0f));
-    beziercurve14.push_back(glm::vec4(-48.4587f, 0.0f, 49.5536f, 1.0f));
-    beziercurve14.push_back(glm::vec4(-48.7538f, 0.0f, 43.3885f, 1.0f));
-    curveList.push_back(beziercurve14);
-
-    std::vector<glm::vec4> beziercurve15;
-    beziercurve15.push_back(glm::vec4(-48.502f, 0.0f, 12.3608f, 1.0f));
-    beziercurve15.push_back(glm::vec4(-48.2069f, 0.0f, 8.3172f, 1.0f));
-    beziercurve15.push_back(glm::vec4(-46.0213f, 0.0f, 4.44382f, 1.0f));
-    beziercurve15.push_back(glm::vec4(-38.0477f, 0.0f, 4.84188f, 1.0f));
-    curveList.push_back(beziercurve15);
-
-    std::vector<glm::vec4> beziercurve16;
-    beziercurve16.push_back(glm::vec4(-57.227f, 0.0f, 12.3608f, 1.0f));
-    beziercurve16.push_back(glm::vec4(-56.9319f, 0.0f, 8.3172f, 1.0f));
-    beziercurve16.push_back(glm::vec4(-54.5646f, 0.0f, -4.60828f, 1.0f));
-    beziercurve16.push_back(glm::vec4(-38.0477f, 0.0f, -4.21022f, 1.0f));
-    curveList.push_back(beziercurve16);
-
-  
+    // a simulacao roda em passos fixos, o desenho interpola entre os dois
+    // ultimos passos
+    if (replaying)
+    {
+        // o replay só é reproduzido exatamente na frequencia em que foi gravado
+        tickRate = replay.tickRate();
+    }
+    FixedTimestep timestep(tickRate);
+    RaceState previous = sim.state;
+    bool replayStarted = false;
 
     while (!glfwWindowShouldClose(window))
     {
@@ -663,6 +412,75 @@ int main(int argc, char *argv[])
         float current_time = (float)glfwGetTime();
         delta_t = current_time - prev_time;
         prev_time = current_time;
+
+        if ((!race.raceStart && startPressed) || (replaying && !replayStarted))
+        { // restart race
+            glfwSetTime(0);
+            prev_time = 0;
+            sim.start();
+            PlaceCars(ranking, sim);
+            timestep.reset();
+            previous = sim.state;
+            if (replaying)
+            {
+                replay.rewind();
+                replayStarted = true;
+            }
+            if (recordFile)
+            {
+                recorder.open(recordFile, tickRate, setup);
+            }
+            if (ghostFile && ghostRecorder.open(ghostFile, tickRate))
+            {
+                ghostRecorder.record(race.modelPlayer);
+            }
+        }
+        // os controles do carro so valem nas cameras que seguem o player
+        RaceInputs inputs = RaceInputs();
+        if (camType < 2)
+        {
+            inputs.forward = wPressed;
+            inputs.left = aPressed;
+            inputs.back = sPressed;
+            inputs.right = dPressed;
+            inputs.boost = spacePressed;
+            inputs.strafeLeft = g_LeftMouseButtonPressed;
+            inputs.strafeRight = g_RightMouseButtonPressed;
+        }
+        int ticks = timestep.advance(delta_t);
+        for (int i = 0; i < ticks; i++)
+        {
+            previous = sim.state;
+            RaceInputs tickInputs = inputs;
+            if (replaying && !replay.next(tickInputs))
+            {
+                // fim do replay: os controles voltam para o jogador, e o
+                // Enter seguinte comeca uma corrida normal
+                replaying = false;
+                tickInputs = inputs;
+            }
+            if (race.raceStart)
+            {
+                recorder.record(tickInputs, sim);
+            }
+            sim.step(tickInputs, timestep.tickDt);
+            RankCars(ranking, sim, timestep.tickDt);
+            if (previous.raceStart)
+            {
+                ghostRecorder.record(race.modelPlayer);
+            }
+        }
+        if (!race.raceStart)
+        {
+            recorder.close();
+            ghostRecorder.close();
+        }
+        float alpha = timestep.alpha();
+        // a camera segue o carro interpolado, igual ao que é desenhado
+        glm::vec4 carPos = previous.carPos + (race.carPos - previous.carPos) * alpha;
+        glm::vec4 carForward = previous.carForward + (race.carForward - previous.carForward) * alpha;
+        glm::vec4 current_velocity = race.current_velocity;
+
         glm::vec4 camera_position_c;
         if (camType < 2)
         {
@@ -676,7 +494,7 @@ int main(int argc, char *argv[])
             if (camType == 0)
             {
 
-                if (boostTime < current_time)
+                if (race.boostTime < race.time)
                 {
                     camera_position_c = Matrix_Translate(-carForward.x * 6 / (1 + norm(current_velocity) * norm(current_velocity) * 0.0004), 2 / (1 + norm(current_velocity) * 0.05f), -carForward.z * 6 / (1 + norm(current_velocity) * norm(current_velocity) * 0.0004)) * carPos;
                 }
@@ -766,286 +584,35 @@ int main(int argc, char *argv[])
         DrawVirtualObject("decor");
         glClear(GL_DEPTH_BUFFER_BIT);
         glEnable(GL_CULL_FACE);
-        auto reset = [&]()
-        {
-            carForward = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
-            current_velocity = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
-            carPos = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
-            oldPos1 = glm::vec4(0.0f, 0.16f, 2.0f, 1.0f);
-            oldPos2 = glm::vec4(0.0f, 0.16f, -2.0f, 1.0f);
-            modelPlayer = Matrix_Identity();
-            modelPlayer = Matrix_Translate(carPos.x, carPos.y, carPos.z) * modelPlayer;
-            modelPlayer = Matrix_Rotate_Y(3.141592 / 2) * modelPlayer;
-            modelOponnent1 = Matrix_Identity();
-            modelOponnent1 = Matrix_Scale(0.0012, 0.0012, 0.0012) * modelOponnent1;
-            modelOponnent1 = Matrix_Rotate_Y(PI / 2) * modelOponnent1;
-            modelOponnent1 = Matrix_Translate(oldPos1.x, oldPos1.y, oldPos1.z) * modelOponnent1;
-            opponnent1forward = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
-            opponnent1pos = glm::vec4(oldPos1.x, oldPos1.y, oldPos1.z, 1.0f);
-
-            modelOponnent2 = Matrix_Identity();
-            modelOponnent2 = Matrix_Scale(0.0012, 0.0012, 0.0012) * modelOponnent2;
-            modelOponnent2 = Matrix_Rotate_Y(PI / 2) * modelOponnent2;
-            modelOponnent2 = Matrix_Translate(oldPos2.x, oldPos2.y, oldPos2.z) * modelOponnent2;
-            opponnent2forward = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
-            opponnent2pos = glm::vec4(oldPos2.x, oldPos2.y, oldPos2.z, 1.0f);
-            lost = false;
-            checkpoint = false;
-            finished = false;
-            boostpower = 100;
-            stunTime = 0;
-            boostTime = 0;
-        };
-
-        if ((!raceStart && startPressed))
-        { // restart race
-            glfwSetTime(0);
-            raceStart = true;
-            prev_time = 0;
-            reset();
-        }
-        if (raceStart)
-        {
-            // definição dos controles do player e modelo de fisica
-            current_velocity -= friction * delta_t * current_velocity;
-            if (camType < 2)
-            {
-                if (wPressed)
-                {
-                    acceleration += max_velocity * carForward * delta_t;
-                }
-                if (aPressed)
-                {
-                    float velocity_norm = norm(current_velocity);
-                    float rotation = 2.0f;
-                    if (velocity_norm > 0)
-                    {
-                        rotation = std::min(std::max(max_velocity / norm(current_velocity), 0.5f), 2.0f);
-                    }
-                    carForward = Matrix_Rotate_Y(rotation * delta_t) * carForward;
-                    modelPlayer = Matrix_Translate(carPos.x, carPos.y, carPos.z) * Matrix_Rotate_Y(rotation * delta_t) * Matrix_Translate(-carPos.x, -carPos.y, -carPos.z) * modelPlayer;
-                }
-
-                if (sPressed)
-                {
-                    acceleration -= max_velocity * carForward * delta_t;
-                }
-                if (dPressed)
-                {
-                    float velocity_norm = norm(current_velocity);
-                    float rotation = 2.0f;
-                    if (velocity_norm > 0)
-                    {
-                        rotation = std::min(std::max(max_velocity / norm(current_velocity), 0.5f), 2.0f);
-                    }
-                    carForward = Matrix_Rotate_Y(-rotation * delta_t) * carForward;
-                    modelPlayer = Matrix_Translate(carPos.x, carPos.y, carPos.z) * Matrix_Rotate_Y(-rotation * delta_t) * Matrix_Translate(-carPos.x, -carPos.y, -carPos.z) * modelPlayer;
-                }
-
-                lateral_velocity = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
-                carLeft = crossproduct(up_vector, carForward);
-                carRight = -carLeft;
-                if (hasRotatedL)
-                {
-                    modelPlayer = Matrix_Translate(carPos.x, carPos.y, carPos.z) * Matrix_Rotate(PI / 20, carForward) * Matrix_Translate(-carPos.x, -carPos.y, -carPos.z) * modelPlayer;
-                    hasRotatedL = false;
-                }
-                if (hasRotatedR)
-                {
-                    modelPlayer = Matrix_Translate(carPos.x, carPos.y, carPos.z) * Matrix_Rotate(-PI / 20, carForward) * Matrix_Translate(-carPos.x, -carPos.y, -carPos.z) * modelPlayer;
-                    hasRotatedR = false;
-                }
-                if (g_LeftMouseButtonPressed && !g_RightMouseButtonPressed && (stunTime < current_time))
-                {
-                    lateral_velocity += carLeft * max_velocity * 30.0f * delta_t;
-                    if (!hasRotatedL)
-                    {
-                        hasRotatedL = true;
-                        modelPlayer = Matrix_Translate(carPos.x, carPos.y, carPos.z) * Matrix_Rotate(-PI / 20, carForward) * Matrix_Translate(-carPos.x, -carPos.y, -carPos.z) * modelPlayer;
-                    }
-                }
-                if (g_RightMouseButtonPressed && !g_LeftMouseButtonPressed && (stunTime < current_time))
-                {
-                    lateral_velocity += carRight * max_velocity * 30.0f * delta_t;
-                    if (!hasRotatedR)
-                    {
-                        hasRotatedR = true;
-                        modelPlayer = Matrix_Translate(carPos.x, carPos.y, carPos.z) * Matrix_Rotate(PI / 20, carForward) * Matrix_Translate(-carPos.x, -carPos.y, -carPos.z) * modelPlayer;
-                    }
-                }
-                if (spacePressed && (boostTime < current_time) && boostpower > 1)
-                {
-                    boostpower -= 22;
-                    if (boostpower <= 0)
-                    {
-                        boostpower = 1;
-                    }
-                    acceleration += 10.0f * max_velocity * carForward * delta_t;
-                    current_velocity += 1.0f * max_velocity * carForward;
-                    boostTime = current_time + 5;
-                }
-            }
-
-            if (norm(acceleration) == 0 && norm(current_velocity) < 0.5)
-            {
-                current_velocity *= 0;
-            }
-
-            if (dotproduct(current_velocity, carForward) < 0)
-            {
-                current_velocity = norm(current_velocity) * -carForward + acceleration;
-            }
-            else
-            {
-                current_velocity = norm(current_velocity) * carForward + acceleration;
-            }
-            bool collided1 = spheres_collision(carPos, playerHitboxRadius, opponnent1pos, opponnent1HitboxRadius);
-            bool collided2 = spheres_collision(carPos, playerHitboxRadius, opponnent2pos, opponnent2HitboxRadius);
-            if (collided1)
-            {
-                if (stunTime < current_time)
-                {
-                    boostpower -= 10;
-                }
-                glm::vec4 yfilter = glm::vec4(1.0f, 0.0f, 1.0f, 0.0f);
-                glm::vec4 axis = ((carPos * yfilter - opponnent1pos * yfilter)) / norm((carPos * yfilter) - (opponnent1pos * yfilter));
-                glm::vec4 newSpeed = (current_velocity - 2 * (dotproduct(current_velocity, axis)) * axis);
-                current_velocity = newSpeed;
-                if (norm(lateral_velocity) != 0)
-                {
-                    lateral_velocity = -lateral_velocity;
-                }
-                stunTime = current_time + 0.5;
-            }
-            if (collided2)
-            {
-                if (stunTime < current_time)
-                {
-                    boostpower -= 10;
-                }
-                glm::vec4 yfilter = glm::vec4(1.0f, 0.0f, 1.0f, 0.0f);
-                glm::vec4 axis = ((carPos * yfilter - opponnent2pos * yfilter)) / norm((carPos * yfilter) - (opponnent2pos * yfilter));
-                glm::vec4 newSpeed = (current_velocity - 2 * (dotproduct(current_velocity, axis)) * axis);
-                current_velocity = newSpeed;
-                if (norm(lateral_velocity) != 0)
-                {
-                    lateral_velocity = -lateral_velocity;
-                }
-                stunTime = current_time + 0.5;
-            }
-            pBox.minPoint = (glm::vec4(carPos.x - 0.46, carPos.y - 0.46, carPos.z - 0.46, carPos.w));
-            pBox.maxPoint = glm::vec4(carPos.x + 0.46, carPos.y + 0.46, carPos.z + 0.46, carPos.w);
-            glm::vec4 normal = checkAllbbox(pBox, straightsBBoxes);
-            if (normal != nullvector)
-            {
-                if (stunTime < current_time)
-                {
-                    boostpower -= 10;
-                }
-                glm::vec4 newSpeed = (current_velocity - 2 * (dotproduct(current_velocity, normal)) * normal);
-                current_velocity = newSpeed;
-                // carPos=Matrix_Translate(normal.x,normal.y,normal.z)*carPos;
-                // modelPlayer=Matrix_Translate(normal.x,normal.y,normal.z)*modelPlayer;
-                float dotprod = dotproduct(normalize(current_velocity), carForward);
-                if (dotprod > 1)
-                {
-                    dotprod = 1;
-                }
-                if (dotprod < -1)
-                {
-                    dotprod = -1;
-                }
-                float angle = acos(dotprod);
-                glm::vec4 cross = crossproduct(current_velocity, carForward);
-                if (cross.y > 0)
-                {
-                    angle = -1 * angle;
-                }
-                carForward = Matrix_Rotate_Y(angle) * carForward;
-                modelPlayer = Matrix_Translate(carPos.x, carPos.y, carPos.z) * Matrix_Rotate_Y(angle) * Matrix_Translate(-carPos.x, -carPos.y, -carPos.z) * modelPlayer;
-                if (norm(lateral_velocity) != 0)
-                {
-                    lateral_velocity = -lateral_velocity;
-                }
-                stunTime = current_time + 0.5;
-            }
-
-            glm::vec4 coll = checkAllBezier(carPos, playerHitboxRadius, curveList, 0.01f);
-            if (coll != nullvector)
-            {
-                if (stunTime < current_time)
-                {
-                    boostpower -= 10;
-
-                    float dotprod = dotproduct(normalize(carPos - coll), carForward);
-                    if (dotprod > 1)
-                    {
-                        dotprod = 1;
-                    }
-                    if (dotprod < -1)
-                    {
-                        dotprod = -1;
-                    }
-                    float angle = acos(dotprod);
-                    glm::vec4 cross = crossproduct(normalize(carPos - coll), carForward);
-                    if (cross.y < 0)
-                    {
-                        angle = -1 * angle;
-                    }
-                    if (angle > 0)
-                    {
-                        carForward = Matrix_Rotate_Y(-PI / 2) * carForward;
-                        modelPlayer = Matrix_Translate(carPos.x, carPos.y, carPos.z) * Matrix_Rotate_Y(-PI / 2) * Matrix_Translate(-carPos.x, -carPos.y, -carPos.z) * modelPlayer;
-                    }
-                    else if (angle < 0)
-                    {
-
-                        carForward = Matrix_Rotate_Y(PI / 2) * carForward;
-                        modelPlayer = Matrix_Translate(carPos.x, carPos.y, carPos.z) * Matrix_Rotate_Y(PI / 2) * Matrix_Translate(-carPos.x, -carPos.y, -carPos.z) * modelPlayer;
-                    }
-                    current_velocity = norm(current_velocity)*0.5f * carForward;
-
-                    if (norm(lateral_velocity) != 0)
-                    {
-                        lateral_velocity = -lateral_velocity;
-                    }
-                    stunTime = current_time + 0.1;
-                }
-            }
-
-            frame_movement = (current_velocity + lateral_velocity) * delta_t;
-            modelPlayer = Matrix_Translate(frame_movement.x, frame_movement.y, frame_movement.z) * modelPlayer;
-            carPos += frame_movement;
-            acceleration *= 0;
-
-            // comportamento dos oponentes
-            float bezierTime1 = current_time / 5;
-            float bezierTime2 = current_time / 8;
-            // oponnent 1
-
-            modelOponnent1 = opponentMovement(modelOponnent1, bezierTime1, controlPoints1_1, controlPoints1_2, controlPoints1_3, controlPoints1_4, controlPoints1_5, controlPoints1_6, 3, opponnent1forward, opponnent1pos, oldPos1);
-
-            // oponnent 2
-
-            modelOponnent2 = opponentMovement(modelOponnent2, bezierTime2, controlPoints2_1, controlPoints2_2, controlPoints2_3, controlPoints2_4, controlPoints2_5, controlPoints2_6, 3, opponnent2forward, opponnent2pos, oldPos2);
-        }
 
 
 
+        glm::mat4 modelPlayer = interpolateModel(previous.modelPlayer, race.modelPlayer, alpha);
         glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(modelPlayer));
         glUniform1i(object_id_uniform, BLUE_FALCON);
         DrawVirtualObject("blue_falcon");
-        glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(modelOponnent1));
-        glUniform1i(object_id_uniform, OPPONENT);
-        DrawVirtualObject("opponent");
-        glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(modelOponnent2));
-        glUniform1i(object_id_uniform, OPPONENT);
-        DrawVirtualObject("opponent");
+        // oponentes dependem so do tempo, entao sao calculados direto no
+        // instante interpolado
+        float renderTime = previous.time + (race.time - previous.time) * alpha;
+        for (int i = 0; i < sim.opponents.size(); i++)
+        {
+            glm::mat4 modelOpponent = sim.opponents.modelAt(i, renderTime);
+            glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(modelOpponent));
+            glUniform1i(object_id_uniform, OPPONENT);
+            DrawVirtualObject("opponent");
+        }
+        // fantasmas: transformacao do player gravada, com a malha do oponente
+        // na mesma escala e altura dos oponentes
+        ghosts.update(renderTime);
+        for (int i = 0; i < ghosts.size(); i++)
+        {
+            glm::mat4 modelGhost = Matrix_Multiply(Matrix_Multiply(Matrix_Translate(0.0f, 0.16f, 0.0f), ghosts.model(i)), Matrix_Scale(0.0012f, 0.0012f, 0.0012f));
+            glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(modelGhost));
+            glUniform1i(object_id_uniform, OPPONENT);
+            DrawVirtualObject("opponent");
+        }
         // Pista
-        glm::mat4 model = Matrix_Identity();
-        model = Matrix_Rotate_Y(-PI / 2) * model;
-        model = Matrix_Scale(8.0f, 8.0f, 8.0f) * model;
-        model = Matrix_Translate(0.0f, -0.8f, 0.0f) * model;
+        glm::mat4 model = TrackModelMatrix();
         glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model));
         glUniform1i(object_id_uniform, PLANE);
         DrawVirtualObject("Track");
@@ -1056,48 +623,25 @@ int main(int argc, char *argv[])
         glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model));
         glUniform1i(object_id_uniform, START);
         DrawVirtualObject("Starting_Line");
-        glm::vec4 normal = checkAllbbox(pBox, checkpoints);
         // win/lose logic
-        if (current_time < 30 && raceStart && !finished)
-        {
-            lost = false;
-        }
-        if (current_time > 30 && raceStart && !finished)
-        {
-            lost = true;
-        }
-
-        if (normal.x == 1 /*colisao com checkpoint*/)
-        {
-            checkpoint = true;
-        }
-        if (normal.y == 1 /*colisao com final*/)
-        {
-            if (checkpoint)
-            {
-                finished = true;
-            }
-        }
-        if (finished && !lost)
+        if (race.finished && !race.lost)
         {
-            raceStart = false;
             TextRendering_PrintString(window, "You Win, Press Enter to Restart", -1.0f + pad / 10, -1.0f + 2 * pad / 10, 1.0f);
         }
-        else if (finished && lost)
+        else if (race.finished && race.lost)
         {
-            raceStart = false;
             TextRendering_PrintString(window, "You Lost, Press Enter to Restart", -1.0f + pad / 10, -1.0f + 2 * pad / 10, 1.0f);
         }
-        if (!raceStart && !finished && boostpower > 0)
+        if (!race.raceStart && !race.finished && race.boostpower > 0)
         {
             TextRendering_PrintString(window, "Press Enter to Start", -1.0f + pad / 10, -1.0f + 2 * pad / 10, 1.0f);
         }
-        if (boostpower <= 0)
+        if (race.boostpower <= 0)
         {
-            raceStart = false;
             TextRendering_PrintString(window, "You Lost, Press Enter to Restart", -1.0f + pad / 10, -1.0f + 2 * pad / 10, 1.0f);
         }
-        printBoost(boostpower, pad, window);
+        printBoost(race.boostpower, pad, window);
+        printPlace(ranking, pad, window);
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
@@ -1121,6 +665,35 @@ void printBoost(float power, float pad, GLFWwindow *window)
     boost.append("]");
     TextRendering_PrintString(window, boost, -1.0f + pad / 20, 1.0f - 2 * pad, 2.0f);
 }
+void printPlace(const RaceRanking &ranking, float pad, GLFWwindow *window)
+{
+    char place[64];
+    snprintf(place, sizeof(place), "Position %d/%d", ranking.position(0) + 1, ranking.size());
+    TextRendering_PrintString(window, place, -1.0f + pad / 20, 1.0f - 4 * pad, 2.0f);
+    if (ranking.wrongWay(0))
+    {
+        TextRendering_PrintString(window, "Wrong Way!", -1.0f + pad / 20, 1.0f - 6 * pad, 2.0f);
+    }
+}
+void PlaceCars(RaceRanking &ranking, const RaceSim &sim)
+{
+    ranking.reset(1 + sim.opponents.size());
+    ranking.place(0, sim.state.carPos.x, sim.state.carPos.z);
+    for (int i = 0; i < sim.opponents.size(); i++)
+    {
+        ranking.place(i + 1, sim.opponents.posX[i], sim.opponents.posZ[i]);
+    }
+    ranking.rank();
+}
+void RankCars(RaceRanking &ranking, const RaceSim &sim, float dt)
+{
+    ranking.update(0, sim.state.carPos.x, sim.state.carPos.z, sim.state.carForward.x, sim.state.carForward.z, dt);
+    for (int i = 0; i < sim.opponents.size(); i++)
+    {
+        ranking.update(i + 1, sim.opponents.posX[i], sim.opponents.posZ[i], sim.opponents.forwardX[i], sim.opponents.forwardZ[i], dt);
+    }
+    ranking.rank();
+}
 // Função que carrega uma imagem para ser utilizada como textura
 void LoadTextureImage(const char *filename)
 {
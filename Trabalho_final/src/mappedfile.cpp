@@ -0,0 +1,114 @@
+#include <cstdio>
+
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile()
+    : m_data(NULL), m_size(0), m_file(INVALID_HANDLE_VALUE), m_mapping(NULL)
+{
+}
+#else
+MappedFile::MappedFile()
+    : m_data(NULL), m_size(0)
+{
+}
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const char *filename)
+{
+    close();
+    m_file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER size;
+    if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx((HANDLE)m_file, &size) || size.QuadPart == 0)
+    {
+        fprintf(stderr, "ERROR: Cannot open \"%s\".\n", filename);
+        close();
+        return false;
+    }
+    m_mapping = CreateFileMappingA((HANDLE)m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (m_mapping)
+    {
+        m_data = (const unsigned char *)MapViewOfFile((HANDLE)m_mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (!m_data)
+    {
+        fprintf(stderr, "ERROR: Cannot map \"%s\" into memory.\n", filename);
+        close();
+        return false;
+    }
+    m_size = (size_t)size.QuadPart;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping)
+    {
+        CloseHandle((HANDLE)m_mapping);
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle((HANDLE)m_file);
+    }
+    m_data = NULL;
+    m_size = 0;
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = NULL;
+}
+#else
+bool MappedFile::open(const char *filename)
+{
+    close();
+    int fd = ::open(filename, O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        fprintf(stderr, "ERROR: Cannot open \"%s\".\n", filename);
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+        return false;
+    }
+    // the mapping keeps the file alive, the descriptor is no longer needed
+    void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        fprintf(stderr, "ERROR: Cannot map \"%s\" into memory.\n", filename);
+        return false;
+    }
+    m_data = (const unsigned char *)data;
+    m_size = (size_t)info.st_size;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data)
+    {
+        munmap((void *)m_data, m_size);
+    }
+    m_data = NULL;
+    m_size = 0;
+}
+#endif
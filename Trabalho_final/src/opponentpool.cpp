@@ -0,0 +1,196 @@
+#include <cmath>
+#include <algorithm>
+
+#include "opponent.h"
+#include "opponentpool.h"
+
+// grid cell of the broadphase, at least the player plus opponent hitbox
+// radius and two opponent hitboxes, the largest queries
+static const float gridCellSize = 2 * opponentHitboxRadius;
+// below this many opponents testing them all is cheaper than building the
+// grid and walking its cells (bench_broadphase: the two cross between 80 and
+// 88 cars)
+static const int gridMinOpponents = 80;
+
+OpponentPool::OpponentPool(const RaceTrack &track)
+    : m_track(&track), m_grid(gridCellSize)
+{
+    m_paths.resize(NUM_OPPONENTS);
+    for (int p = 0; p < NUM_OPPONENTS; p++)
+    {
+        m_paths[p].build(track.opponentPaths[p]);
+    }
+    for (int p = 0; p < NUM_OPPONENTS; p++)
+    {
+        add(p, track.opponentSpeed[p]);
+    }
+}
+
+int OpponentPool::add(int pathIndex, float metersPerSecond, float offset, float sideways)
+{
+    path.push_back(pathIndex);
+    speed.push_back(metersPerSecond);
+    timeOffset.push_back(offset);
+    lane.push_back(sideways);
+    posX.push_back(0.0f);
+    posY.push_back(0.0f);
+    posZ.push_back(0.0f);
+    forwardX.push_back(1.0f);
+    forwardZ.push_back(0.0f);
+    models.push_back(glm::mat4(1.0f));
+    int o = size() - 1;
+    pose(o, 0.0f, posX[o], posY[o], posZ[o], forwardX[o], forwardZ[o]);
+    models[o] = opponentModel(posX[o], posY[o], posZ[o], forwardX[o], forwardZ[o]);
+    return o;
+}
+
+void OpponentPool::addCrowd(int count, int lanes, float laneWidth, float rowGap)
+{
+    int paths = (int)m_paths.size();
+    for (int k = 0; k < count; k++)
+    {
+        int row = k / lanes;
+        int p = row % paths;
+        float metersPerSecond = m_track->opponentSpeed[p];
+        float sideways = ((k % lanes) - (lanes - 1) * 0.5f) * laneWidth;
+        add(p, metersPerSecond, (row + 1) * rowGap / metersPerSecond, sideways);
+    }
+}
+
+void OpponentPool::pose(int o, float time, float &x, float &y, float &z, float &fx, float &fz) const
+{
+    // before the start the opponent waits on the grid facing along the path,
+    // then it laps a closed path and stops at the end of an open one. The
+    // distance is wrapped in double, after an hour of laps it is tens of km
+    // and a float would lose the centimeters
+    const ArcLengthTable &table = m_paths[path[o]];
+    double distance = std::max((double)time + timeOffset[o], 0.0) * speed[o];
+    if (table.spline().closed() && table.length() > 0.0f)
+    {
+        distance -= (double)(long long)(distance / table.length()) * table.length();
+    }
+    glm::vec4 point, tangent;
+    table.sample((float)distance, point, tangent);
+    float length = std::sqrt(tangent.x * tangent.x + tangent.z * tangent.z);
+    fx = 1.0f;
+    fz = 0.0f;
+    if (length > 0.0f)
+    {
+        fx = tangent.x / length;
+        fz = tangent.z / length;
+    }
+    x = point.x - lane[o] * fz;
+    y = point.y;
+    z = point.z + lane[o] * fx;
+}
+
+glm::mat4 OpponentPool::modelAt(int o, float time) const
+{
+    float x, y, z, fx, fz;
+    pose(o, time, x, y, z, fx, fz);
+    return opponentModel(x, y, z, fx, fz);
+}
+
+void OpponentPool::update(float time)
+{
+    const int n = size();
+    for (int o = 0; o < n; o++)
+    {
+        pose(o, time, posX[o], posY[o], posZ[o], forwardX[o], forwardZ[o]);
+        models[o] = opponentModel(posX[o], posY[o], posZ[o], forwardX[o], forwardZ[o]);
+    }
+    if (n >= gridMinOpponents)
+    {
+        m_grid.build(posX.data(), posZ.data(), n);
+    }
+}
+
+CarSpheres OpponentPool::spheres() const
+{
+    CarSpheres spheres;
+    spheres.x = posX.data();
+    spheres.y = posY.data();
+    spheres.z = posZ.data();
+    spheres.count = size();
+    spheres.grid = size() >= gridMinOpponents && m_grid.size() == size() ? &m_grid : NULL;
+    return spheres;
+}
+
+void OpponentPool::collide(const glm::vec4 &center, float radius, std::vector<int> &hits) const
+{
+    hits.clear();
+    const int n = size();
+    const float *x = posX.data();
+    const float *y = posY.data();
+    const float *z = posZ.data();
+    const float r2 = radius * radius;
+    if (n < gridMinOpponents || m_grid.size() != n)
+    {
+        for (int o = 0; o < n; o++)
+        {
+            float dx = center.x - x[o];
+            float dy = center.y - y[o];
+            float dz = center.z - z[o];
+            if (dx * dx + dy * dy + dz * dz < r2)
+            {
+                hits.push_back(o);
+            }
+        }
+        return;
+    }
+    m_grid.query(center.x, center.z, radius, m_candidates);
+    for (size_t i = 0; i < m_candidates.size(); i++)
+    {
+        int o = m_candidates[i];
+        float dx = center.x - x[o];
+        float dy = center.y - y[o];
+        float dz = center.z - z[o];
+        if (dx * dx + dy * dy + dz * dz < r2)
+        {
+            hits.push_back(o);
+        }
+    }
+}
+
+void OpponentPool::touching(float radius, std::vector<CarPair> &pairs) const
+{
+    const int n = size();
+    const float r2 = radius * radius;
+    pairs.clear();
+    if (n < gridMinOpponents || m_grid.size() != n)
+    {
+        for (int a = 0; a < n; a++)
+        {
+            for (int b = a + 1; b < n; b++)
+            {
+                float dx = posX[a] - posX[b];
+                float dy = posY[a] - posY[b];
+                float dz = posZ[a] - posZ[b];
+                if (dx * dx + dy * dy + dz * dz < r2)
+                {
+                    CarPair pair;
+                    pair.a = a;
+                    pair.b = b;
+                    pairs.push_back(pair);
+                }
+            }
+        }
+        return;
+    }
+    m_grid.pairs(radius, pairs);
+    // keeps the candidate pairs that really touch
+    size_t kept = 0;
+    for (size_t i = 0; i < pairs.size(); i++)
+    {
+        int a = pairs[i].a;
+        int b = pairs[i].b;
+        float dx = posX[a] - posX[b];
+        float dy = posY[a] - posY[b];
+        float dz = posZ[a] - posZ[b];
+        if (dx * dx + dy * dy + dz * dz < r2)
+        {
+            pairs[kept++] = pairs[i];
+        }
+    }
+    pairs.resize(kept);
+}
@@ -0,0 +1,386 @@
+#include <cmath>
+#include <algorithm>
+
+#include <glm/vec4.hpp>
+
+#include "racebatch.h"
+
+#define PI 3.14159265358979323846
+
+RaceBatch::RaceBatch(const RaceTrack &track, int count, WorkStealingPool *pool)
+    : tick(0), time(0.0f), opponents(track), m_track(&track), m_count(count), m_pool(pool)
+{
+    posX.resize(count);
+    posZ.resize(count);
+    forwardX.resize(count);
+    forwardZ.resize(count);
+    velocityX.resize(count);
+    velocityZ.resize(count);
+    accelerationX.resize(count);
+    accelerationZ.resize(count);
+    lateralX.resize(count);
+    lateralZ.resize(count);
+    boostpower.resize(count);
+    boostTime.resize(count);
+    stunTime.resize(count);
+    endTime.resize(count);
+    raceStart.resize(count);
+    lost.resize(count);
+    checkpoint.resize(count);
+    finished.resize(count);
+    m_hints.resize(count);
+
+    m_cars.resize(count);
+    m_contacts.resize(count);
+    startAll();
+}
+
+void RaceBatch::startAll()
+{
+    tick = 0;
+    time = 0.0f;
+    std::fill(posX.begin(), posX.end(), 0.0f);
+    std::fill(posZ.begin(), posZ.end(), 0.0f);
+    std::fill(forwardX.begin(), forwardX.end(), 1.0f);
+    std::fill(forwardZ.begin(), forwardZ.end(), 0.0f);
+    std::fill(velocityX.begin(), velocityX.end(), 0.0f);
+    std::fill(velocityZ.begin(), velocityZ.end(), 0.0f);
+    std::fill(accelerationX.begin(), accelerationX.end(), 0.0f);
+    std::fill(accelerationZ.begin(), accelerationZ.end(), 0.0f);
+    std::fill(lateralX.begin(), lateralX.end(), 0.0f);
+    std::fill(lateralZ.begin(), lateralZ.end(), 0.0f);
+    std::fill(boostpower.begin(), boostpower.end(), 100.0f);
+    std::fill(boostTime.begin(), boostTime.end(), 0.0f);
+    std::fill(stunTime.begin(), stunTime.end(), 0.0f);
+    std::fill(endTime.begin(), endTime.end(), 0.0f);
+    std::fill(raceStart.begin(), raceStart.end(), 1);
+    std::fill(lost.begin(), lost.end(), 0);
+    std::fill(checkpoint.begin(), checkpoint.end(), 0);
+    std::fill(finished.begin(), finished.end(), 0);
+    opponents.update(0.0f);
+}
+
+int RaceBatch::running() const
+{
+    int count = 0;
+    for (int i = 0; i < m_count; i++)
+    {
+        count += raceStart[i];
+    }
+    return count;
+}
+
+// gira a direcao (fx, fz) por angle radianos em torno do eixo y com o
+// cosseno e o seno que Matrix_Rotate_Y usa (calculados em double e
+// arredondados para float), para os carros girarem exatamente como no RaceSim
+static void turn(float angle, float &fx, float &fz)
+{
+    float c = (float)std::cos((double)angle);
+    float s = (float)std::sin((double)angle);
+    float x = c * fx + s * fz;
+    fz = -s * fx + c * fz;
+    fx = x;
+}
+
+// reflete a velocidade na normal da parede e vira o carro para a nova
+// direcao, a mesma resposta e as mesmas operacoes das paredes retas em
+// RaceSim::step
+void RaceBatch::collideWalls(int r, const Contact &contact)
+{
+    if (contact.wallNormal == glm::vec4(0.0f))
+    {
+        return;
+    }
+    float nx = contact.wallNormal.x;
+    float nz = contact.wallNormal.z;
+    if (stunTime[r] < time)
+    {
+        boostpower[r] -= 10;
+    }
+    float vn = velocityX[r] * nx + velocityZ[r] * nz;
+    float vx = velocityX[r] - 2 * vn * nx;
+    float vz = velocityZ[r] - 2 * vn * nz;
+    velocityX[r] = vx;
+    velocityZ[r] = vz;
+
+    // um carro parado nao tem para onde virar e fica com a sua direcao
+    if (vx * vx + vz * vz > 0)
+    {
+        // glm::normalize multiplica pelo inverso do comprimento
+        float inverse = 1.0f / std::sqrt(vx * vx + vz * vz);
+        float fx = forwardX[r];
+        float fz = forwardZ[r];
+        float dotprod = vx * inverse * fx + vz * inverse * fz;
+        dotprod = std::min(std::max(dotprod, -1.0f), 1.0f);
+        float angle = (float)std::acos((double)dotprod);
+        if (vz * fx - vx * fz > 0)
+        {
+            angle = -angle;
+        }
+        turn(angle, fx, fz);
+        forwardX[r] = fx;
+        forwardZ[r] = fz;
+    }
+    lateralX[r] = -lateralX[r];
+    lateralZ[r] = -lateralZ[r];
+    stunTime[r] = time + 0.5f;
+}
+
+// vira o carro 90 graus para longe da parede curva e divide a velocidade por 2
+void RaceBatch::collideCurves(int r, const Contact &contact)
+{
+    if (!(stunTime[r] < time) || !contact.curve)
+    {
+        return;
+    }
+    const CurveHit &hit = contact.curveHit;
+    boostpower[r] -= 10;
+
+    float dx = hit.normal.x;
+    float dz = hit.normal.z;
+    float fx = forwardX[r];
+    float fz = forwardZ[r];
+    float dotprod = std::min(std::max(dx * fx + dz * fz, -1.0f), 1.0f);
+    float angle = (float)std::acos((double)dotprod);
+    // cross(d, forward).y < 0: a parede esta do outro lado
+    if (dz * fx - dx * fz < 0)
+    {
+        angle = -angle;
+    }
+    if (angle > 0)
+    {
+        turn((float)(-PI / 2), fx, fz);
+    }
+    else if (angle < 0)
+    {
+        turn((float)(PI / 2), fx, fz);
+    }
+    forwardX[r] = fx;
+    forwardZ[r] = fz;
+    float speed = std::sqrt(velocityX[r] * velocityX[r] + velocityZ[r] * velocityZ[r]);
+    velocityX[r] = speed * 0.5f * fx;
+    velocityZ[r] = speed * 0.5f * fz;
+    lateralX[r] = -lateralX[r];
+    lateralZ[r] = -lateralZ[r];
+    stunTime[r] = (float)(time + 0.1);
+}
+
+void RaceBatch::collideOpponents(int r, const Contact &contact)
+{
+    const int *hits = contact.cars;
+    int count = contact.carCount;
+    if (count > Contact::maxCars)
+    {
+        // uma multidao em volta do carro, mais do que cabe no contato
+        opponents.collide(glm::vec4(posX[r], 0.0f, posZ[r], 1.0f), playerHitboxRadius + opponentHitboxRadius, m_opponentHits);
+        hits = m_opponentHits.data();
+        count = (int)m_opponentHits.size();
+    }
+    for (int i = 0; i < count; i++)
+    {
+        int o = hits[i];
+        float dx = posX[r] - opponents.posX[o];
+        float dz = posZ[r] - opponents.posZ[o];
+        if (stunTime[r] < time)
+        {
+            boostpower[r] -= 10;
+        }
+        float len = std::sqrt(dx * dx + dz * dz);
+        float ax = dx / len;
+        float az = dz / len;
+        float va = velocityX[r] * ax + velocityZ[r] * az;
+        velocityX[r] -= 2 * va * ax;
+        velocityZ[r] -= 2 * va * az;
+        lateralX[r] = -lateralX[r];
+        lateralZ[r] = -lateralZ[r];
+        stunTime[r] = time + 0.5f;
+    }
+}
+
+void RaceBatch::step(const RaceInputs *inputs, float dt)
+{
+    tick++;
+    time = raceClock(tick, dt);
+    const float t = time;
+    const int n = m_count;
+
+    // definição dos controles do player e modelo de fisica
+    for (int r = 0; r < n; r++)
+    {
+        if (!raceStart[r])
+        {
+            continue;
+        }
+        const RaceInputs &in = inputs[r];
+        float vx = velocityX[r] - friction * dt * velocityX[r];
+        float vz = velocityZ[r] - friction * dt * velocityZ[r];
+        velocityX[r] = vx;
+        velocityZ[r] = vz;
+
+        // W usa a direcao de antes da curva do A e S a de depois, como no RaceSim
+        float speed = std::sqrt(vx * vx + vz * vz);
+        float rotation = speed > 0 ? std::min(std::max(max_velocity / speed, 0.5f), 2.0f) : 2.0f;
+        float fx = forwardX[r];
+        float fz = forwardZ[r];
+        if (in.forward)
+        {
+            accelerationX[r] += max_velocity * fx * dt;
+            accelerationZ[r] += max_velocity * fz * dt;
+        }
+        if (in.left)
+        {
+            turn(rotation * dt, fx, fz);
+        }
+        if (in.back)
+        {
+            accelerationX[r] -= max_velocity * fx * dt;
+            accelerationZ[r] -= max_velocity * fz * dt;
+        }
+        if (in.right)
+        {
+            turn(-rotation * dt, fx, fz);
+        }
+        forwardX[r] = fx;
+        forwardZ[r] = fz;
+    }
+
+    // strafe e boost
+    for (int r = 0; r < n; r++)
+    {
+        if (!raceStart[r])
+        {
+            continue;
+        }
+        const RaceInputs &in = inputs[r];
+        float fx = forwardX[r];
+        float fz = forwardZ[r];
+        // carLeft = up x forward
+        float strafe = 0.0f;
+        if (stunTime[r] < t)
+        {
+            strafe = (in.strafeLeft && !in.strafeRight ? 1.0f : 0.0f) - (in.strafeRight && !in.strafeLeft ? 1.0f : 0.0f);
+        }
+        lateralX[r] = strafe * fz * max_velocity * 30.0f * dt;
+        lateralZ[r] = strafe * -fx * max_velocity * 30.0f * dt;
+
+        if (in.boost && boostTime[r] < t && boostpower[r] > 1)
+        {
+            boostpower[r] -= 22;
+            if (boostpower[r] <= 0)
+            {
+                boostpower[r] = 1;
+            }
+            accelerationX[r] += 10.0f * max_velocity * fx * dt;
+            accelerationZ[r] += 10.0f * max_velocity * fz * dt;
+            velocityX[r] += max_velocity * fx;
+            velocityZ[r] += max_velocity * fz;
+            boostTime[r] = t + 5;
+        }
+    }
+
+    // velocidade sempre na direcao do carro
+    for (int r = 0; r < n; r++)
+    {
+        if (!raceStart[r])
+        {
+            continue;
+        }
+        float vx = velocityX[r];
+        float vz = velocityZ[r];
+        float ax = accelerationX[r];
+        float az = accelerationZ[r];
+        float speed = std::sqrt(vx * vx + vz * vz);
+        if (ax == 0 && az == 0 && speed < 0.5f)
+        {
+            speed = 0;
+        }
+        float fx = forwardX[r];
+        float fz = forwardZ[r];
+        float sign = (vx * fx + vz * fz < 0) ? -1.0f : 1.0f;
+        velocityX[r] = sign * speed * fx + ax;
+        velocityZ[r] = sign * speed * fz + az;
+    }
+
+    // colisao com oponentes, paredes retas e curvas: as consultas de todos os
+    // carros em uma chamada (as posicoes so mudam no movimento), depois a
+    // resposta de cada corrida
+    for (int r = 0; r < n; r++)
+    {
+        m_cars[r].x = posX[r];
+        m_cars[r].z = posZ[r];
+    }
+    CarSpheres spheres = opponents.spheres();
+    CollideOptions options;
+    options.halfExtent = playerHalfExtent;
+    options.radius = playerHitboxRadius;
+    options.spheres = &spheres;
+    options.sphereReach = playerHitboxRadius + opponentHitboxRadius;
+    options.hints = m_hints.data();
+    options.pool = m_pool;
+    options.scratch = &m_candidates;
+    m_track->world.collideAll(m_cars.data(), n, m_contacts.data(), options);
+    for (int r = 0; r < n; r++)
+    {
+        if (!raceStart[r])
+        {
+            continue;
+        }
+        collideOpponents(r, m_contacts[r]);
+        collideWalls(r, m_contacts[r]);
+        collideCurves(r, m_contacts[r]);
+    }
+
+    // os checkpoints usam a hitbox de antes do movimento, como no RaceSim
+    for (int r = 0; r < n; r++)
+    {
+        if (!raceStart[r])
+        {
+            continue;
+        }
+        if (!finished[r])
+        {
+            lost[r] = t > raceTimeLimit;
+        }
+        const glm::vec4 &normal = m_contacts[r].checkpointNormal;
+        if (normal.x == 1)
+        {
+            checkpoint[r] = 1;
+        }
+        if (normal.y == 1 && checkpoint[r])
+        {
+            finished[r] = 1;
+        }
+    }
+
+    // movimento continuo: com passos longos (boost, tickrate baixo) o carro
+    // para na primeira parede ou curva do caminho em vez de atravessa-la
+    for (int r = 0; r < n; r++)
+    {
+        if (!raceStart[r])
+        {
+            continue;
+        }
+        glm::vec4 movement((velocityX[r] + lateralX[r]) * dt, 0.0f, (velocityZ[r] + lateralZ[r]) * dt, 0.0f);
+        float fraction = m_track->world.sweepFraction(glm::vec4(posX[r], 0.0f, posZ[r], 1.0f), playerHalfExtent, playerHitboxRadius, movement);
+        posX[r] += movement.x * fraction;
+        posZ[r] += movement.z * fraction;
+        accelerationX[r] = 0;
+        accelerationZ[r] = 0;
+    }
+
+    // win/lose logic
+    for (int r = 0; r < n; r++)
+    {
+        if (!raceStart[r])
+        {
+            continue;
+        }
+        if (finished[r] || boostpower[r] <= 0)
+        {
+            raceStart[r] = 0;
+            endTime[r] = t;
+        }
+    }
+
+    opponents.update(t);
+}
@@ -0,0 +1,334 @@
+#include <cmath>
+#include <algorithm>
+
+#include "raceprogress.h"
+
+// segments on each side of the last answer tested by follow(), a car moves
+// less than one per tick even boosting
+static const int followSegments = 4;
+
+TrackProgress::TrackProgress()
+    : m_spacing(1.0f), m_inverseSpacing(1.0f), m_length(0.0f), m_closed(false),
+      m_originX(0.0f), m_originZ(0.0f), m_inverseCellSize(1.0f), m_cellsX(0), m_cellsZ(0), m_reach(0.0f)
+{
+}
+
+void TrackProgress::build(const BezierSpline &centerline, float spacing, float cellSize, float reach)
+{
+    m_x.clear();
+    m_z.clear();
+    m_dirX.clear();
+    m_dirZ.clear();
+    m_tangentX.clear();
+    m_tangentZ.clear();
+    m_segmentLength.clear();
+    m_cellStart.assign(1, 0);
+    m_cellSegments.clear();
+    m_cellsX = m_cellsZ = 0;
+    m_closed = centerline.closed();
+    m_reach = reach;
+    if (centerline.segments() == 0)
+    {
+        m_length = 0.0f;
+        return;
+    }
+
+    // polyline through evenly spaced points along the curve
+    ArcLengthTable table;
+    table.build(centerline, spacing * 0.25f);
+    m_length = table.length();
+    int segments = std::max((int)std::ceil(m_length / spacing), 1);
+    m_spacing = m_length / segments;
+    m_inverseSpacing = m_length > 0.0f ? 1.0f / m_spacing : 0.0f;
+    for (int i = 0; i <= segments; i++)
+    {
+        glm::vec4 point, tangent;
+        table.sample(i * m_spacing, point, tangent);
+        m_x.push_back(point.x);
+        m_z.push_back(point.z);
+        float length = std::sqrt(tangent.x * tangent.x + tangent.z * tangent.z);
+        m_tangentX.push_back(length > 0.0f ? tangent.x / length : 1.0f);
+        m_tangentZ.push_back(length > 0.0f ? tangent.z / length : 0.0f);
+    }
+    for (int s = 0; s < segments; s++)
+    {
+        float dx = m_x[s + 1] - m_x[s], dz = m_z[s + 1] - m_z[s];
+        float length = std::sqrt(dx * dx + dz * dz);
+        m_segmentLength.push_back(length);
+        m_dirX.push_back(length > 0.0f ? dx / length : 1.0f);
+        m_dirZ.push_back(length > 0.0f ? dz / length : 0.0f);
+    }
+
+    // every segment goes into the cells its bounding box, grown by reach,
+    // touches. Counted first, then filled
+    float minX = *std::min_element(m_x.begin(), m_x.end()) - reach;
+    float maxX = *std::max_element(m_x.begin(), m_x.end()) + reach;
+    float minZ = *std::min_element(m_z.begin(), m_z.end()) - reach;
+    float maxZ = *std::max_element(m_z.begin(), m_z.end()) + reach;
+    m_originX = minX;
+    m_originZ = minZ;
+    m_inverseCellSize = 1.0f / cellSize;
+    m_cellsX = (int)std::ceil((maxX - minX) * m_inverseCellSize) + 1;
+    m_cellsZ = (int)std::ceil((maxZ - minZ) * m_inverseCellSize) + 1;
+    std::vector<int> range(segments * 4);
+    for (int s = 0; s < segments; s++)
+    {
+        range[s * 4 + 0] = (int)((std::min(m_x[s], m_x[s + 1]) - reach - m_originX) * m_inverseCellSize);
+        range[s * 4 + 1] = (int)((std::max(m_x[s], m_x[s + 1]) + reach - m_originX) * m_inverseCellSize);
+        range[s * 4 + 2] = (int)((std::min(m_z[s], m_z[s + 1]) - reach - m_originZ) * m_inverseCellSize);
+        range[s * 4 + 3] = (int)((std::max(m_z[s], m_z[s + 1]) + reach - m_originZ) * m_inverseCellSize);
+    }
+    m_cellStart.assign(m_cellsX * m_cellsZ + 1, 0);
+    for (int s = 0; s < segments; s++)
+    {
+        for (int cz = range[s * 4 + 2]; cz <= range[s * 4 + 3]; cz++)
+        {
+            for (int cx = range[s * 4 + 0]; cx <= range[s * 4 + 1]; cx++)
+            {
+                m_cellStart[cz * m_cellsX + cx + 1]++;
+            }
+        }
+    }
+    for (int c = 0; c < m_cellsX * m_cellsZ; c++)
+    {
+        m_cellStart[c + 1] += m_cellStart[c];
+    }
+    m_cellSegments.resize(m_cellStart.back());
+    std::vector<int> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (int s = 0; s < segments; s++)
+    {
+        for (int cz = range[s * 4 + 2]; cz <= range[s * 4 + 3]; cz++)
+        {
+            for (int cx = range[s * 4 + 0]; cx <= range[s * 4 + 1]; cx++)
+            {
+                m_cellSegments[fill[cz * m_cellsX + cx]++] = s;
+            }
+        }
+    }
+}
+
+int TrackProgress::segmentAt(float distance) const
+{
+    int s = (int)(distance * m_inverseSpacing);
+    return std::min(std::max(s, 0), (int)m_segmentLength.size() - 1);
+}
+
+float TrackProgress::closest(float x, float z, int first, int last, int &segment, float &along) const
+{
+    const int segments = (int)m_segmentLength.size();
+    float best = 1e30f;
+    for (int k = first; k <= last; k++)
+    {
+        int s = k < 0 ? k + segments : (k >= segments ? k - segments : k);
+        float px = x - m_x[s], pz = z - m_z[s];
+        float a = std::min(std::max(px * m_dirX[s] + pz * m_dirZ[s], 0.0f), m_segmentLength[s]);
+        float dx = px - a * m_dirX[s], dz = pz - a * m_dirZ[s];
+        float d2 = dx * dx + dz * dz;
+        if (d2 < best)
+        {
+            best = d2;
+            segment = s;
+            along = a;
+        }
+    }
+    return best;
+}
+
+float TrackProgress::distanceOn(int segment, float x, float z, float along) const
+{
+    // the normals of the curve fan out between the two points of the
+    // segment, the point is on the one at fraction a where
+    //   (q - p0 - a * chord) . lerp(t0, t1, a) = 0
+    // Off the centerline in a bend the foot on the chord alone is off by
+    // up to a few tens of centimeters
+    int s = segment;
+    float wx = x - m_x[s], wz = z - m_z[s];
+    float cx = m_x[s + 1] - m_x[s], cz = m_z[s + 1] - m_z[s];
+    float tx = m_tangentX[s], tz = m_tangentZ[s];
+    float dx = m_tangentX[s + 1] - tx, dz = m_tangentZ[s + 1] - tz;
+    float qa = -(cx * dx + cz * dz);
+    float qb = wx * dx + wz * dz - (cx * tx + cz * tz);
+    float qc = wx * tx + wz * tz;
+    float discriminant = qb * qb - 4.0f * qa * qc;
+    float a;
+    if (discriminant >= 0.0f && qb < 0.0f)
+    {
+        // the root near -qc / qb, without the cancellation of the usual formula
+        a = 2.0f * qc / (-qb + std::sqrt(discriminant));
+    }
+    else
+    {
+        // the chord is a little shorter than the arc it stands for
+        float chord = m_segmentLength[s];
+        a = chord > 0.0f ? along / chord : 0.0f;
+    }
+    a = std::min(std::max(a, 0.0f), 1.0f);
+    return (s + a) * m_spacing;
+}
+
+float TrackProgress::locate(float x, float z) const
+{
+    const int segments = (int)m_segmentLength.size();
+    if (segments == 0)
+    {
+        return 0.0f;
+    }
+    int segment = 0;
+    float along = 0.0f;
+    float best = 1e30f;
+    int cx = (int)std::floor((x - m_originX) * m_inverseCellSize);
+    int cz = (int)std::floor((z - m_originZ) * m_inverseCellSize);
+    if (cx >= 0 && cx < m_cellsX && cz >= 0 && cz < m_cellsZ)
+    {
+        int cell = cz * m_cellsX + cx;
+        for (int i = m_cellStart[cell]; i < m_cellStart[cell + 1]; i++)
+        {
+            int s = 0;
+            float sa = 0.0f;
+            float d2 = closest(x, z, m_cellSegments[i], m_cellSegments[i], s, sa);
+            if (d2 < best)
+            {
+                best = d2;
+                segment = s;
+                along = sa;
+            }
+        }
+    }
+    // a segment closer than reach is listed in the cell, one farther away
+    // may not be
+    if (best > m_reach * m_reach)
+    {
+        closest(x, z, 0, segments - 1, segment, along);
+    }
+    return distanceOn(segment, x, z, along);
+}
+
+float TrackProgress::follow(float x, float z, float hint) const
+{
+    const int segments = (int)m_segmentLength.size();
+    if (segments <= 2 * followSegments + 1)
+    {
+        return locate(x, z);
+    }
+    int center = segmentAt(hint);
+    int first = center - followSegments, last = center + followSegments;
+    if (!m_closed)
+    {
+        first = std::max(first, 0);
+        last = std::min(last, segments - 1);
+    }
+    int segment = 0;
+    float along = 0.0f;
+    float best = closest(x, z, first, last, segment, along);
+    // the closest point on the ends of the window may be farther on
+    int firstSegment = first < 0 ? first + segments : first;
+    int lastSegment = last >= segments ? last - segments : last;
+    if (best > m_reach * m_reach || (segment == firstSegment && along == 0.0f && (m_closed || first > 0)) ||
+        (segment == lastSegment && along == m_segmentLength[segment] && (m_closed || last < segments - 1)))
+    {
+        return locate(x, z);
+    }
+    return distanceOn(segment, x, z, along);
+}
+
+void TrackProgress::direction(float distance, float &fx, float &fz) const
+{
+    if (m_segmentLength.empty())
+    {
+        fx = 1.0f;
+        fz = 0.0f;
+        return;
+    }
+    int s = segmentAt(distance);
+    fx = m_dirX[s];
+    fz = m_dirZ[s];
+}
+
+RaceRanking::RaceRanking(const TrackProgress &track)
+    : m_track(&track)
+{
+}
+
+void RaceRanking::reset(int cars)
+{
+    m_distance.assign(cars, 0.0f);
+    m_lap.assign(cars, 0);
+    m_progress.assign(cars, 0.0f);
+    m_wrongWayTime.assign(cars, 0.0f);
+    m_order.resize(cars);
+    m_position.resize(cars);
+    for (int i = 0; i < cars; i++)
+    {
+        m_order[i] = i;
+        m_position[i] = i;
+    }
+}
+
+void RaceRanking::place(int car, float x, float z)
+{
+    float length = m_track->length();
+    float d = m_track->locate(x, z);
+    m_distance[car] = d;
+    m_lap[car] = m_track->closed() && d > 0.5f * length ? -1 : 0;
+    m_progress[car] = m_lap[car] + (length > 0.0f ? d / length : 0.0f);
+    m_wrongWayTime[car] = 0.0f;
+}
+
+void RaceRanking::update(int car, float x, float z, float fx, float fz, float dt)
+{
+    float length = m_track->length();
+    float last = m_distance[car];
+    float d = m_track->follow(x, z, last);
+    float step = d - last;
+    // a jump of more than half a lap is crossing the start of the lap
+    if (m_track->closed())
+    {
+        if (step < -0.5f * length)
+        {
+            m_lap[car]++;
+            step += length;
+        }
+        else if (step > 0.5f * length)
+        {
+            m_lap[car]--;
+            step -= length;
+        }
+    }
+    m_distance[car] = d;
+    m_progress[car] = m_lap[car] + (length > 0.0f ? d / length : 0.0f);
+
+    float dx, dz;
+    m_track->direction(d, dx, dz);
+    if (step < 0.0f && fx * dx + fz * dz < 0.0f)
+    {
+        m_wrongWayTime[car] += dt;
+    }
+    else
+    {
+        m_wrongWayTime[car] = 0.0f;
+    }
+}
+
+void RaceRanking::rank()
+{
+    // from one tick to the next only a few cars pass each other, the last
+    // order is almost sorted and the insertion sort almost linear. Ties keep
+    // the lower index first so the order is deterministic
+    const int cars = size();
+    for (int i = 1; i < cars; i++)
+    {
+        int car = m_order[i];
+        float p = m_progress[car];
+        int j = i;
+        while (j > 0 && (m_progress[m_order[j - 1]] < p || (m_progress[m_order[j - 1]] == p && m_order[j - 1] > car)))
+        {
+            m_order[j] = m_order[j - 1];
+            j--;
+        }
+        m_order[j] = car;
+    }
+    for (int i = 0; i < cars; i++)
+    {
+        m_position[m_order[i]] = i;
+    }
+}
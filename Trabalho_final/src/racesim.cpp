@@ -0,0 +1,368 @@
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include "matrices.h"
+#include "racesim.h"
+
+#define PI 3.14159265358979323846
+
+static const glm::vec4 nullvector = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
+static const glm::vec4 up_vector = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
+
+RaceSim::RaceSim(const RaceTrack &track)
+    : opponents(track), m_track(&track), m_opponentsStale(false)
+{
+    reset();
+}
+
+void RaceSim::reset()
+{
+    RaceState &s = state;
+    s.tick = 0;
+    s.time = 0.0f;
+
+    s.carForward = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+    s.current_velocity = nullvector;
+    s.acceleration = nullvector;
+    s.lateral_velocity = nullvector;
+    s.carPos = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    s.modelPlayer = Matrix_Identity();
+    s.modelPlayer = Matrix_Translate(s.carPos.x, s.carPos.y, s.carPos.z) * s.modelPlayer;
+    s.modelPlayer = Matrix_Rotate_Y(3.141592 / 2) * s.modelPlayer;
+    s.pBox.minPoint = glm::vec4(s.carPos.x - playerHalfExtent, s.carPos.y - playerHalfExtent, s.carPos.z - playerHalfExtent, s.carPos.w);
+    s.pBox.maxPoint = glm::vec4(s.carPos.x + playerHalfExtent, s.carPos.y + playerHalfExtent, s.carPos.z + playerHalfExtent, s.carPos.w);
+    s.pBox.normal = nullvector;
+    s.boostpower = 100.0f;
+    s.boostTime = 0;
+    s.stunTime = 0;
+    s.hasRotatedL = false;
+    s.hasRotatedR = false;
+
+    s.raceStart = false;
+    s.lost = false;
+    s.checkpoint = false;
+    s.finished = false;
+
+    opponents.update(0.0f);
+    m_opponentsStale = false;
+}
+
+void RaceSim::start()
+{
+    reset();
+    state.raceStart = true;
+}
+
+void RaceSim::save(RaceSnapshot &snapshot) const
+{
+    snapshot.version = RACE_SNAPSHOT_VERSION;
+    snapshot.size = sizeof(RaceState);
+    std::memcpy(&snapshot.state, &state, sizeof(RaceState));
+}
+
+bool RaceSim::restore(const RaceSnapshot &snapshot)
+{
+    if (snapshot.version != RACE_SNAPSHOT_VERSION || snapshot.size != sizeof(RaceState))
+    {
+        return false;
+    }
+    std::memcpy(&state, &snapshot.state, sizeof(RaceState));
+    // mover uma multidao de oponentes deixaria o restore O(oponentes), eles
+    // sao movidos pelo proximo step() ou syncOpponents()
+    m_opponentsStale = true;
+    return true;
+}
+
+void RaceSim::syncOpponents()
+{
+    if (m_opponentsStale)
+    {
+        opponents.update(state.time);
+        m_opponentsStale = false;
+    }
+}
+
+// gira o carro do player em torno do proprio centro por angle radianos no eixo y
+static void rotatePlayer(RaceState &s, float angle)
+{
+    glm::mat4 rotation = Matrix_Rotate_Y(angle);
+    s.carForward = Matrix_Multiply(rotation, s.carForward);
+    glm::mat4 around = Matrix_Multiply(Matrix_Multiply(Matrix_Translate(s.carPos.x, s.carPos.y, s.carPos.z), rotation), Matrix_Translate(-s.carPos.x, -s.carPos.y, -s.carPos.z));
+    s.modelPlayer = Matrix_Multiply(around, s.modelPlayer);
+}
+
+// inclina o modelo do carro do player em torno do vetor forward, usado no strafe
+static void tiltPlayer(RaceState &s, float angle)
+{
+    glm::mat4 around = Matrix_Multiply(Matrix_Multiply(Matrix_Translate(s.carPos.x, s.carPos.y, s.carPos.z), Matrix_Rotate(angle, s.carForward)), Matrix_Translate(-s.carPos.x, -s.carPos.y, -s.carPos.z));
+    s.modelPlayer = Matrix_Multiply(around, s.modelPlayer);
+}
+
+void RaceSim::step(const RaceInputs &inputs, float dt)
+{
+    syncOpponents();
+    RaceState &s = state;
+    if (!s.raceStart)
+    {
+        return;
+    }
+    s.tick++;
+    s.time = raceClock(s.tick, dt);
+    float current_time = s.time;
+
+    // definição dos controles do player e modelo de fisica
+    s.current_velocity -= friction * dt * s.current_velocity;
+    if (inputs.forward)
+    {
+        s.acceleration += max_velocity * s.carForward * dt;
+    }
+    if (inputs.left)
+    {
+        float velocity_norm = norm(s.current_velocity);
+        float rotation = 2.0f;
+        if (velocity_norm > 0)
+        {
+            rotation = std::min(std::max(max_velocity / velocity_norm, 0.5f), 2.0f);
+        }
+        rotatePlayer(s, rotation * dt);
+    }
+    if (inputs.back)
+    {
+        s.acceleration -= max_velocity * s.carForward * dt;
+    }
+    if (inputs.right)
+    {
+        float velocity_norm = norm(s.current_velocity);
+        float rotation = 2.0f;
+        if (velocity_norm > 0)
+        {
+            rotation = std::min(std::max(max_velocity / velocity_norm, 0.5f), 2.0f);
+        }
+        rotatePlayer(s, -rotation * dt);
+    }
+
+    s.lateral_velocity = nullvector;
+    glm::vec4 carLeft = crossproduct(up_vector, s.carForward);
+    glm::vec4 carRight = -carLeft;
+    if (s.hasRotatedL)
+    {
+        tiltPlayer(s, PI / 20);
+        s.hasRotatedL = false;
+    }
+    if (s.hasRotatedR)
+    {
+        tiltPlayer(s, -PI / 20);
+        s.hasRotatedR = false;
+    }
+    if (inputs.strafeLeft && !inputs.strafeRight && (s.stunTime < current_time))
+    {
+        s.lateral_velocity += carLeft * max_velocity * 30.0f * dt;
+        if (!s.hasRotatedL)
+        {
+            s.hasRotatedL = true;
+            tiltPlayer(s, -PI / 20);
+        }
+    }
+    if (inputs.strafeRight && !inputs.strafeLeft && (s.stunTime < current_time))
+    {
+        s.lateral_velocity += carRight * max_velocity * 30.0f * dt;
+        if (!s.hasRotatedR)
+        {
+            s.hasRotatedR = true;
+            tiltPlayer(s, PI / 20);
+        }
+    }
+    if (inputs.boost && (s.boostTime < current_time) && s.boostpower > 1)
+    {
+        s.boostpower -= 22;
+        if (s.boostpower <= 0)
+        {
+            s.boostpower = 1;
+        }
+        s.acceleration += 10.0f * max_velocity * s.carForward * dt;
+        s.current_velocity += 1.0f * max_velocity * s.carForward;
+        s.boostTime = current_time + 5;
+    }
+
+    if (norm(s.acceleration) == 0 && norm(s.current_velocity) < 0.5)
+    {
+        s.current_velocity *= 0;
+    }
+
+    if (dotproduct(s.current_velocity, s.carForward) < 0)
+    {
+        s.current_velocity = norm(s.current_velocity) * -s.carForward + s.acceleration;
+    }
+    else
+    {
+        s.current_velocity = norm(s.current_velocity) * s.carForward + s.acceleration;
+    }
+
+    // colisao com oponentes
+    opponents.collide(s.carPos, playerHitboxRadius + opponentHitboxRadius, m_opponentHits);
+    for (size_t i = 0; i < m_opponentHits.size(); i++)
+    {
+        glm::vec4 opponentPos = opponents.position(m_opponentHits[i]);
+        if (s.stunTime < current_time)
+        {
+            s.boostpower -= 10;
+        }
+        glm::vec4 yfilter = glm::vec4(1.0f, 0.0f, 1.0f, 0.0f);
+        glm::vec4 axis = ((s.carPos * yfilter - opponentPos * yfilter)) / norm((s.carPos * yfilter) - (opponentPos * yfilter));
+        s.current_velocity = (s.current_velocity - 2 * (dotproduct(s.current_velocity, axis)) * axis);
+        if (norm(s.lateral_velocity) != 0)
+        {
+            s.lateral_velocity = -s.lateral_velocity;
+        }
+        s.stunTime = current_time + 0.5;
+    }
+
+    // colisao com as paredes retas
+    s.pBox.minPoint = glm::vec4(s.carPos.x - playerHalfExtent, s.carPos.y - playerHalfExtent, s.carPos.z - playerHalfExtent, s.carPos.w);
+    s.pBox.maxPoint = glm::vec4(s.carPos.x + playerHalfExtent, s.carPos.y + playerHalfExtent, s.carPos.z + playerHalfExtent, s.carPos.w);
+    glm::vec4 normal = m_track->world.wallNormal(s.pBox, m_hint);
+    if (normal != nullvector)
+    {
+        if (s.stunTime < current_time)
+        {
+            s.boostpower -= 10;
+        }
+        s.current_velocity = (s.current_velocity - 2 * (dotproduct(s.current_velocity, normal)) * normal);
+        // um carro parado nao tem para onde virar e fica com a sua direcao
+        if (norm(s.current_velocity) > 0)
+        {
+            float dotprod = dotproduct(normalize(s.current_velocity), s.carForward);
+            if (dotprod > 1)
+            {
+                dotprod = 1;
+            }
+            if (dotprod < -1)
+            {
+                dotprod = -1;
+            }
+            float angle = acos(dotprod);
+            glm::vec4 cross = crossproduct(s.current_velocity, s.carForward);
+            if (cross.y > 0)
+            {
+                angle = -1 * angle;
+            }
+            rotatePlayer(s, angle);
+        }
+        if (norm(s.lateral_velocity) != 0)
+        {
+            s.lateral_velocity = -s.lateral_velocity;
+        }
+        s.stunTime = current_time + 0.5;
+    }
+
+    // colisao com as curvas
+    CurveHit curveHit;
+    if (m_track->world.curveContact(s.carPos, playerHitboxRadius, curveHit, m_hint))
+    {
+        if (s.stunTime < current_time)
+        {
+            s.boostpower -= 10;
+
+            float dotprod = dotproduct(curveHit.normal, s.carForward);
+            if (dotprod > 1)
+            {
+                dotprod = 1;
+            }
+            if (dotprod < -1)
+            {
+                dotprod = -1;
+            }
+            float angle = acos(dotprod);
+            glm::vec4 cross = crossproduct(curveHit.normal, s.carForward);
+            if (cross.y < 0)
+            {
+                angle = -1 * angle;
+            }
+            if (angle > 0)
+            {
+                rotatePlayer(s, -PI / 2);
+            }
+            else if (angle < 0)
+            {
+                rotatePlayer(s, PI / 2);
+            }
+            s.current_velocity = norm(s.current_velocity) * 0.5f * s.carForward;
+
+            if (norm(s.lateral_velocity) != 0)
+            {
+                s.lateral_velocity = -s.lateral_velocity;
+            }
+            s.stunTime = current_time + 0.1;
+        }
+    }
+
+    // movimento continuo: com passos longos (boost, tickrate baixo) o carro
+    // para na primeira parede ou curva do caminho em vez de atravessa-la
+    glm::vec4 frame_movement = (s.current_velocity + s.lateral_velocity) * dt;
+    frame_movement *= m_track->world.sweepFraction(s.carPos, playerHalfExtent, playerHitboxRadius, frame_movement);
+    s.modelPlayer = Matrix_Multiply(Matrix_Translate(frame_movement.x, frame_movement.y, frame_movement.z), s.modelPlayer);
+    s.carPos += frame_movement;
+    s.acceleration *= 0;
+
+    // comportamento dos oponentes
+    opponents.update(current_time);
+
+    // win/lose logic
+    if (!s.finished)
+    {
+        s.lost = current_time > raceTimeLimit;
+    }
+    glm::vec4 checkNormal = m_track->world.checkpointNormal(s.pBox, m_hint);
+    if (checkNormal.x == 1 /*colisao com checkpoint*/)
+    {
+        s.checkpoint = true;
+    }
+    if (checkNormal.y == 1 /*colisao com final*/)
+    {
+        if (s.checkpoint)
+        {
+            s.finished = true;
+        }
+    }
+    if (s.finished || s.boostpower <= 0)
+    {
+        s.raceStart = false;
+    }
+}
+
+FixedTimestep::FixedTimestep(float tickRate, int maxTicksPerFrame)
+    : tickDt(1.0f / tickRate), accumulator(0.0f), maxTicksPerFrame(maxTicksPerFrame)
+{
+}
+
+int FixedTimestep::advance(float frameDt)
+{
+    accumulator += frameDt;
+    int ticks = (int)(accumulator / tickDt);
+    accumulator -= ticks * tickDt;
+    if (ticks > maxTicksPerFrame)
+    {
+        // descarta o tempo que nao deu para simular em vez de atrasar cada vez mais
+        ticks = maxTicksPerFrame;
+    }
+    return ticks;
+}
+
+float FixedTimestep::alpha() const
+{
+    return accumulator / tickDt;
+}
+
+void FixedTimestep::reset()
+{
+    accumulator = 0.0f;
+}
+
+glm::mat4 interpolateModel(const glm::mat4 &previous, const glm::mat4 &current, float alpha)
+{
+    return previous + (current - previous) * alpha;
+}
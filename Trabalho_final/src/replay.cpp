@@ -0,0 +1,409 @@
+#include <cstddef>
+#include <cstring>
+
+#include "mappedfile.h"
+#include "replay.h"
+
+static const char replayMagic[4] = {'F', 'Z', 'R', 'P'};
+
+ReplaySetup::ReplaySetup()
+    : extraOpponents(0), wallField(false)
+{
+}
+
+bool operator==(const ReplaySetup &a, const ReplaySetup &b)
+{
+    return a.extraOpponents == b.extraOpponents && a.wallField == b.wallField;
+}
+
+bool operator!=(const ReplaySetup &a, const ReplaySetup &b)
+{
+    return !(a == b);
+}
+
+unsigned char packInputs(const RaceInputs &inputs)
+{
+    return (inputs.forward ? 1 : 0) |
+           (inputs.left ? 2 : 0) |
+           (inputs.back ? 4 : 0) |
+           (inputs.right ? 8 : 0) |
+           (inputs.boost ? 16 : 0) |
+           (inputs.strafeLeft ? 32 : 0) |
+           (inputs.strafeRight ? 64 : 0);
+}
+
+RaceInputs unpackInputs(unsigned char bits)
+{
+    RaceInputs inputs;
+    inputs.forward = (bits & 1) != 0;
+    inputs.left = (bits & 2) != 0;
+    inputs.back = (bits & 4) != 0;
+    inputs.right = (bits & 8) != 0;
+    inputs.boost = (bits & 16) != 0;
+    inputs.strafeLeft = (bits & 32) != 0;
+    inputs.strafeRight = (bits & 64) != 0;
+    return inputs;
+}
+
+// unsigned LEB128: 7 bits per byte, high bit set while more bytes follow
+static void writeVarint(FILE *file, unsigned int value)
+{
+    while (value >= 0x80)
+    {
+        fputc((int)((value & 0x7f) | 0x80), file);
+        value >>= 7;
+    }
+    fputc((int)value, file);
+}
+
+static bool readVarint(const std::vector<unsigned char> &data, size_t &cursor, unsigned int &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        if (cursor >= data.size())
+        {
+            return false;
+        }
+        unsigned char byte = data[cursor++];
+        value |= (unsigned int)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static const char replayIndexMagic[4] = {'F', 'Z', 'R', 'I'};
+static const size_t replayFooterSize = 2 * sizeof(unsigned int) + sizeof(replayIndexMagic);
+
+// size of the keyframe record at cursor, after its varint 0, or 0 if it is
+// truncated. Snapshots saved by other builds may have another size
+static size_t keyframeSize(const std::vector<unsigned char> &data, size_t cursor)
+{
+    size_t header = 1 + sizeof(unsigned int) + offsetof(RaceSnapshot, state);
+    if (cursor + header > data.size())
+    {
+        return 0;
+    }
+    unsigned int stateSize;
+    memcpy(&stateSize, &data[cursor + header - sizeof(stateSize)], sizeof(stateSize));
+    if (cursor + header + stateSize > data.size())
+    {
+        return 0;
+    }
+    return header + stateSize;
+}
+
+ReplayWriter::ReplayWriter()
+    : m_file(NULL), m_ticks(0), m_runBits(0), m_runLength(0), m_keyframeInterval(0)
+{
+}
+
+ReplayWriter::~ReplayWriter()
+{
+    close();
+}
+
+bool ReplayWriter::open(const char *filename, float tickRate, const ReplaySetup &setup, unsigned int keyframeInterval)
+{
+    close();
+    m_file = fopen(filename, "wb");
+    if (!m_file)
+    {
+        fprintf(stderr, "ERROR: Cannot open replay file \"%s\" for writing.\n", filename);
+        return false;
+    }
+    unsigned short version = REPLAY_VERSION;
+    fwrite(replayMagic, 1, sizeof(replayMagic), m_file);
+    fwrite(&version, sizeof(version), 1, m_file);
+    fwrite(&tickRate, sizeof(tickRate), 1, m_file);
+    fwrite(&keyframeInterval, sizeof(keyframeInterval), 1, m_file);
+    unsigned char flags = setup.wallField ? 1 : 0;
+    fwrite(&setup.extraOpponents, sizeof(setup.extraOpponents), 1, m_file);
+    fwrite(&flags, sizeof(flags), 1, m_file);
+    m_ticks = 0;
+    m_runLength = 0;
+    m_keyframeInterval = keyframeInterval;
+    m_index.clear();
+    return true;
+}
+
+void ReplayWriter::flushRun()
+{
+    if (m_runLength > 0)
+    {
+        writeVarint(m_file, m_runLength);
+        fputc(m_runBits, m_file);
+        m_runLength = 0;
+    }
+}
+
+void ReplayWriter::record(const RaceInputs &inputs)
+{
+    if (!m_file)
+    {
+        return;
+    }
+    unsigned char bits = packInputs(inputs);
+    if (m_runLength > 0 && bits != m_runBits)
+    {
+        flushRun();
+    }
+    m_runBits = bits;
+    m_runLength++;
+    m_ticks++;
+}
+
+void ReplayWriter::record(const RaceInputs &inputs, const RaceSim &sim)
+{
+    if (m_file && m_keyframeInterval > 0 && m_ticks % m_keyframeInterval == 0)
+    {
+        flushRun();
+        IndexEntry entry;
+        entry.tick = (unsigned int)m_ticks;
+        entry.offset = (unsigned int)ftell(m_file);
+        m_index.push_back(entry);
+
+        RaceSnapshot snapshot;
+        sim.save(snapshot);
+        writeVarint(m_file, 0);
+        fputc('K', m_file);
+        fwrite(&entry.tick, sizeof(entry.tick), 1, m_file);
+        fwrite(&snapshot, sizeof(snapshot), 1, m_file);
+    }
+    record(inputs);
+}
+
+void ReplayWriter::close()
+{
+    if (!m_file)
+    {
+        return;
+    }
+    flushRun();
+    writeVarint(m_file, 0);
+    fputc('E', m_file);
+
+    unsigned int indexOffset = (unsigned int)ftell(m_file);
+    for (size_t i = 0; i < m_index.size(); i++)
+    {
+        fwrite(&m_index[i].tick, sizeof(m_index[i].tick), 1, m_file);
+        fwrite(&m_index[i].offset, sizeof(m_index[i].offset), 1, m_file);
+    }
+    unsigned int count = (unsigned int)m_index.size();
+    fwrite(&count, sizeof(count), 1, m_file);
+    fwrite(&indexOffset, sizeof(indexOffset), 1, m_file);
+    fwrite(replayIndexMagic, 1, sizeof(replayIndexMagic), m_file);
+
+    fclose(m_file);
+    m_file = NULL;
+}
+
+ReplayReader::ReplayReader()
+    : m_version(0), m_runsBegin(0), m_cursor(0), m_tickRate(SIM_TICK_RATE), m_tick(0), m_runBits(0), m_runLeft(0), m_ended(true)
+{
+}
+
+bool ReplayReader::open(const char *filename)
+{
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+    {
+        fprintf(stderr, "ERROR: Cannot open replay file \"%s\".\n", filename);
+        return false;
+    }
+    m_data.clear();
+    unsigned char buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        m_data.insert(m_data.end(), buffer, buffer + count);
+    }
+    fclose(file);
+
+    size_t headerSize = sizeof(replayMagic) + sizeof(m_version) + sizeof(m_tickRate);
+    if (m_data.size() < headerSize || memcmp(&m_data[0], replayMagic, sizeof(replayMagic)) != 0)
+    {
+        fprintf(stderr, "ERROR: \"%s\" is not a replay file.\n", filename);
+        return false;
+    }
+    memcpy(&m_version, &m_data[sizeof(replayMagic)], sizeof(m_version));
+    if (byteSwap16(m_version) >= 1 && byteSwap16(m_version) <= REPLAY_VERSION)
+    {
+        fprintf(stderr, "ERROR: Replay \"%s\" was recorded on a machine with the other byte order.\n", filename);
+        return false;
+    }
+    if (m_version < 1 || m_version > REPLAY_VERSION)
+    {
+        fprintf(stderr, "ERROR: Replay \"%s\" has version %d, expected up to %d.\n", filename, m_version, REPLAY_VERSION);
+        return false;
+    }
+    if (m_version < 3)
+    {
+        fprintf(stderr, "WARNING: Replay \"%s\" has version %d, recorded with the old opponent movement. The race may not play back the same.\n", filename, m_version);
+    }
+    else if (m_version < 5)
+    {
+        fprintf(stderr, "WARNING: Replay \"%s\" has version %d, recorded with the old race clock and opponent path lengths. The race may not play back the same.\n", filename, m_version);
+    }
+    memcpy(&m_tickRate, &m_data[sizeof(replayMagic) + sizeof(m_version)], sizeof(m_tickRate));
+    m_index.clear();
+    m_setup = ReplaySetup();
+    if (m_version >= 2)
+    {
+        headerSize += sizeof(unsigned int);
+        if (m_version >= 4)
+        {
+            headerSize += sizeof(m_setup.extraOpponents) + 1;
+        }
+        if (m_data.size() < headerSize || !readIndex())
+        {
+            fprintf(stderr, "ERROR: Replay \"%s\" is truncated.\n", filename);
+            return false;
+        }
+        if (m_version >= 4)
+        {
+            const unsigned char *setup = &m_data[headerSize - sizeof(m_setup.extraOpponents) - 1];
+            memcpy(&m_setup.extraOpponents, setup, sizeof(m_setup.extraOpponents));
+            m_setup.wallField = (setup[sizeof(m_setup.extraOpponents)] & 1) != 0;
+        }
+    }
+    m_runsBegin = headerSize;
+    rewind();
+    return true;
+}
+
+bool ReplayReader::readIndex()
+{
+    if (m_data.size() < replayFooterSize)
+    {
+        return false;
+    }
+    const unsigned char *footer = &m_data[m_data.size() - replayFooterSize];
+    unsigned int count;
+    unsigned int indexOffset;
+    memcpy(&count, footer, sizeof(count));
+    memcpy(&indexOffset, footer + sizeof(count), sizeof(indexOffset));
+    if (memcmp(footer + 2 * sizeof(unsigned int), replayIndexMagic, sizeof(replayIndexMagic)) != 0 ||
+        indexOffset + (size_t)count * 2 * sizeof(unsigned int) > m_data.size() - replayFooterSize)
+    {
+        return false;
+    }
+    m_index.resize(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const unsigned char *entry = &m_data[indexOffset + i * 2 * sizeof(unsigned int)];
+        memcpy(&m_index[i].tick, entry, sizeof(unsigned int));
+        memcpy(&m_index[i].offset, entry + sizeof(unsigned int), sizeof(unsigned int));
+    }
+    return true;
+}
+
+void ReplayReader::rewind()
+{
+    m_cursor = m_runsBegin;
+    m_tick = 0;
+    m_runLeft = 0;
+    m_ended = m_data.empty();
+}
+
+bool ReplayReader::next(RaceInputs &inputs)
+{
+    while (m_runLeft == 0)
+    {
+        unsigned int length;
+        if (m_ended || !readVarint(m_data, m_cursor, length) || m_cursor >= m_data.size())
+        {
+            m_ended = true;
+            return false;
+        }
+        if (length > 0)
+        {
+            m_runLeft = length;
+            m_runBits = m_data[m_cursor++];
+            break;
+        }
+        // varint 0: end of the replay, or a keyframe we don't need when
+        // playing in sequence
+        if (m_version < 2 || m_data[m_cursor] != 'K')
+        {
+            m_ended = true;
+            return false;
+        }
+        size_t skip = keyframeSize(m_data, m_cursor);
+        if (skip == 0)
+        {
+            m_ended = true;
+            return false;
+        }
+        m_cursor += skip;
+    }
+    m_runLeft--;
+    m_tick++;
+    inputs = unpackInputs(m_runBits);
+    return true;
+}
+
+bool ReplayReader::seek(int tick, RaceSim &sim)
+{
+    // closest keyframe at or before the tick
+    int found = -1;
+    int low = 0;
+    int high = (int)m_index.size() - 1;
+    while (low <= high)
+    {
+        int middle = (low + high) / 2;
+        if ((int)m_index[middle].tick <= tick)
+        {
+            found = middle;
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+
+    bool restored = false;
+    if (found >= 0)
+    {
+        size_t cursor = m_index[found].offset;
+        unsigned int zero;
+        if (!readVarint(m_data, cursor, zero) || zero != 0 || cursor >= m_data.size() || m_data[cursor] != 'K')
+        {
+            return false;
+        }
+        size_t size = keyframeSize(m_data, cursor);
+        RaceSnapshot snapshot;
+        if (size == sizeof(unsigned int) + 1 + sizeof(snapshot))
+        {
+            memcpy(&snapshot, &m_data[cursor + 1 + sizeof(unsigned int)], sizeof(snapshot));
+            restored = sim.restore(snapshot);
+        }
+        if (restored)
+        {
+            m_cursor = cursor + size;
+            m_tick = (int)m_index[found].tick;
+            m_runLeft = 0;
+            m_ended = false;
+        }
+    }
+    if (!restored)
+    {
+        // no keyframes, or saved by a build with another RaceState:
+        // simulate from the start
+        sim.start();
+        rewind();
+    }
+
+    float dt = 1.0f / m_tickRate;
+    RaceInputs inputs;
+    while (m_tick < tick && next(inputs))
+    {
+        sim.step(inputs, dt);
+    }
+    sim.syncOpponents();
+    return m_tick == tick;
+}
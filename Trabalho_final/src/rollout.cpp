@@ -0,0 +1,59 @@
+#include "rollout.h"
+
+RaceInputs seededInputs(std::mt19937 &rng, const RaceState &state)
+{
+    RaceInputs inputs = RaceInputs();
+    inputs.forward = true;
+    inputs.boost = state.boostTime < state.time && state.boostpower > 40;
+    unsigned int r = rng() % 16;
+    inputs.left = r == 0;
+    inputs.right = r == 1;
+    inputs.strafeLeft = r == 2;
+    inputs.strafeRight = r == 3;
+    return inputs;
+}
+
+RolloutResult runRollout(const RaceTrack &track, const RolloutSpec &spec, float dt, float maxRaceTime)
+{
+    RaceSim sim(track);
+    sim.start();
+    std::mt19937 rng(spec.seed);
+    RaceInputs held = RaceInputs();
+    int ticks = 0;
+    while (sim.state.raceStart && sim.state.time < maxRaceTime)
+    {
+        RaceInputs inputs;
+        if (spec.script)
+        {
+            if (ticks < (int)spec.script->size())
+            {
+                held = (*spec.script)[ticks];
+            }
+            inputs = held;
+        }
+        else
+        {
+            inputs = seededInputs(rng, sim.state);
+        }
+        sim.step(inputs, dt);
+        ticks++;
+    }
+
+    RolloutResult result;
+    result.finishTime = sim.state.time;
+    result.finished = sim.state.finished;
+    result.lost = sim.state.lost;
+    result.boostpower = sim.state.boostpower;
+    result.ticks = ticks;
+    return result;
+}
+
+void runRollouts(const RaceTrack &track, const std::vector<RolloutSpec> &specs, std::vector<RolloutResult> &results,
+                 WorkStealingPool &pool, float dt, float maxRaceTime)
+{
+    results.resize(specs.size());
+    RolloutResult *out = results.empty() ? NULL : &results[0];
+    pool.run((int)specs.size(), [&](int i, int) {
+        out[i] = runRollout(track, specs[i], dt, maxRaceTime);
+    });
+}
@@ -0,0 +1,66 @@
+#include <atomic>
+
+#include "simdisa.h"
+
+bool simdIsaSupported(SimdIsa isa)
+{
+    switch (isa)
+    {
+    case SIMD_SCALAR:
+        return true;
+#ifdef SIMD_X86
+    case SIMD_SSE2:
+        return true; // every x86-64 CPU has SSE2
+#endif
+#ifdef SIMD_HAS_AVX2
+    case SIMD_AVX2:
+        // this may run from a static initializer, before the runtime did it
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+#endif
+    default:
+        return false;
+    }
+}
+
+static SimdIsa bestIsa()
+{
+    if (simdIsaSupported(SIMD_AVX2))
+    {
+        return SIMD_AVX2;
+    }
+    return simdIsaSupported(SIMD_SSE2) ? SIMD_SSE2 : SIMD_SCALAR;
+}
+
+// picked once by the static initializer, before main and so before any
+// thread runs a kernel; atomic so setSimdIsa doesn't race with the kernels
+// running on the WorkStealingPool threads
+static std::atomic<int> g_isa(bestIsa());
+
+bool setSimdIsa(SimdIsa isa)
+{
+    if (!simdIsaSupported(isa))
+    {
+        return false;
+    }
+    g_isa.store(isa, std::memory_order_relaxed);
+    return true;
+}
+
+SimdIsa simdIsa()
+{
+    return (SimdIsa)g_isa.load(std::memory_order_relaxed);
+}
+
+const char *simdIsaName(SimdIsa isa)
+{
+    switch (isa)
+    {
+    case SIMD_SSE2:
+        return "sse2";
+    case SIMD_AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
@@ -0,0 +1,35 @@
+#include "spline.h"
+
+BezierSpline::BezierSpline()
+    : m_closed(false)
+{
+}
+
+void BezierSpline::clear()
+{
+    m_points.clear();
+    m_curves.clear();
+    m_closed = false;
+}
+
+void BezierSpline::add(const glm::vec4 *points)
+{
+    m_points.insert(m_points.end(), points, points + 4);
+    m_curves.push_back(BezierPolynomial<3>(points));
+}
+
+void BezierSpline::close()
+{
+    if (m_points.empty())
+    {
+        return;
+    }
+    glm::vec4 first = m_points.front();
+    glm::vec4 last = m_points.back();
+    if (first != last)
+    {
+        glm::vec4 line[4] = {last, last + (first - last) / 3.0f, last + (first - last) * (2.0f / 3.0f), first};
+        add(line);
+    }
+    m_closed = true;
+}
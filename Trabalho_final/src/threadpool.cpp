@@ -0,0 +1,152 @@
+#include <cassert>
+
+#include "threadpool.h"
+
+// the pool and worker index of the calling thread, when it is a worker
+static thread_local const WorkStealingPool *t_pool = NULL;
+static thread_local int t_worker = -1;
+
+WorkStealingPool::WorkStealingPool(int threads)
+    : m_task(NULL), m_generation(0), m_busy(0), m_stop(false), m_remaining(0), m_running(false), m_steals(0)
+{
+    if (threads <= 0)
+    {
+        threads = (int)std::thread::hardware_concurrency();
+        if (threads <= 0)
+        {
+            threads = 1;
+        }
+    }
+    for (int i = 0; i < threads; i++)
+    {
+        m_queues.push_back(new Queue());
+    }
+    for (int i = 0; i < threads; i++)
+    {
+        m_workers.push_back(std::thread(&WorkStealingPool::workerLoop, this, i));
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (size_t i = 0; i < m_workers.size(); i++)
+    {
+        m_workers[i].join();
+    }
+    for (size_t i = 0; i < m_queues.size(); i++)
+    {
+        delete m_queues[i];
+    }
+}
+
+void WorkStealingPool::run(int count, const std::function<void(int, int)> &task)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+    if (t_pool == this)
+    {
+        // nested run() from one of our tasks: the other workers may be busy
+        // with the outer run, and the queues and m_task belong to it
+        for (int i = 0; i < count; i++)
+        {
+            task(i, t_worker);
+        }
+        return;
+    }
+    bool wasRunning = m_running.exchange(true);
+    assert(!wasRunning && "WorkStealingPool::run called from two threads at once");
+    (void)wasRunning;
+
+    // neighbouring tasks go to the same worker, in contiguous blocks
+    int n = threads();
+    for (int w = 0; w < n; w++)
+    {
+        Queue &q = *m_queues[w];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        int begin = (int)((long long)count * w / n);
+        int end = (int)((long long)count * (w + 1) / n);
+        for (int i = begin; i < end; i++)
+        {
+            q.items.push_back(i);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_task = &task;
+    m_remaining = count;
+    m_busy = n;
+    m_generation++;
+    m_wake.notify_all();
+    m_done.wait(lock, [this]() { return m_busy == 0; });
+    m_task = NULL;
+    m_running = false;
+}
+
+bool WorkStealingPool::popOrSteal(int worker, int &item)
+{
+    {
+        Queue &own = *m_queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.items.empty())
+        {
+            item = own.items.front();
+            own.items.pop_front();
+            return true;
+        }
+    }
+    int n = threads();
+    for (int k = 1; k < n; k++)
+    {
+        Queue &victim = *m_queues[(worker + k) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.items.empty())
+        {
+            item = victim.items.back();
+            victim.items.pop_back();
+            m_steals++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(int worker)
+{
+    t_pool = this;
+    t_worker = worker;
+    unsigned int seen = 0;
+    for (;;)
+    {
+        const std::function<void(int, int)> *task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&]() { return m_stop || m_generation != seen; });
+            if (m_stop)
+            {
+                return;
+            }
+            seen = m_generation;
+            task = m_task;
+        }
+
+        int item;
+        while (m_remaining > 0 && popOrSteal(worker, item))
+        {
+            (*task)(item, worker);
+            m_remaining--;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_busy == 0)
+        {
+            m_done.notify_all();
+        }
+    }
+}
@@ -0,0 +1,361 @@
+#include <vector>
+#include <glm/vec4.hpp>
+
+#include "matrices.h"
+#include "track.h"
+
+#define PI 3.14159265358979323846
+
+void BuildDefaultTrack(RaceTrack &track)
+{
+    track.straightsBBoxes.clear();
+    track.checkpoints.clear();
+    track.curveList.clear();
+
+    // oponnent starting grid and speed
+    track.opponentStart[0] = glm::vec4(0.0f, 0.16f, 2.0f, 1.0f);
+    track.opponentStart[1] = glm::vec4(0.0f, 0.16f, -2.0f, 1.0f);
+    // the paths are about 590 m long, done in 30 s and 48 s like when
+    // opponents ran a bezier segment every 5 s and 8 s
+    track.opponentSpeed[0] = 19.5f;
+    track.opponentSpeed[1] = 12.3f;
+
+    // bezier control points1
+    std::vector<glm::vec4> controlPoints1_1;
+    controlPoints1_1.push_back(track.opponentStart[0]);
+    controlPoints1_1.push_back(glm::vec4(156.483f, 0.16f, -3.52993f, 1.0f));
+    controlPoints1_1.push_back(glm::vec4(134.85f, 0.16f, -6.45085f, 1.0f));
+    controlPoints1_1.push_back(glm::vec4(129.0f, 0.16f, 60.9768f, 1.0f));
+
+    std::vector<glm::vec4> controlPoints1_2;
+    controlPoints1_2.push_back(glm::vec4(129.0f, 0.16f, 60.9768f, 1.0f));
+    controlPoints1_2.push_back(glm::vec4(99.3377f, 0.16f, 71.0411f, 1.0f));
+    controlPoints1_2.push_back(glm::vec4(121.338f, 0.16f, 30.559f, 1.0f));
+    controlPoints1_2.push_back(glm::vec4(69.6432f, 0.16f, 41.1186f, 1.0f));
+
+    std::vector<glm::vec4> controlPoints1_3;
+    controlPoints1_3.push_back(glm::vec4(69.6432f, 0.16f, 41.1186f, 1.0f));
+    controlPoints1_3.push_back(glm::vec4(23.2552f, 0.16f, 32.2232f, 1.0f));
+    controlPoints1_3.push_back(glm::vec4(24.7635f, 0.16f, 47.7012f, 1.0f));
+    controlPoints1_3.push_back(glm::vec4(26.857f, 0.16f, 105.02f, 1.0f));
+
+    std::vector<glm::vec4> controlPoints1_4;
+    controlPoints1_4.push_back(glm::vec4(26.857f, 0.16f, 105.02f, 1.0f));
+    controlPoints1_4.push_back(glm::vec4(10.3733f, 0.16f, 123.0f, 1.0f));
+    controlPoints1_4.push_back(glm::vec4(5.2825f, 0.16f, 124.649f, 1.0f));
+    controlPoints1_4.push_back(glm::vec4(2.76479f, 0.16f, 65.1178f, 1.0f));
+    std::vector<glm::vec4> controlPoints1_5;
+    controlPoints1_5.push_back(glm::vec4(2.76479f, 0.16f, 65.1178f, 1.0f));
+    controlPoints1_5.push_back(glm::vec4(5.32203f, 0.16f, 51.0035f, 1.0f));
+    controlPoints1_5.push_back(glm::vec4(-53.3087f, 0.16f, 59.3961f, 1.0f));
+    controlPoints1_5.push_back(glm::vec4(-49.7859f, 0.16f, 50.4402f, 1.0f));
+    std::vector<glm::vec4> controlPoints1_6;
+    controlPoints1_6.push_back(glm::vec4(-49.7859f, 0.16f, 50.4402f, 1.0f));
+    controlPoints1_6.push_back(glm::vec4(-54.4495f, 0.16f, 20.2291f, 1.0f));
+    controlPoints1_6.push_back(glm::vec4(-66.0504, 0.16f, -13.1143f, 1.0f));
+    controlPoints1_6.push_back(track.opponentStart[0]);
+    // bezier control points2
+
+    std::vector<glm::vec4> controlPoints2_1;
+    controlPoints2_1.push_back(track.opponentStart[1]);
+    controlPoints2_1.push_back(glm::vec4(156.483f, 0.16f, -3.52993f, 1.0f));
+    controlPoints2_1.push_back(glm::vec4(134.85f, 0.16f, -6.45085f, 1.0f));
+    controlPoints2_1.push_back(glm::vec4(132.0f, 0.16f, 60.9768f, 1.0f));
+
+    std::vector<glm::vec4> controlPoints2_2;
+    controlPoints2_2.push_back(glm::vec4(132.0f, 0.16f, 60.9768f, 1.0f));
+    controlPoints2_2.push_back(glm::vec4(99.3377f, 0.16f, 71.0411f, 1.0f));
+    controlPoints2_2.push_back(glm::vec4(121.338f, 0.16f, 30.559f, 1.0f));
+    controlPoints2_2.push_back(glm::vec4(69.6432f, 0.16f, 43.1186f, 1.0f));
+
+    std::vector<glm::vec4> controlPoints2_3;
+    controlPoints2_3.push_back(glm::vec4(69.6432f, 0.16f, 43.1186f, 1.0f));
+    controlPoints2_3.push_back(glm::vec4(23.2552f, 0.16f, 32.2232f, 1.0f));
+    controlPoints2_3.push_back(glm::vec4(24.7635f, 0.16f, 47.7012f, 1.0f));
+    controlPoints2_3.push_back(glm::vec4(28.857f, 0.16f, 105.02f, 1.0f));
+
+    std::vector<glm::vec4> controlPoints2_4;
+    controlPoints2_4.push_back(glm::vec4(28.857f, 0.16f, 105.02f, 1.0f));
+    controlPoints2_4.push_back(glm::vec4(10.3733f, 0.16f, 123.0f, 1.0f));
+    controlPoints2_4.push_back(glm::vec4(5.2825f, 0.16f, 124.649f, 1.0f));
+    controlPoints2_4.push_back(glm::vec4(2.76479f, 0.16f, 69.1178f, 1.0f));
+
+    std::vector<glm::vec4> controlPoints2_5;
+    controlPoints2_5.push_back(glm::vec4(2.76479f, 0.16f, 69.1178f, 1.0f));
+    controlPoints2_5.push_back(glm::vec4(5.32203f, 0.16f, 51.0035f, 1.0f));
+    controlPoints2_5.push_back(glm::vec4(-53.3087f, 0.16f, 59.3961f, 1.0f));
+    controlPoints2_5.push_back(glm::vec4(-52.7859f, 0.16f, 50.4402f, 1.0f));
+
+    std::vector<glm::vec4> controlPoints2_6;
+    controlPoints2_6.push_back(glm::vec4(-52.7859f, 0.16f, 50.4402f, 1.0f));
+    controlPoints2_6.push_back(glm::vec4(-54.4495f, 0.16f, 20.2291f, 1.0f));
+    controlPoints2_6.push_back(glm::vec4(-66.0504, 0.16f, -6.89044f, 1.0f));
+    controlPoints2_6.push_back(track.opponentStart[1]);
+
+    track.opponentPaths[0].clear();
+    track.opponentPaths[0].add(controlPoints1_1);
+    track.opponentPaths[0].add(controlPoints1_2);
+    track.opponentPaths[0].add(controlPoints1_3);
+    track.opponentPaths[0].add(controlPoints1_4);
+    track.opponentPaths[0].add(controlPoints1_5);
+    track.opponentPaths[0].add(controlPoints1_6);
+    track.opponentPaths[0].close();
+
+    track.opponentPaths[1].clear();
+    track.opponentPaths[1].add(controlPoints2_1);
+    track.opponentPaths[1].add(controlPoints2_2);
+    track.opponentPaths[1].add(controlPoints2_3);
+    track.opponentPaths[1].add(controlPoints2_4);
+    track.opponentPaths[1].add(controlPoints2_5);
+    track.opponentPaths[1].add(controlPoints2_6);
+    track.opponentPaths[1].close();
+
+    // the opponent paths run along each side of the road with the same
+    // segments, the centerline goes between their control points
+    track.centerline.clear();
+    for (int s = 0; s < track.opponentPaths[0].segments(); s++)
+    {
+        glm::vec4 middle[4];
+        for (int i = 0; i < 4; i++)
+        {
+            middle[i] = (track.opponentPaths[0].controlPoints(s)[i] + track.opponentPaths[1].controlPoints(s)[i]) * 0.5f;
+        }
+        track.centerline.add(middle);
+    }
+    track.centerline.close();
+    track.progress.build(track.centerline);
+
+    // straighline bounding boxes
+    bbox sbbox;
+    sbbox.minPoint = glm::vec4(-40.7087f, 0.167617f, -4.80944f, 0.0f);
+    sbbox.maxPoint = glm::vec4(119.674f, 1.14384f, -4.02039f, 0.0f);
+    sbbox.normal = glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+    track.straightsBBoxes.push_back(sbbox);
+
+    sbbox.minPoint = glm::vec4(-40.7658f, 0.167617f, 3.9902f, 0.0f);
+    sbbox.maxPoint = glm::vec4(119.617f, 1.14384f, 4.77924f, 0.0f);
+    sbbox.normal = glm::vec4(0.0f, 0.0f, -1.0f, 0.0f);
+    track.straightsBBoxes.push_back(sbbox);
+
+    sbbox.minPoint = glm::vec4(127.899f, 0.167617f, 10.6331f, 0.0f);
+    sbbox.maxPoint = glm::vec4(128.936f, 1.14384f, 53.4338f, 0.0f);
+    sbbox.normal = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+    track.straightsBBoxes.push_back(sbbox);
+
+    sbbox.minPoint = glm::vec4(136.551f, 0.167617f, 9.02853f, 0.0f);
+    sbbox.maxPoint = glm::vec4(137.735f, 1.14384f, 53.4909f, 0.0f);
+    sbbox.normal = glm::vec4(-1.0f, 0.0f, 0.0f, 0.0f);
+    track.straightsBBoxes.push_back(sbbox);
+
+    sbbox.minPoint = glm::vec4(39.8501f, 0.167617f, 36.1797f, 0.0f);
+    sbbox.maxPoint = glm::vec4(96.9923f, 1.14384f, 36.9671f, 0.0f);
+    sbbox.normal = glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+    track.straightsBBoxes.push_back(sbbox);
+
+    sbbox.minPoint = glm::vec4(39.793f, 0.167617f, 44.9793f, 0.0f);
+    sbbox.maxPoint = glm::vec4(96.92f, 1.14384f, 45.7667f, 0.0f);
+    sbbox.normal = glm::vec4(0.0f, 0.0f, -1.0f, 0.0f);
+    track.straightsBBoxes.push_back(sbbox);
+
+    sbbox.minPoint = glm::vec4(22.7769f, 0.167617f, 52.8528f, 0.0f);
+    sbbox.maxPoint = glm::vec4(23.588f, 1.14384f, 101.884f, 0.0f);
+    sbbox.normal = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+    track.straightsBBoxes.push_back(sbbox);
+
+    sbbox.minPoint = glm::vec4(31.5765f, 0.167617f, 52.91f, 0.0f);
+    sbbox.maxPoint = glm::vec4(32.3877f, 1.14384f, 101.941f, 0.0f);
+    sbbox.normal = glm::vec4(-1.0f, 0.0f, 0.0f, 0.0f);
+    track.straightsBBoxes.push_back(sbbox);
+
+    sbbox.minPoint = glm::vec4(7.47314f, 0.167617f, 68.8696f, 0.0f);
+    sbbox.maxPoint = glm::vec4(8.28739f, 1.14384f, 101.592f, 0.0f);
+    sbbox.normal = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+    track.straightsBBoxes.push_back(sbbox);
+
+    sbbox.minPoint = glm::vec4(-1.32648f, 0.167617f, 68.8124f, 0.0f);
+    sbbox.maxPoint = glm::vec4(-0.512249f, 1.14384f, 101.535f, 0.0f);
+    sbbox.normal = glm::vec4(-1.0f, 0.0f, 0.0f, 0.0f);
+    track.straightsBBoxes.push_back(sbbox);
+
+    sbbox.minPoint = glm::vec4(-41.0521f, 0.167617f, 51.8798f, 0.0f);
+    sbbox.maxPoint = glm::vec4(-8.40433f, 1.14384f, 52.6341f, 0.0f);
+    sbbox.normal = glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+    track.straightsBBoxes.push_back(sbbox);
+
+    sbbox.minPoint = glm::vec4(-41.1093f, 0.167617f, 60.6794f, 0.0f);
+    sbbox.maxPoint = glm::vec4(-8.46143f, 1.14384f, 61.4337f, 0.0f);
+    sbbox.normal = glm::vec4(0.0f, 0.0f, -1.0f, 0.0f);
+    track.straightsBBoxes.push_back(sbbox);
+
+    sbbox.minPoint = glm::vec4(-57.7365f, 0.167617f, 11.8487f, 0.0f);
+    sbbox.maxPoint = glm::vec4(-56.9515f, 1.14384f, 44.5001f, 0.0f);
+    sbbox.normal = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+    track.straightsBBoxes.push_back(sbbox);
+
+    sbbox.minPoint = glm::vec4(-48.9368f, 0.167617f, 11.9059f, 0.0f);
+    sbbox.maxPoint = glm::vec4(-48.3918f, 1.14384f, 44.5557f, 0.0f);
+    sbbox.normal = glm::vec4(-1.0f, 0.0f, 0.0f, 0.0f);
+    track.straightsBBoxes.push_back(sbbox);
+
+    // starting line and check bbox
+    bbox cbbox;
+    cbbox.minPoint = glm::vec4(23.573f, 0.167617f, 61.0342f, 0.0f);
+    cbbox.maxPoint = glm::vec4(31.8161f, 1.14384f, 69.2047f, 0.0f);
+    cbbox.normal = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+    track.checkpoints.push_back(cbbox);
+
+    cbbox.minPoint = glm::vec4(1.77523f, 0.167617f, -4.71291f, 0.0f);
+    cbbox.maxPoint = glm::vec4(2.275f, 1.14384f, 4.71291f, 0.0f);
+    cbbox.normal = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
+    track.checkpoints.push_back(cbbox);
+    // curves
+    std::vector<glm::vec4> beziercurve1;
+    beziercurve1.push_back(glm::vec4(120.512f, 0.0f, -4.36174f, 1.0f));
+    beziercurve1.push_back(glm::vec4(123.302f, 0.0f, -4.86174f, 1.0f));
+    beziercurve1.push_back(glm::vec4(135.011f, 0.0f, -1.97653f, 1.0f));
+    beziercurve1.push_back(glm::vec4(136.284f, 0.0f, 7.22413f, 1.0f));
+    track.curveList.push_back(beziercurve1);
+
+    std::vector<glm::vec4> beziercurve2;
+    beziercurve2.push_back(glm::vec4(119.626f, 0.0f, 4.15303f, 1.0f));
+    beziercurve2.push_back(glm::vec4(122.416f, 0.0f, 4.19443f, 1.0f));
+    beziercurve2.push_back(glm::vec4(128.515f, 0.0f, 4.42184f, 1.0f));
+    beziercurve2.push_back(glm::vec4(128.311f, 0.0f, 13.6225f, 1.0f));
+    track.curveList.push_back(beziercurve2);
+
+    std::vector<glm::vec4> beziercurve3;
+    beziercurve3.push_back(glm::vec4(128.478f, 0.0f, 51.9777f, 1.0f));
+    beziercurve3.push_back(glm::vec4(127.48f, 0.0f, 63.1046f, 1.0f));
+    beziercurve3.push_back(glm::vec4(114.013f, 0.0f, 63.1661f, 1.0f));
+    beziercurve3.push_back(glm::vec4(113.237f, 0.0f, 52.1931f, 1.0f));
+    track.curveList.push_back(beziercurve3);
+
+    std::vector<glm::vec4> beziercurve4;
+    beziercurve4.push_back(glm::vec4(113.237f, 0.0f, 52.1931f, 1.0f));
+    beziercurve4.push_back(glm::vec4(113.395f, 0.0f, 38.6298f, 1.0f));
+    beziercurve4.push_back(glm::vec4(99.3735f, 0.0f, 35.9511f, 1.0f));
+    beziercurve4.push_back(glm::vec4(96.5414f, 0.0f, 36.5426f, 1.0f));
+    track.curveList.push_back(beziercurve4);
+
+    std::vector<glm::vec4> beziercurve5;
+    beziercurve5.push_back(glm::vec4(137.254f, 0.0f, 52.1931f, 1.0f));
+    beziercurve5.push_back(glm::vec4(137.412f, 0.0f, 72.4043f, 1.0f));
+    beziercurve5.push_back(glm::vec4(109.267f, 0.0f, 76.808f, 1.0f));
+    beziercurve5.push_back(glm::vec4(105.092f, 0.0f, 55.4622f, 1.0f));
+    track.curveList.push_back(beziercurve5);
+
+    std::vector<glm::vec4> beziercurve6;
+    beziercurve6.push_back(glm::vec4(105.092f, 0.0f, 55.4622f, 1.0f));
+    beziercurve6.push_back(glm::vec4(104.126f, 0.0f, 48.4478f, 1.0f));
+    beziercurve6.push_back(glm::vec4(103.997f, 0.0f, 44.8816f, 1.0f));
+    beziercurve6.push_back(glm::vec4(94.0448f, 0.0f, 45.1446f, 1.0f));
+    track.curveList.push_back(beziercurve6);
+
+
+    std::vector<glm::vec4> beziercurve7;
+    beziercurve7.push_back(glm::vec4(39.7007f, 0.0f, 36.3488f, 1.0f));
+    beziercurve7.push_back(glm::vec4(26.3065f, 0.0f, 36.4643f, 1.0f));
+    beziercurve7.push_back(glm::vec4(21.8087f, 0.0f, 49.8102f, 1.0f));
+    beziercurve7.push_back(glm::vec4(23.0853f, 0.0f, 56.8246f, 1.0f));
+    track.curveList.push_back(beziercurve7);
+
+    std::vector<glm::vec4> beziercurve8;
+    beziercurve8.push_back(glm::vec4(39.7007f, 0.0f, 45.337f, 1.0f));
+    beziercurve8.push_back(glm::vec4(34.6639f, 0.0f, 45.4525f, 1.0f));
+    beziercurve8.push_back(glm::vec4(30.8758f, 0.0f, 49.8102f, 1.0f));
+    beziercurve8.push_back(glm::vec4(31.7581f, 0.0f, 56.8246f, 1.0f));
+    track.curveList.push_back(beziercurve8);
+
+    std::vector<glm::vec4> beziercurve9;
+    beziercurve9.push_back(glm::vec4(23.3203f, 0.0f, 99.3802f, 1.0f));
+    beziercurve9.push_back(glm::vec4(23.0891f, 0.0f, 114.942f, 1.0f));
+    beziercurve9.push_back(glm::vec4(6.20176f, 0.0f, 110.899f, 1.0f));
+    beziercurve9.push_back(glm::vec4(7.853f, 0.0f, 98.6958f, 1.0f));
+    track.curveList.push_back(beziercurve9);
+
+    std::vector<glm::vec4> beziercurve10;
+    beziercurve10.push_back(glm::vec4(31.9701f, 0.0f, 99.3802f, 1.0f));
+    beziercurve10.push_back(glm::vec4(33.9709f, 0.0f, 121.277f, 1.0f));
+    beziercurve10.push_back(glm::vec4(-1.25309f, 0.0f, 127.641f, 1.0f));
+    beziercurve10.push_back(glm::vec4(-1.16885f, 0.0f, 98.6958f, 1.0f));
+    track.curveList.push_back(beziercurve10);
+
+    std::vector<glm::vec4> beziercurve11;
+    beziercurve11.push_back(glm::vec4(7.47649f, 0.0f, 66.7042f, 1.0f));
+    beziercurve11.push_back(glm::vec4(6.74377f, 0.0f, 54.6708f, 1.0f));
+    beziercurve11.push_back(glm::vec4(-4.02467f, 0.0f, 51.278f, 1.0f));
+    beziercurve11.push_back(glm::vec4(-15.0344f, 0.0f, 52.0941f, 1.0f));
+    track.curveList.push_back(beziercurve11);
+
+    std::vector<glm::vec4> beziercurve12;
+    beziercurve12.push_back(glm::vec4(-0.967499f, 0.0f, 73.5248f, 1.0f));
+    beziercurve12.push_back(glm::vec4(-0.731407f, 0.0f, 61.4914f, 1.0f));
+    beziercurve12.push_back(glm::vec4(-4.02469f, 0.0f, 60.2515f, 1.0f));
+    beziercurve12.push_back(glm::vec4(-15.0344f, 0.0f, 61.0676f, 1.0f));
+    track.curveList.push_back(beziercurve12);
+
+    std::vector<glm::vec4> beziercurve13;
+    beziercurve13.push_back(glm::vec4(-42.6206f, 0.0f, 60.6673f, 1.0f));
+    beziercurve13.push_back(glm::vec4(-50.2865f, 0.0f, 59.8842f, 1.0f));
+    beziercurve13.push_back(glm::vec4(-57.062f, 0.0f, 55.8317f, 1.0f));
+    beziercurve13.push_back(glm::vec4(-57.3571f, 0.0f, 43.3885f, 1.0f));
+    track.curveList.push_back(beziercurve13);
+
+    std::vector<glm::vec4> beziercurve14;
+    beziercurve14.push_back(glm::vec4(-38.0477f, 0.0f, 52.1415f, 1.0f));
+    beziercurve14.push_back(glm::vec4(-45.7135f, 0.0f, 52.9085f, 1.0f));
+    beziercurve14.push_back(glm::vec4(-48.4587f, 0.0f, 49.5536f, 1.0f));
+    beziercurve14.push_back(glm::vec4(-48.7538f, 0.0f, 43.3885f, 1.0f));
+    track.curveList.push_back(beziercurve14);
+
+    std::vector<glm::vec4> beziercurve15;
+    beziercurve15.push_back(glm::vec4(-48.502f, 0.0f, 12.3608f, 1.0f));
+    beziercurve15.push_back(glm::vec4(-48.2069f, 0.0f, 8.3172f, 1.0f));
+    beziercurve15.push_back(glm::vec4(-46.0213f, 0.0f, 4.44382f, 1.0f));
+    beziercurve15.push_back(glm::vec4(-38.0477f, 0.0f, 4.84188f, 1.0f));
+    track.curveList.push_back(beziercurve15);
+
+    std::vector<glm::vec4> beziercurve16;
+    beziercurve16.push_back(glm::vec4(-57.227f, 0.0f, 12.3608f, 1.0f));
+    beziercurve16.push_back(glm::vec4(-56.9319f, 0.0f, 8.3172f, 1.0f));
+    beziercurve16.push_back(glm::vec4(-54.5646f, 0.0f, -4.60828f, 1.0f));
+    beziercurve16.push_back(glm::vec4(-38.0477f, 0.0f, -4.21022f, 1.0f));
+    track.curveList.push_back(beziercurve16);
+
+    track.world.build(track.straightsBBoxes, track.checkpoints, track.curveList);
+}
+
+glm::mat4 TrackModelMatrix()
+{
+    return Matrix_Translate(0.0f, -0.8f, 0.0f) * Matrix_Scale(8.0f, 8.0f, 8.0f) * Matrix_Rotate_Y(-PI / 2);
+}
+
+bool LoadTrackMesh(RaceTrack &track, const char *filename)
+{
+    // the race runs at y = 0: faces that stay below it are the sides of the
+    // road slabs, the walls rise above it
+    return track.mesh.load(filename, TrackModelMatrix(), 0.5f, 0.0f);
+}
+
+bool LoadWallField(RaceTrack &track, const char *meshFile, const char *cacheFile)
+{
+    WallField &field = track.world.wallField();
+    if (field.open(cacheFile, meshFile))
+    {
+        return true;
+    }
+    if (track.mesh.triangleCount() == 0 && !LoadTrackMesh(track, meshFile))
+    {
+        return false;
+    }
+    if (!field.bake(track.mesh, meshFile))
+    {
+        return false;
+    }
+    // without a cache the baked field stays in memory
+    if (field.save(cacheFile))
+    {
+        field.open(cacheFile, meshFile);
+    }
+    return field.isOpen() || field.bake(track.mesh, meshFile);
+}
@@ -0,0 +1,469 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+
+#include "tiny_obj_loader.h"
+#include "trackmesh.h"
+
+static const int maxLeafSize = 4;
+static const int sahBins = 16;
+// below this depth nodes are split by the median, which adds at most 32
+// more levels to the fixed query stack
+static const int maxSahDepth = 48;
+static const int stackSize = maxSahDepth + 40;
+
+static float surfaceArea(const float *min, const float *max)
+{
+    float dx = max[0] - min[0];
+    float dy = max[1] - min[1];
+    float dz = max[2] - min[2];
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+static void grow(float *min, float *max, const float *point)
+{
+    for (int axis = 0; axis < 3; axis++)
+    {
+        min[axis] = std::min(min[axis], point[axis]);
+        max[axis] = std::max(max[axis], point[axis]);
+    }
+}
+
+static float boxDistance2(const glm::vec3 &p, const float *min, const float *max)
+{
+    float d2 = 0;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        float d = std::max(std::max(min[axis] - p[axis], 0.0f), p[axis] - max[axis]);
+        d2 += d * d;
+    }
+    return d2;
+}
+
+// Ericson, Real-Time Collision Detection 5.1.5
+static glm::vec3 closestOnTriangle(const glm::vec3 &p, const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c)
+{
+    glm::vec3 ab = b - a;
+    glm::vec3 ac = c - a;
+    glm::vec3 ap = p - a;
+    float d1 = glm::dot(ab, ap);
+    float d2 = glm::dot(ac, ap);
+    if (d1 <= 0 && d2 <= 0)
+    {
+        return a;
+    }
+    glm::vec3 bp = p - b;
+    float d3 = glm::dot(ab, bp);
+    float d4 = glm::dot(ac, bp);
+    if (d3 >= 0 && d4 <= d3)
+    {
+        return b;
+    }
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0)
+    {
+        return a + ab * (d1 / (d1 - d3));
+    }
+    glm::vec3 cp = p - c;
+    float d5 = glm::dot(ab, cp);
+    float d6 = glm::dot(ac, cp);
+    if (d6 >= 0 && d5 <= d6)
+    {
+        return c;
+    }
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0)
+    {
+        return a + ac * (d2 / (d2 - d6));
+    }
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0)
+    {
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+    float denom = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+TrackMesh::TrackMesh()
+    : m_depth(0)
+{
+}
+
+bool TrackMesh::load(const char *filename, const glm::mat4 &transform, float maxNormalY, float minTop)
+{
+    std::string basepath = filename;
+    size_t slash = basepath.find_last_of("/\\");
+    basepath = slash == std::string::npos ? std::string() : basepath.substr(0, slash + 1);
+
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string err;
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, filename, basepath.c_str(), true))
+    {
+        fprintf(stderr, "ERROR: Cannot load track mesh \"%s\". %s\n", filename, err.c_str());
+        return false;
+    }
+
+    std::vector<glm::vec4> vertices;
+    for (size_t s = 0; s < shapes.size(); s++)
+    {
+        const std::vector<tinyobj::index_t> &indices = shapes[s].mesh.indices;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            glm::vec4 corner[3];
+            for (int k = 0; k < 3; k++)
+            {
+                int v = indices[i + k].vertex_index;
+                corner[k] = transform * glm::vec4(attrib.vertices[3 * v + 0], attrib.vertices[3 * v + 1], attrib.vertices[3 * v + 2], 1.0f);
+            }
+            glm::vec3 normal = glm::cross(glm::vec3(corner[1] - corner[0]), glm::vec3(corner[2] - corner[0]));
+            float length = glm::length(normal);
+            float top = std::max(corner[0].y, std::max(corner[1].y, corner[2].y));
+            if (length > 0 && std::fabs(normal.y / length) < maxNormalY && top > minTop)
+            {
+                vertices.push_back(corner[0]);
+                vertices.push_back(corner[1]);
+                vertices.push_back(corner[2]);
+            }
+        }
+    }
+    build(vertices);
+    return true;
+}
+
+void TrackMesh::build(const std::vector<glm::vec4> &vertices)
+{
+    const int count = (int)vertices.size() / 3;
+    std::vector<Triangle> triangles(count);
+    std::vector<float> centers(count * 3);
+    for (int i = 0; i < count; i++)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            triangles[i].a[axis] = vertices[i * 3 + 0][axis];
+            triangles[i].b[axis] = vertices[i * 3 + 1][axis];
+            triangles[i].c[axis] = vertices[i * 3 + 2][axis];
+            centers[i * 3 + axis] = (triangles[i].a[axis] + triangles[i].b[axis] + triangles[i].c[axis]) / 3.0f;
+        }
+    }
+    m_triangles.swap(triangles);
+    m_nodes.clear();
+    m_depth = 0;
+    if (count > 0)
+    {
+        m_nodes.reserve(count * 2);
+        buildNode(0, count, 0, centers);
+    }
+}
+
+// builds the subtree of m_triangles[first, first + count) and returns its
+// node; the triangles and their centers are reordered along the way
+int TrackMesh::buildNode(int first, int count, int depth, std::vector<float> &centers)
+{
+    int index = (int)m_nodes.size();
+    m_nodes.push_back(Node());
+    Node node;
+    float centerMin[3] = {1e30f, 1e30f, 1e30f};
+    float centerMax[3] = {-1e30f, -1e30f, -1e30f};
+    node.min[0] = node.min[1] = node.min[2] = 1e30f;
+    node.max[0] = node.max[1] = node.max[2] = -1e30f;
+    for (int i = first; i < first + count; i++)
+    {
+        grow(node.min, node.max, m_triangles[i].a);
+        grow(node.min, node.max, m_triangles[i].b);
+        grow(node.min, node.max, m_triangles[i].c);
+        grow(centerMin, centerMax, &centers[i * 3]);
+    }
+    node.first = first;
+    node.count = count;
+    m_depth = std::max(m_depth, depth);
+    if (count <= 1)
+    {
+        m_nodes[index] = node;
+        return index;
+    }
+
+    // binned surface area heuristic over the centers, on every axis
+    int bestAxis = -1;
+    int bestBin = 0;
+    float bestCost = 1e30f;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        float extent = centerMax[axis] - centerMin[axis];
+        if (extent <= 0)
+        {
+            continue;
+        }
+        int binCount[sahBins] = {0};
+        float binMin[sahBins][3], binMax[sahBins][3];
+        for (int b = 0; b < sahBins; b++)
+        {
+            binMin[b][0] = binMin[b][1] = binMin[b][2] = 1e30f;
+            binMax[b][0] = binMax[b][1] = binMax[b][2] = -1e30f;
+        }
+        float scale = sahBins / extent;
+        for (int i = first; i < first + count; i++)
+        {
+            int b = std::min((int)((centers[i * 3 + axis] - centerMin[axis]) * scale), sahBins - 1);
+            binCount[b]++;
+            grow(binMin[b], binMax[b], m_triangles[i].a);
+            grow(binMin[b], binMax[b], m_triangles[i].b);
+            grow(binMin[b], binMax[b], m_triangles[i].c);
+        }
+        float leftCost[sahBins];
+        float min[3] = {1e30f, 1e30f, 1e30f};
+        float max[3] = {-1e30f, -1e30f, -1e30f};
+        int inside = 0;
+        for (int b = 0; b < sahBins - 1; b++)
+        {
+            inside += binCount[b];
+            if (binCount[b] > 0)
+            {
+                grow(min, max, binMin[b]);
+                grow(min, max, binMax[b]);
+            }
+            leftCost[b] = inside > 0 ? surfaceArea(min, max) * inside : 0.0f;
+        }
+        min[0] = min[1] = min[2] = 1e30f;
+        max[0] = max[1] = max[2] = -1e30f;
+        inside = 0;
+        for (int b = sahBins - 1; b > 0; b--)
+        {
+            inside += binCount[b];
+            if (binCount[b] > 0)
+            {
+                grow(min, max, binMin[b]);
+                grow(min, max, binMax[b]);
+            }
+            if (inside == 0 || inside == count)
+            {
+                continue;
+            }
+            float cost = leftCost[b - 1] + surfaceArea(min, max) * inside;
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = b;
+            }
+        }
+    }
+
+    // a leaf costs testing all its triangles, a split one traversal step more
+    float leafCost = surfaceArea(node.min, node.max) * count;
+    if (count <= maxLeafSize && (bestAxis < 0 || leafCost <= bestCost + surfaceArea(node.min, node.max)))
+    {
+        m_nodes[index] = node;
+        return index;
+    }
+
+    int split = first;
+    if (bestAxis >= 0 && depth < maxSahDepth)
+    {
+        float scale = sahBins / (centerMax[bestAxis] - centerMin[bestAxis]);
+        for (int i = first; i < first + count; i++)
+        {
+            int b = std::min((int)((centers[i * 3 + bestAxis] - centerMin[bestAxis]) * scale), sahBins - 1);
+            if (b < bestBin)
+            {
+                std::swap(m_triangles[i], m_triangles[split]);
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    std::swap(centers[i * 3 + axis], centers[split * 3 + axis]);
+                }
+                split++;
+            }
+        }
+    }
+    else
+    {
+        // too deep or all centers in one point: halves in the current order
+        split = first + count / 2;
+    }
+
+    buildNode(first, split - first, depth + 1, centers);
+    node.first = buildNode(split, first + count - split, depth + 1, centers);
+    node.count = 0;
+    m_nodes[index] = node;
+    return index;
+}
+
+bool TrackMesh::sphere(const glm::vec4 &center, float radius, MeshHit &hit) const
+{
+    if (m_nodes.empty())
+    {
+        return false;
+    }
+    glm::vec3 p(center);
+    float best2 = radius * radius;
+    int found = -1;
+    glm::vec3 closest(0.0f);
+    int stack[stackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Node &node = m_nodes[stack[--top]];
+        if (boxDistance2(p, node.min, node.max) >= best2)
+        {
+            continue;
+        }
+        if (node.count == 0)
+        {
+            stack[top++] = node.first;
+            stack[top++] = (int)(&node - &m_nodes[0]) + 1;
+            continue;
+        }
+        for (int i = node.first; i < node.first + node.count; i++)
+        {
+            const Triangle &t = m_triangles[i];
+            glm::vec3 q = closestOnTriangle(p, glm::vec3(t.a[0], t.a[1], t.a[2]), glm::vec3(t.b[0], t.b[1], t.b[2]), glm::vec3(t.c[0], t.c[1], t.c[2]));
+            glm::vec3 d = p - q;
+            float d2 = glm::dot(d, d);
+            if (d2 < best2)
+            {
+                best2 = d2;
+                found = i;
+                closest = q;
+            }
+        }
+    }
+    if (found < 0)
+    {
+        return false;
+    }
+    float distance = std::sqrt(best2);
+    glm::vec3 normal;
+    if (distance > 0)
+    {
+        normal = (p - closest) / distance;
+    }
+    else
+    {
+        const Triangle &t = m_triangles[found];
+        normal = glm::normalize(glm::cross(glm::vec3(t.b[0] - t.a[0], t.b[1] - t.a[1], t.b[2] - t.a[2]),
+                                           glm::vec3(t.c[0] - t.a[0], t.c[1] - t.a[1], t.c[2] - t.a[2])));
+    }
+    hit.point = glm::vec4(closest, 1.0f);
+    hit.normal = glm::vec4(normal, 0.0f);
+    hit.distance = distance;
+    hit.triangle = found;
+    return true;
+}
+
+bool TrackMesh::ray(const glm::vec4 &origin, const glm::vec4 &direction, float maxDistance, MeshHit &hit) const
+{
+    if (m_nodes.empty())
+    {
+        return false;
+    }
+    glm::vec3 o(origin);
+    glm::vec3 d(direction);
+    float inverse[3];
+    for (int axis = 0; axis < 3; axis++)
+    {
+        inverse[axis] = d[axis] != 0 ? 1.0f / d[axis] : 1e30f;
+    }
+    float best = maxDistance;
+    int found = -1;
+    int stack[stackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Node &node = m_nodes[stack[--top]];
+        float enter = 0;
+        float exit = best;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float t0 = (node.min[axis] - o[axis]) * inverse[axis];
+            float t1 = (node.max[axis] - o[axis]) * inverse[axis];
+            enter = std::max(enter, std::min(t0, t1));
+            exit = std::min(exit, std::max(t0, t1));
+        }
+        if (enter > exit)
+        {
+            continue;
+        }
+        if (node.count == 0)
+        {
+            stack[top++] = node.first;
+            stack[top++] = (int)(&node - &m_nodes[0]) + 1;
+            continue;
+        }
+        // Moller-Trumbore
+        for (int i = node.first; i < node.first + node.count; i++)
+        {
+            const Triangle &t = m_triangles[i];
+            glm::vec3 a(t.a[0], t.a[1], t.a[2]);
+            glm::vec3 e1 = glm::vec3(t.b[0], t.b[1], t.b[2]) - a;
+            glm::vec3 e2 = glm::vec3(t.c[0], t.c[1], t.c[2]) - a;
+            glm::vec3 pv = glm::cross(d, e2);
+            float det = glm::dot(e1, pv);
+            if (std::fabs(det) < 1e-12f)
+            {
+                continue;
+            }
+            float inv = 1.0f / det;
+            glm::vec3 tv = o - a;
+            float u = glm::dot(tv, pv) * inv;
+            if (u < 0 || u > 1)
+            {
+                continue;
+            }
+            glm::vec3 qv = glm::cross(tv, e1);
+            float v = glm::dot(d, qv) * inv;
+            if (v < 0 || u + v > 1)
+            {
+                continue;
+            }
+            float distance = glm::dot(e2, qv) * inv;
+            if (distance >= 0 && distance <= best)
+            {
+                best = distance;
+                found = i;
+            }
+        }
+    }
+    if (found < 0)
+    {
+        return false;
+    }
+    const Triangle &t = m_triangles[found];
+    glm::vec3 normal = glm::normalize(glm::cross(glm::vec3(t.b[0] - t.a[0], t.b[1] - t.a[1], t.b[2] - t.a[2]),
+                                                 glm::vec3(t.c[0] - t.a[0], t.c[1] - t.a[1], t.c[2] - t.a[2])));
+    if (glm::dot(normal, d) > 0)
+    {
+        normal = -normal;
+    }
+    hit.point = glm::vec4(o + d * best, 1.0f);
+    hit.normal = glm::vec4(normal, 0.0f);
+    hit.distance = best;
+    hit.triangle = found;
+    return true;
+}
+
+void TrackMesh::triangle(int index, glm::vec4 &a, glm::vec4 &b, glm::vec4 &c) const
+{
+    const Triangle &t = m_triangles[index];
+    a = glm::vec4(t.a[0], t.a[1], t.a[2], 1.0f);
+    b = glm::vec4(t.b[0], t.b[1], t.b[2], 1.0f);
+    c = glm::vec4(t.c[0], t.c[1], t.c[2], 1.0f);
+}
+
+void TrackMesh::bounds(glm::vec4 &min, glm::vec4 &max) const
+{
+    if (m_nodes.empty())
+    {
+        min = max = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        return;
+    }
+    min = glm::vec4(m_nodes[0].min[0], m_nodes[0].min[1], m_nodes[0].min[2], 1.0f);
+    max = glm::vec4(m_nodes[0].max[0], m_nodes[0].max[1], m_nodes[0].max[2], 1.0f);
+}
@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+
+#include "wallfield.h"
+
+static const char wallFieldMagic[4] = {'F', 'Z', 'S', 'D'};
+static const size_t wallFieldHeaderSize = 40;
+static const int maxSweepSteps = 32;
+
+// FNV-1a of the whole file, 0 if it can't be read
+static unsigned long long fileHash(const char *filename)
+{
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+    {
+        return 0;
+    }
+    unsigned long long hash = 14695981039346656037ULL;
+    unsigned char buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            hash = (hash ^ buffer[i]) * 1099511628211ULL;
+        }
+    }
+    fclose(file);
+    return hash;
+}
+
+WallField::WallField()
+    : m_meshHash(0), m_originX(0), m_originZ(0), m_cellSize(1), m_maxDistance(0), m_cellsX(0), m_cellsZ(0), m_samples(NULL)
+{
+}
+
+bool WallField::bake(const TrackMesh &mesh, const char *meshFile, float cellSize, float maxDistance)
+{
+    close();
+    if (mesh.triangleCount() == 0)
+    {
+        fprintf(stderr, "ERROR: Cannot bake a wall field without walls.\n");
+        return false;
+    }
+    glm::vec4 min, max;
+    mesh.bounds(min, max);
+    m_meshHash = fileHash(meshFile);
+    m_cellSize = cellSize;
+    m_maxDistance = maxDistance;
+    m_originX = min.x - maxDistance;
+    m_originZ = min.z - maxDistance;
+    m_cellsX = (int)std::ceil((max.x - min.x + 2 * maxDistance) / cellSize) + 1;
+    m_cellsZ = (int)std::ceil((max.z - min.z + 2 * maxDistance) / cellSize) + 1;
+    m_baked.resize((size_t)m_cellsX * m_cellsZ);
+
+    // the cars run at y = 0 and the walls are vertical, so the 3D distance
+    // from the sample is the distance in the plane
+    for (int z = 0; z < m_cellsZ; z++)
+    {
+        for (int x = 0; x < m_cellsX; x++)
+        {
+            glm::vec4 p(m_originX + x * cellSize, 0.0f, m_originZ + z * cellSize, 1.0f);
+            float value = maxDistance;
+            MeshHit hit;
+            if (mesh.sphere(p, maxDistance, hit))
+            {
+                value = hit.distance;
+                // behind the closest face is inside the wall; faces are
+                // wound outwards, and a point clearly behind is required so
+                // the ends of a wall don't flip the sign
+                glm::vec4 a, b, c;
+                mesh.triangle(hit.triangle, a, b, c);
+                glm::vec3 face = glm::cross(glm::vec3(b - a), glm::vec3(c - a));
+                float faceLength = glm::length(face);
+                if (hit.distance > 0 && faceLength > 0 &&
+                    glm::dot(glm::vec3(p - hit.point), face) < -0.5f * hit.distance * faceLength)
+                {
+                    value = -value;
+                }
+            }
+            m_baked[(size_t)z * m_cellsX + x] = value;
+        }
+    }
+    m_samples = &m_baked[0];
+    return true;
+}
+
+bool WallField::save(const char *filename) const
+{
+    if (!isOpen())
+    {
+        return false;
+    }
+    FILE *file = fopen(filename, "wb");
+    if (!file)
+    {
+        fprintf(stderr, "ERROR: Cannot open wall field \"%s\" for writing.\n", filename);
+        return false;
+    }
+    unsigned short version = WALLFIELD_VERSION;
+    unsigned short unused = 0;
+    fwrite(wallFieldMagic, 1, sizeof(wallFieldMagic), file);
+    fwrite(&version, sizeof(version), 1, file);
+    fwrite(&unused, sizeof(unused), 1, file);
+    fwrite(&m_meshHash, sizeof(m_meshHash), 1, file);
+    fwrite(&m_originX, sizeof(float), 1, file);
+    fwrite(&m_originZ, sizeof(float), 1, file);
+    fwrite(&m_cellSize, sizeof(float), 1, file);
+    fwrite(&m_maxDistance, sizeof(float), 1, file);
+    fwrite(&m_cellsX, sizeof(int), 1, file);
+    fwrite(&m_cellsZ, sizeof(int), 1, file);
+    size_t count = (size_t)m_cellsX * m_cellsZ;
+    bool written = fwrite(m_samples, sizeof(float), count, file) == count;
+    fclose(file);
+    if (!written)
+    {
+        fprintf(stderr, "ERROR: Cannot write wall field \"%s\".\n", filename);
+    }
+    return written;
+}
+
+bool WallField::open(const char *filename, const char *meshFile)
+{
+    close();
+    // a missing cache is expected the first time, don't report it
+    FILE *exists = fopen(filename, "rb");
+    if (!exists)
+    {
+        return false;
+    }
+    fclose(exists);
+    if (!m_file.open(filename))
+    {
+        return false;
+    }
+    const unsigned char *data = m_file.data();
+    unsigned short version = 0;
+    if (m_file.size() >= wallFieldHeaderSize)
+    {
+        memcpy(&version, data + 4, sizeof(version));
+    }
+    if (byteSwap16(version) == WALLFIELD_VERSION && memcmp(data, wallFieldMagic, sizeof(wallFieldMagic)) == 0)
+    {
+        fprintf(stderr, "ERROR: \"%s\" was baked on a machine with the other byte order, baking it again.\n", filename);
+        m_file.close();
+        return false;
+    }
+    if (m_file.size() < wallFieldHeaderSize || memcmp(data, wallFieldMagic, sizeof(wallFieldMagic)) != 0 ||
+        version != WALLFIELD_VERSION)
+    {
+        fprintf(stderr, "ERROR: \"%s\" is not a wall field, baking it again.\n", filename);
+        m_file.close();
+        return false;
+    }
+    memcpy(&m_meshHash, data + 8, sizeof(m_meshHash));
+    memcpy(&m_originX, data + 16, sizeof(float));
+    memcpy(&m_originZ, data + 20, sizeof(float));
+    memcpy(&m_cellSize, data + 24, sizeof(float));
+    memcpy(&m_maxDistance, data + 28, sizeof(float));
+    memcpy(&m_cellsX, data + 32, sizeof(int));
+    memcpy(&m_cellsZ, data + 36, sizeof(int));
+    size_t count = (size_t)m_cellsX * m_cellsZ;
+    if (m_cellsX < 2 || m_cellsZ < 2 || m_file.size() != wallFieldHeaderSize + count * sizeof(float) ||
+        m_meshHash != fileHash(meshFile))
+    {
+        // baked from another version of the mesh
+        m_file.close();
+        return false;
+    }
+    // the header keeps the samples 8-byte aligned in the page-aligned mapping
+    m_samples = (const float *)(data + wallFieldHeaderSize);
+    return true;
+}
+
+void WallField::close()
+{
+    m_samples = NULL;
+    m_baked.clear();
+    m_file.close();
+}
+
+float WallField::distance(const glm::vec4 &point, glm::vec4 &normal) const
+{
+    normal = glm::vec4(0.0f);
+    float gx = (point.x - m_originX) / m_cellSize;
+    float gz = (point.z - m_originZ) / m_cellSize;
+    int x = (int)std::floor(gx);
+    int z = (int)std::floor(gz);
+    if (!m_samples || x < 0 || z < 0 || x >= m_cellsX - 1 || z >= m_cellsZ - 1)
+    {
+        return m_maxDistance;
+    }
+    float fx = gx - x;
+    float fz = gz - z;
+    const float *row = m_samples + (size_t)z * m_cellsX + x;
+    float d00 = row[0];
+    float d10 = row[1];
+    float d01 = row[m_cellsX];
+    float d11 = row[m_cellsX + 1];
+
+    // gradient of the same bilinear patch
+    float dx = (d10 - d00) * (1 - fz) + (d11 - d01) * fz;
+    float dz = (d01 - d00) * (1 - fx) + (d11 - d10) * fx;
+    float length = std::sqrt(dx * dx + dz * dz);
+    if (length > 0)
+    {
+        normal = glm::vec4(dx / length, 0.0f, dz / length, 0.0f);
+    }
+    return (d00 * (1 - fx) + d10 * fx) * (1 - fz) + (d01 * (1 - fx) + d11 * fx) * fz;
+}
+
+bool WallField::sweep(const glm::vec4 &center, float radius, const glm::vec4 &motion, float &toi) const
+{
+    float length = std::sqrt(motion.x * motion.x + motion.z * motion.z);
+    if (!m_samples || length <= 0)
+    {
+        return false;
+    }
+    glm::vec4 normal;
+    float t = 0;
+    for (int i = 0; i < maxSweepSteps; i++)
+    {
+        float free = distance(center + motion * t, normal) - radius;
+        if (free <= 0)
+        {
+            if (t == 0)
+            {
+                return false;
+            }
+            toi = t;
+            return true;
+        }
+        // nothing is closer than free, so moving by it can't cross a wall;
+        // at least a cell so a grazing move doesn't crawl
+        t += std::max(free, m_cellSize) / length;
+        if (t >= 1)
+        {
+            return false;
+        }
+    }
+    return false;
+}